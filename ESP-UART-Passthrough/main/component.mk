@@ -12,4 +12,11 @@
 COMPONENT_SRCDIRS := src
 
 # 显式指定头文件目录为 include
-COMPONENT_ADD_INCLUDEDIRS := include
\ No newline at end of file
+COMPONENT_ADD_INCLUDEDIRS := include
+
+# 配网页面: 构建时精简并 gzip (tools/web_pack.py)，以二进制数据嵌入固件
+COMPONENT_EMBED_FILES := $(COMPONENT_BUILD_DIR)/index.html.gz
+COMPONENT_EXTRA_CLEAN := index.html.gz
+
+$(COMPONENT_BUILD_DIR)/index.html.gz: $(COMPONENT_PATH)/web/index.html $(PROJECT_PATH)/tools/web_pack.py
+	$(PYTHON) $(PROJECT_PATH)/tools/web_pack.py $< $@
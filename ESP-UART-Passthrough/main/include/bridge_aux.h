@@ -0,0 +1,56 @@
+#ifndef BRIDGE_AUX_H
+#define BRIDGE_AUX_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "ringbuf.h"
+#include "bridge_frame.h"
+
+// === 附加串口通道 (软件 UART，只收) ===
+// 在 GPIO 上以软件 UART 接收更多目标设备的输出，与 UART0 的数据复用分帧端口 (8889，及启用时的压缩端口) 发送
+// 记录的通道号写在帧头 flags 的高 4 位 (0 = UART0)；原始 / RFC 2217 / UDP 上行只转发 UART0
+// 下行与流控、过滤、spool 仍只作用于 UART0
+#define AUX_UART_NUM 0           // 附加通道数 (0..15)，0 表示不启用
+#define AUX_UART_GPIOS { 14 }    // 各通道的接收引脚 (D5, ...)，不能使用 GPIO16
+#define AUX_UART_BAUD 9600       // 软件接收靠边沿中断计时，建议不超过 38400
+#define AUX_CACHE_SIZE 2048      // 每个通道的缓存
+#define AUX_RECORD_MAX 256       // 单条 DATA 记录的最大负载
+#define AUX_POLL_MS 10           // 解码周期
+
+#if AUX_UART_NUM > 0
+/**
+ * @brief 一个分帧客户端在各附加通道上的读取状态
+ */
+typedef struct {
+    rb_reader_t reader[AUX_UART_NUM];  // 各通道的读游标
+    uint32_t gapped[AUX_UART_NUM];     // 各通道已声明的丢失字节数
+    uint8_t next;                      // 下一个轮到的通道
+    uint8_t rec[BRIDGE_FRAME_HDR_LEN + AUX_RECORD_MAX];  // 最近取出的完整记录
+} bridge_aux_reader_t;
+
+/**
+ * @brief 初始化各通道并启动解码任务
+ * * 说明:
+ * - 每个通道写入独立的环形缓冲区，数据量小，不经过过滤器与 spool，也不参与背压
+ * - 初始化失败的通道保持空闲，不影响其他通道
+ * @param wake 有新数据时调用 (在解码任务中)，用于唤醒发送方
+ * @return false 内存不足
+ */
+bool bridge_aux_init(void (*wake)(void));
+
+/**
+ * @brief 读游标置于各通道当前的写位置 (新客户端只接收此后的数据)
+ */
+void bridge_aux_reader_init(bridge_aux_reader_t *r);
+
+/**
+ * @brief 轮流检查各通道，取出一条 GAP 或 DATA 记录
+ * 记录的 flags 带通道号与 BRIDGE_FRAME_F_TS_APPROX (时间戳为解码任务取出数据的时间)
+ * @param rec 输出记录地址 (指向 r->rec，下次调用前有效)
+ * @return 记录长度 (含帧头)，0 表示所有通道都没有待发的数据
+ */
+size_t bridge_aux_next_record(bridge_aux_reader_t *r, const uint8_t **rec);
+#endif
+
+#endif // BRIDGE_AUX_H
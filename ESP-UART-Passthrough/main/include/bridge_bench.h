@@ -0,0 +1,47 @@
+#ifndef BRIDGE_BENCH_H
+#define BRIDGE_BENCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "bridge_stats.h"
+
+// === 性能测试 ===
+// 由内部任务按固定速率生成数据 (代替目标设备)，与串口走同一条发布路径，
+// 并周期性打印吞吐、时延分位数、丢包数与每 KB 数据耗费的 CPU 时间
+// 不经过串口驱动，测的是设备上桥接本身的余量；含驱动路径的主机端测试见 tools/bridge_host_bench.c
+#define BENCH_RATE_BPS (921600 / 10)  // 生成速率 (字节/秒)，逐步调大直至出现丢包即为上限
+#define BENCH_BURST 64                // 每次注入的字节数 (相当于一次 FIFO 满中断)
+#define BENCH_REPORT_MS 5000
+
+/**
+ * @brief 桥接侧的累计计数 (自启动起，模 2^32)
+ */
+typedef struct {
+    uint32_t sent;                             // 所有客户端累计发出的字节数
+    uint32_t busy_us;                          // I/O 任务累计处理耗时
+    uint32_t lost;                             // 在线客户端因跟不上而丢弃的字节数之和
+    uint32_t hist[BRIDGE_LAT_HIST_BUCKETS];    // UART -> 网络时延直方图
+} bridge_bench_snapshot_t;
+
+/**
+ * @brief 测试任务与桥接的接口，由 tcp_bridge.c 提供
+ */
+typedef struct {
+    // 发布一批数据，与串口收到数据时相同; line_idle 模拟 RX 超时 (线路空闲)
+    void (*publish)(const uint8_t *data, size_t len, int64_t t_us, bool line_idle);
+    // 是否处于背压 (暂停生成，与目标设备响应流控的行为一致)
+    bool (*paused)(void);
+    void (*snapshot)(bridge_bench_snapshot_t *snap);
+} bridge_bench_ops_t;
+
+/**
+ * @brief 启动性能测试任务
+ * * 说明:
+ * - 生成的数据是递增的字节序列，客户端只需接收并丢弃，如: nc <ip> 8888 > /dev/null
+ * - 报告中的 CPU 时间 = 生成与发布耗时 + I/O 任务耗时
+ * @param ops 须在整个运行期间有效
+ */
+void bridge_bench_start(const bridge_bench_ops_t *ops);
+
+#endif // BRIDGE_BENCH_H
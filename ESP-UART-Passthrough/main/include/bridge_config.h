@@ -0,0 +1,94 @@
+#ifndef BRIDGE_CONFIG_H
+#define BRIDGE_CONFIG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "uart_filter.h"
+
+#define BRIDGE_CFG_PSK_MIN 32  // 十六进制字符数，即 16..32 字节
+#define BRIDGE_CFG_PSK_MAX 64
+
+/**
+ * @brief 桥接运行参数，保存在 NVS 命名空间 "bridge"
+ * * 说明:
+ * - tcp_bridge_init() 启动时载入，NVS 中缺失或非法的项取默认值
+ * - 可通过配网 WebServer (/bridge) 或控制端口修改，见 tcp_bridge_apply_config()
+ */
+typedef struct {
+    uint16_t tcp_port;    // 原始透传端口
+    uint32_t baudrate;    // 串口波特率
+    uint16_t chunk_size;  // 单次读写的临时缓冲区大小
+    uint32_t cache_size;  // 环形缓冲区大小，必须是 2 的幂
+    uint8_t filter_mode;      // 串口数据过滤模式 (UART_FILTER_xxx)
+    uint16_t filter_context;  // 捕获模式下触发前后各保留的字节数
+    char filter_patterns[UART_FILTER_PATTERNS_MAX + 1];  // '|' 分隔的模式
+    char tls_psk[BRIDGE_CFG_PSK_MAX + 1];  // TLS 预共享密钥 (十六进制)，空串表示不启用
+} bridge_config_t;
+
+// 默认值
+#define BRIDGE_CFG_TCP_PORT   8888
+#define BRIDGE_CFG_BAUDRATE   115200
+#define BRIDGE_CFG_CHUNK_SIZE 512
+#define BRIDGE_CFG_CACHE_SIZE (8 * 1024)
+#define BRIDGE_CFG_FILTER_MODE UART_FILTER_OFF
+#define BRIDGE_CFG_FILTER_CONTEXT 1024
+#define BRIDGE_CFG_FILTER_PATTERNS "ERROR|panic|Guru Meditation"
+
+// 取值范围 (缓存太大会导致 ESP8266 malloc 失败)
+#define BRIDGE_CFG_BAUD_MIN  300
+#define BRIDGE_CFG_BAUD_MAX  4000000
+#define BRIDGE_CFG_CHUNK_MIN 64
+#define BRIDGE_CFG_CHUNK_MAX 2048
+#define BRIDGE_CFG_CACHE_MIN 1024
+#define BRIDGE_CFG_CACHE_MAX (32 * 1024)
+#define BRIDGE_CFG_CONTEXT_MIN 64
+#define BRIDGE_CFG_CONTEXT_MAX UART_FILTER_CONTEXT_MAX
+
+/**
+ * @brief 填入默认值
+ */
+void bridge_config_defaults(bridge_config_t *cfg);
+
+/**
+ * @brief 从 NVS 载入，缺失或超出范围的项保留默认值
+ * @return ESP_OK 成功 (包括 NVS 中尚无配置)，其他为 NVS 错误码
+ */
+esp_err_t bridge_config_load(bridge_config_t *cfg);
+
+/**
+ * @brief 写入 NVS
+ */
+esp_err_t bridge_config_save(const bridge_config_t *cfg);
+
+/**
+ * @brief 按名称修改一项参数，仅校验，不写 NVS
+ * * 名称:
+ * - port / baud / chunk / cache: 数字
+ * - filter: off / pass / drop / capture
+ * - patterns: '|' 分隔的模式，如 "ERROR|panic"
+ * - context: 数字 (字节)
+ * - psk: 32..64 个十六进制字符，"off" 表示清除 (只写，不出现在格式化输出中)
+ * @return ESP_OK 成功, ESP_ERR_NOT_FOUND 名称未知, ESP_ERR_INVALID_ARG 取值非法
+ */
+esp_err_t bridge_config_set(bridge_config_t *cfg, const char *key, const char *value);
+
+/**
+ * @brief 比较给定字符串与当前 TLS 密钥 (十六进制不区分大小写，耗时与内容无关)
+ * @return 已设置密钥且一致时为 true
+ */
+bool bridge_config_psk_equal(const bridge_config_t *cfg, const char *psk);
+
+/**
+ * @brief 格式化为 "port=8888 baud=115200 chunk=512 cache=8192 filter=off context=1024 tls=off patterns=ERROR|panic"
+ * @return 写入的字符数 (同 snprintf)
+ */
+int bridge_config_format(const bridge_config_t *cfg, char *buf, size_t len);
+
+/**
+ * @brief 过滤模式名称 ("off" / "pass" / "drop" / "capture")
+ */
+const char *bridge_config_filter_name(uint8_t mode);
+
+#endif // BRIDGE_CONFIG_H
@@ -0,0 +1,39 @@
+#ifndef BRIDGE_CTL_H
+#define BRIDGE_CTL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lwip/sockets.h"
+
+/**
+ * @brief 控制端口: 文本行命令，同时只服务一个连接，新连接替换旧连接
+ * * 命令:
+ * - get: 返回当前参数 (格式见 bridge_config_format)
+ * - set <参数名> <值>: 参数名见 bridge_config_set，修改即写入 NVS 并生效
+ * - set psk <新密钥|off> <当前密钥>: 控制端口是明文，首个密钥只能在配网页面设置
+ * * 说明:
+ * - 由 I/O 任务的 select() 驱动，socket 均为非阻塞；对端不读取应答时直接断开
+ * - 参数经 tcp_bridge_get_config / tcp_bridge_apply_config 读写
+ */
+
+#define BRIDGE_CTL_LINE_MAX 160   // 容纳 "set patterns <63 字符>" 与 "set psk <新密钥> <当前密钥>"
+#define BRIDGE_CTL_REPLY_MAX 192  // 单条应答的最大长度
+
+/**
+ * @brief 在指定端口监听
+ * @return true 成功
+ */
+bool bridge_ctl_init(uint16_t port);
+
+/**
+ * @brief 把监听与连接 socket 加入读集合
+ * @return 加入后的最大描述符 (不小于 maxfd)
+ */
+int bridge_ctl_fdset(fd_set *rfds, int maxfd);
+
+/**
+ * @brief select() 返回后处理新连接与命令
+ */
+void bridge_ctl_service(const fd_set *rfds);
+
+#endif // BRIDGE_CTL_H
@@ -0,0 +1,69 @@
+#ifndef BRIDGE_FRAME_H
+#define BRIDGE_FRAME_H
+
+#include <stdint.h>
+
+/*
+ * 分帧上行协议 (Port 8889)
+ * 每条记录 = 16 字节帧头 + 负载，多字节字段均为大端序
+ *
+ *   0  type    u8   记录类型 (BRIDGE_FRAME_xxx)
+ *   1  flags   u8   BRIDGE_FRAME_F_xxx
+ *   2  len     u16  负载长度
+ *   4  offset  u32  负载首字节在串口数据流中的序号 (自启动起累计，模 2^32)
+ *   8  ts_us   u64  采集时间 (esp_timer，自启动起的微秒数)
+ *
+ * DATA: 负载为串口原始数据，ts_us 为这批字节从 UART 驱动读出的时间
+ * GAP:  负载为 u32 丢失字节数，offset 为第一个丢失字节的序号，ts_us 为发现丢失的时间
+ *       若前一条 DATA 记录的负载与 GAP 范围重叠，重叠部分为填充字节，应丢弃
+ * DATA_LZ (仅分帧 + 压缩端口 FRAMED_LZ_PORT): 负载为 u16 原始长度 + LZ4 block 压缩数据，ts_us 为首字节的采集时间
+ *       一条记录可能跨越多批串口数据；压缩无收益时该端口也会发送普通 DATA 记录
+ *
+ * 通道: flags 高 4 位为串口通道号，0 为 UART0，1..15 为附加的软件 UART 通道 (只收)
+ *       各通道的 offset 独立编号，GAP 记录同样带通道号；附加通道的 ts_us 均为近似值
+ *       只认识 UART0 的旧客户端应丢弃通道号不为 0 的记录
+ *
+ * UDP 上行 (可选): 每个数据报 = u32 数据报序号 + 一条完整的 DATA 或 GAP 记录
+ *       序号逐个递增，接收端据此发现网络丢包；GAP 记录仍只表示设备端缓存溢出
+ */
+
+#define BRIDGE_FRAME_HDR_LEN 16
+#define BRIDGE_UDP_SEQ_LEN 4
+
+#define BRIDGE_FRAME_DATA 0x01
+#define BRIDGE_FRAME_GAP  0x02
+#define BRIDGE_FRAME_DATA_LZ 0x03
+
+// 采集时间索引已被覆盖，ts_us 为近似值 (不早于真实采集时间)
+#define BRIDGE_FRAME_F_TS_APPROX 0x01
+
+// flags 高 4 位: 串口通道号
+#define BRIDGE_FRAME_F_CHANNEL(ch) ((uint8_t)((ch) << 4))
+#define BRIDGE_FRAME_CHANNEL(flags) ((uint8_t)((flags) >> 4))
+
+static inline void bridge_frame_put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static inline void bridge_frame_put_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+/**
+ * @brief 填写 16 字节帧头
+ */
+static inline void bridge_frame_header(uint8_t *hdr, uint8_t type, uint8_t flags,
+                                       uint16_t len, uint32_t offset, int64_t ts_us) {
+    hdr[0] = type;
+    hdr[1] = flags;
+    bridge_frame_put_u16(hdr + 2, len);
+    bridge_frame_put_u32(hdr + 4, offset);
+    bridge_frame_put_u32(hdr + 8, (uint32_t)((uint64_t)ts_us >> 32));
+    bridge_frame_put_u32(hdr + 12, (uint32_t)ts_us);
+}
+
+#endif // BRIDGE_FRAME_H
@@ -0,0 +1,86 @@
+#ifndef BRIDGE_FRAMER_H
+#define BRIDGE_FRAMER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "bridge_frame.h"
+
+/**
+ * @brief 分帧上行的记录编码器 (格式见 bridge_frame.h)，每个分帧会话一个
+ * * 说明:
+ * - 编码器只组帧头与压缩记录，读取环形缓冲区与 socket 发送由调用方 (tcp_bridge.c 的 I/O 任务) 完成
+ * - 待发的协议字节由 pend / pend_len 描述，调用方发出一部分后推进 pend_sent，发送缓冲区满时下次继续
+ * - DATA 记录只组帧头，负载由调用方随后直接从缓存发出 frame_remain 字节
+ * - 压缩记录 (DATA_LZ) 的输入与输出缓冲区启动时一次性分配，输出缓冲区每个会话槽位一个
+ */
+typedef struct {
+    uint8_t hdr[BRIDGE_FRAME_HDR_LEN + 4];  // 帧头缓冲 (GAP 记录连同 4 字节负载)
+    const uint8_t *pend;        // 待发的协议字节: 指向 hdr 或压缩记录缓冲区
+    uint16_t pend_len;
+    uint16_t pend_sent;
+    uint16_t frame_remain;      // 当前 DATA 记录尚未发出的负载字节数 (由调用方递减)
+    bool frame_filler;          // 当前 DATA 记录中途遇到缓存覆盖，剩余负载以 0 填充
+    uint32_t lost_gapped;       // 已通过 GAP 记录声明的丢失字节数
+    uint8_t *lz_rec;            // 本会话的压缩记录缓冲区，未启用压缩时为 NULL
+} bridge_framer_t;
+
+/**
+ * @brief 分配压缩记录用的缓冲区
+ * @param chunk_max 单条压缩记录的最大原始长度
+ * @param slots 会话槽位数
+ * @return true 成功
+ */
+bool bridge_framer_lz_init(size_t chunk_max, int slots);
+
+/**
+ * @brief 会话建立时初始化 (编码器须已清零)
+ * @param slot 会话槽位号，决定使用哪个压缩记录缓冲区
+ */
+void bridge_framer_init(bridge_framer_t *f, int slot);
+
+/**
+ * @brief 是否有协议字节 (帧头、压缩记录或 DATA 负载) 尚未发出
+ */
+static inline bool bridge_framer_pending(const bridge_framer_t *f) {
+    return f->pend_sent < f->pend_len || f->frame_remain > 0;
+}
+
+/**
+ * @brief 把外部组好的一条完整记录设为待发 (如附加通道的记录)
+ */
+void bridge_framer_queue(bridge_framer_t *f, const uint8_t *rec, size_t len);
+
+/**
+ * @brief 组 GAP 记录: 丢失范围紧邻当前读位置之前，声明后计入 lost_gapped
+ * @param rec 输出，至少 BRIDGE_FRAME_HDR_LEN + 4 字节
+ * @param tail 读位置
+ * @param lost 读游标累计的丢失字节数
+ * @return 记录长度，0 表示没有未声明的丢失
+ */
+size_t bridge_framer_gap_record(bridge_framer_t *f, uint8_t *rec, uint32_t tail, uint32_t lost);
+
+/**
+ * @brief 有未声明的丢失时把 GAP 记录设为待发
+ * @return true 已设为待发
+ */
+bool bridge_framer_gap(bridge_framer_t *f, uint32_t tail, uint32_t lost);
+
+/**
+ * @brief 把 DATA 帧头设为待发，随后由调用方发送 len 字节负载
+ */
+void bridge_framer_data(bridge_framer_t *f, uint8_t flags, uint16_t len, uint32_t offset, int64_t ts);
+
+/**
+ * @brief 压缩输入缓冲区，调用方从缓存拷入最多 chunk_max 字节后调用 bridge_framer_lz
+ */
+uint8_t *bridge_framer_lz_input(void);
+
+/**
+ * @brief 把输入缓冲区中的 len 字节压缩成一条完整记录并设为待发
+ * 压缩无收益 (如二进制数据) 时改为普通 DATA 记录，负载同样在记录缓冲区中
+ * @param ts 首字节的采集时间
+ */
+void bridge_framer_lz(bridge_framer_t *f, size_t len, uint8_t flags, uint32_t offset, int64_t ts);
+
+#endif // BRIDGE_FRAMER_H
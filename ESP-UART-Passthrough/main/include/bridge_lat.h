@@ -0,0 +1,39 @@
+#ifndef BRIDGE_LAT_H
+#define BRIDGE_LAT_H
+
+#include <stdint.h>
+#include "bridge_stats.h"
+
+/**
+ * @brief UART -> 网络时延直方图 (单实例)
+ * * 说明:
+ * - 第 i 桶统计 [2^i, 2^(i+1)) 微秒，共 BRIDGE_LAT_HIST_BUCKETS 桶，最后一桶收纳更长的时延
+ * - 只由 I/O 任务记录；其他任务读取时不加锁，计数可能差一次采样
+ * - 样本为合包滞留的起点 (最早未发送字节的到达时间) 到发出的时间
+ */
+
+/**
+ * @brief 记录一次时延
+ * @param us 时延 (微秒)
+ */
+void bridge_lat_record(int64_t us);
+
+/**
+ * @brief 时延分位数
+ * @param permille 分位 (千分比)，如 990 即 p99
+ * @return 该分位所在桶的上界 (微秒)，无样本时返回 0
+ */
+uint32_t bridge_lat_percentile(uint32_t permille);
+
+/**
+ * @brief 拷出各桶计数
+ * @param hist 输出，BRIDGE_LAT_HIST_BUCKETS 个元素
+ */
+void bridge_lat_copy(uint32_t *hist);
+
+/**
+ * @brief 以一行日志输出非空的桶
+ */
+void bridge_lat_dump(void);
+
+#endif // BRIDGE_LAT_H
@@ -0,0 +1,51 @@
+#ifndef BRIDGE_RFC2217_H
+#define BRIDGE_RFC2217_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "driver/uart.h"
+#include "rfc2217.h"
+
+/**
+ * @brief RFC 2217 端口的串口线路控制: 把 COM-PORT-OPTION 命令应用到串口与 DTR/RTS 引脚 (单实例)
+ * * 说明:
+ * - Telnet 解析见 rfc2217.h，每个会话一个解析器，命令回调的上下文为会话 (client)
+ * - 只有持有下行控制权的会话可以修改参数，其余会话只得到当前值；查询不参与控制权争夺
+ * - 数据位 / 校验 / 停止位 / 波特率修改经 reconfigure 排在已入环的下行数据之后生效
+ * - 流控方式在编译期确定，只报告；不支持 BREAK
+ * - DTR / RTS 低电平有效 (与 USB 串口芯片一致)，上电默认无效
+ * - 所有回调都在 I/O 任务中执行
+ */
+
+/**
+ * @brief 线路控制与桥接的接口，由 tcp_bridge.c 提供
+ */
+typedef struct {
+    // 申请下行控制权，返回 true 表示该会话可以修改参数
+    bool (*acquire)(void *client);
+    // 把新参数排在已入环的下行数据之后，返回 false 表示未能排队 (参数不变)
+    bool (*reconfigure)(const uart_config_t *cfg);
+    // PURGE-DATA 接收方向: 丢弃该会话尚未发出的上行缓存
+    void (*purge_rx)(void *client);
+    // PURGE-DATA 发送方向: 丢弃尚未写入串口的下行数据
+    void (*purge_tx)(void);
+    // FLOWCONTROL-SUSPEND / RESUME: 暂停或恢复该会话的上行
+    void (*suspend)(void *client, bool on);
+} bridge_rfc2217_ops_t;
+
+/**
+ * @brief 配置 DTR/RTS 引脚
+ * @param ops 须在整个运行期间有效
+ * @param line 当前串口参数，与调用方共用；命令生效后由本模块改写
+ * @param flow_control SET-CONTROL 查询流控时的应答: 1 无, 2 XON/XOFF, 3 RTS/CTS
+ */
+void bridge_rfc2217_init(const bridge_rfc2217_ops_t *ops, uart_config_t *line,
+                         int dtr_gpio, int rts_gpio, uint8_t flow_control);
+
+/**
+ * @brief 新会话: 初始化解析器，并把二进制传输与抑制 GA 的声明放入待发应答
+ * COM-PORT 由客户端发起
+ */
+void bridge_rfc2217_start(rfc2217_t *tn, void *client);
+
+#endif // BRIDGE_RFC2217_H
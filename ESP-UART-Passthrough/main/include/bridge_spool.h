@@ -0,0 +1,49 @@
+#ifndef BRIDGE_SPOOL_H
+#define BRIDGE_SPOOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+/**
+ * @brief Flash 循环日志 (离线缓存)
+ * * 设计:
+ * - 使用原始数据分区 (type data, subtype 0x40, 名称 "spool")，不经过文件系统
+ * - 按 4KB 扇区依次轮转写入，写满后擦除最旧的扇区，擦写次数在各扇区间均匀分布
+ * - 每个扇区以扇区头开始 (魔数 + 轮转序号 + 首字节位置)，随后是若干条记录
+ * - 每条记录 = 8 字节记录头 (长度 + 长度反码 + 首字节位置) + 数据，按 4 字节对齐
+ * - 先写数据、后写记录头，掉电时只会丢失最后一条不完整的记录
+ * - 位置为自由递增的 32 位字节序号，重启后从上次的末尾继续编号
+ * - 擦写寿命按 扇区寿命 (约 10 万次) x 分区大小 计算总写入量，512KB 分区约 50GB；
+ *   调用者应只在数据可能送不到时写入 (如没有客户端在线)，而不是持续写入
+ */
+
+/**
+ * @brief 挂载 spool 分区，扫描扇区头恢复写入位置
+ * @return ESP_OK 成功, ESP_ERR_NOT_FOUND 分区表中没有 spool 分区
+ */
+esp_err_t bridge_spool_init(void);
+
+/**
+ * @brief 获取最新数据之后的位置 (挂载后立即调用即本次启动的起始位置)
+ */
+uint32_t bridge_spool_end(void);
+
+/**
+ * @brief 追加一段数据
+ * @param pos 首字节的位置，不能早于 bridge_spool_end()；出现跳跃表示中间的数据已丢失
+ * @param data 数据
+ * @param len 长度
+ */
+void bridge_spool_append(uint32_t pos, const uint8_t *data, size_t len);
+
+/**
+ * @brief 从指定位置读取数据
+ * @param pos 输入为期望读取的位置；若该位置已被擦除或本就缺失，前移到其后第一个有效字节
+ * @param buf 输出缓冲区
+ * @param max_len 最多读取的字节数
+ * @return 从 *pos 开始连续读出的字节数，0 表示已没有更新的数据
+ */
+size_t bridge_spool_read(uint32_t *pos, uint8_t *buf, size_t max_len);
+
+#endif // BRIDGE_SPOOL_H
@@ -0,0 +1,86 @@
+#ifndef BRIDGE_STATS_H
+#define BRIDGE_STATS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief 桥接各环节的累计计数，用于定位数据在哪一环丢失或滞留
+ * * 说明:
+ * - 每个计数只由一个任务写入 (单写者，普通自增，不加锁)，读取方得到的快照各字段间可能相差一个瞬间
+ * - 除 uptime_s / sessions_active / 时延分位数外，均为自启动起的累计值 (模 2^32)
+ * - 发送相关的字节数在 socket 层统计，含帧头、转义等协议开销
+ */
+typedef struct {
+    uint32_t uptime_s;          // 快照时间
+    // 串口 (守护任务)
+    uint32_t uart_rx_bytes;     // 从驱动读出的字节数
+    uint32_t uart_fifo_ovf;     // 硬件 FIFO 溢出次数
+    uint32_t uart_buffer_full;  // 驱动接收缓冲区满次数
+    uint32_t uart_frame_err;    // 帧错误次数
+    uint32_t uart_parity_err;   // 校验错误次数
+    // 环形缓冲区 (守护任务，按最慢客户端的读位置估算)
+    uint32_t rb_high_water;     // 客户端积压的最大值
+    uint32_t rb_overwritten;    // 尚未被最慢客户端读取就被覆盖的字节数
+    // 发送 (I/O 任务，TCP 与 UDP 上行合计)
+    uint32_t tx_bytes;          // 发出的字节数
+    uint32_t tx_segments;       // 成功的 send() / sendto() / 零拷贝写入次数
+    uint32_t tx_eagain;         // 发送缓冲区满 (EAGAIN) 次数
+    uint32_t tx_partial;        // 只发出一部分的次数
+    uint32_t client_dropped;    // 各客户端因跟不上而丢弃的字节数之和
+    uint32_t lat_p50_us;        // UART -> 网络时延中位数 (直方图桶上界)
+    uint32_t lat_p99_us;
+    // 会话 (I/O 任务)
+    uint32_t sessions_total;    // 累计建立的会话数
+    uint32_t sessions_active;   // 当前在线会话数
+    uint32_t session_s_total;   // 已结束会话的时长之和 (秒)
+    uint32_t session_s_max;     // 已结束会话的最长时长 (秒)
+    // 过滤器 (守护任务)，未启用过滤时 filter_out 等于 uart_rx_bytes
+    uint32_t filter_out;        // 通过过滤写入缓存的字节数
+    uint32_t filter_matches;    // 模式命中次数
+    // 下行 (I/O 任务)
+    uint32_t dl_bytes;          // 写入串口发送环的下行字节数
+    uint32_t dl_stalls;         // 发送环将满、暂停读取客户端的次数
+} bridge_stats_t;
+
+// 时延直方图桶数: 第 i 桶统计 [2^i, 2^(i+1)) 微秒
+#define BRIDGE_LAT_HIST_BUCKETS 20
+
+/**
+ * @brief 时延直方图的分位数
+ * @param hist BRIDGE_LAT_HIST_BUCKETS 个桶的计数
+ * @param total 各桶计数之和
+ * @param permille 分位 (千分比)，如 990 即 p99
+ * @return 该分位所在桶的上界 (微秒)，无样本时返回 0
+ */
+uint32_t bridge_stats_percentile(const uint32_t *hist, uint32_t total, uint32_t permille);
+
+/*
+ * 二进制快照 (UDP 统计端口)，向该端口发送任意数据报，设备回复一份快照
+ *
+ *   0  magic   u16  BRIDGE_STATS_MAGIC ("BS")
+ *   2  version u8   BRIDGE_STATS_VERSION
+ *   3  count   u8   随后的字段数 N
+ *   4  fields  u32 x N，大端序，顺序同 bridge_stats_t
+ *
+ * 以后只在末尾追加字段，旧的解析端按 count 跳过不认识的部分
+ */
+#define BRIDGE_STATS_MAGIC 0x4253
+#define BRIDGE_STATS_VERSION 1
+#define BRIDGE_STATS_HDR_LEN 4
+#define BRIDGE_STATS_BIN_MAX (BRIDGE_STATS_HDR_LEN + sizeof(bridge_stats_t))
+
+/**
+ * @brief 编码二进制快照
+ * @param buf 输出缓冲区，至少 BRIDGE_STATS_BIN_MAX 字节
+ * @return 写入的字节数，缓冲区不足时返回 0
+ */
+size_t bridge_stats_encode(const bridge_stats_t *st, uint8_t *buf, size_t len);
+
+/**
+ * @brief 格式化为 JSON 对象，字段名同 bridge_stats_t 成员名
+ * @return 输出长度 (不含结尾 0)，缓冲区不足时截断，返回值同 snprintf
+ */
+int bridge_stats_format_json(const bridge_stats_t *st, char *buf, size_t len);
+
+#endif // BRIDGE_STATS_H
@@ -0,0 +1,63 @@
+#ifndef BRIDGE_TLS_H
+#define BRIDGE_TLS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "mbedtls/ssl.h"
+
+/**
+ * @brief TLS 上行的 mbedTLS 服务端 (预共享密钥，同时只服务一个会话)
+ * * 针对 ESP8266 的取舍:
+ * - 只用 PSK 密钥交换: 没有证书与公钥运算，完整握手只需少量哈希，在 160MHz 下为毫秒级
+ * - 对称加密优先 AES-128-GCM，其次 AES-128-CCM-8 (软件 GHASH 查表比 CCM 的两遍 AES 便宜)
+ * - 只接受 TLS 1.2；发出的记录不超过 BRIDGE_TLS_RECORD_MAX，加上 29 字节开销仍在一个 TCP 分段内
+ * - 会话上下文及其收发缓冲区在启动时分配一次，之后每个连接只做 session reset，不再 malloc
+ * - 会话票据: 重连的客户端出示票据即可走简化握手 (票据密钥只在 RAM 中，重启或更换 PSK 后失效)
+ * - 接收缓冲区见 sdkconfig 的 CONFIG_MBEDTLS_SSL_IN_CONTENT_LEN，客户端单条记录不能超过它
+ * * 启用 TLS_PORT 时建议在 menuconfig 中把 CONFIG_MBEDTLS_SSL_IN_CONTENT_LEN / OUT_CONTENT_LEN
+ *   从默认的 16384 / 4096 降到 4096 / 2048，会话上下文由约 22KB 降到约 8KB。
+ *   该设置对固件中所有 mbedTLS 使用者生效: 若还有 OTA、HTTPS 客户端等连接发送 16KB 记录的服务器，保持默认值
+ */
+
+#define BRIDGE_TLS_RECORD_MAX 1024             // 与 MBEDTLS_SSL_MAX_FRAG_LEN_1024 对应
+#define BRIDGE_TLS_PSK_IDENTITY "esp-bridge"   // 客户端使用的 PSK 身份
+#define BRIDGE_TLS_TICKET_LIFETIME_S (24 * 3600)
+
+/**
+ * @brief 初始化随机数、票据密钥与服务端配置，并分配唯一的会话上下文
+ * @return true 成功
+ */
+bool bridge_tls_init(void);
+
+/**
+ * @brief 设置预共享密钥，同时作废已发出的会话票据
+ * * 调用前应先关闭正在使用的会话
+ * @param psk_hex 十六进制密钥，空串表示停用 TLS
+ * @return true 已启用, false 已停用 (空串或格式非法)
+ */
+bool bridge_tls_set_psk(const char *psk_hex);
+
+/**
+ * @brief 是否可以接受新的 TLS 连接 (已设置密钥且会话上下文空闲)
+ */
+bool bridge_tls_available(void);
+
+/**
+ * @brief 取得会话上下文并绑定到一个非阻塞连接
+ * @param bio 传给收发回调的参数
+ * @return 会话上下文，不可用时返回 NULL
+ */
+mbedtls_ssl_context *bridge_tls_acquire(void *bio, mbedtls_ssl_send_t *f_send, mbedtls_ssl_recv_t *f_recv);
+
+/**
+ * @brief 归还会话上下文
+ * @param notify 握手已完成，尝试发送 close_notify (非阻塞，发不出去则放弃)
+ */
+void bridge_tls_release(bool notify);
+
+/**
+ * @brief 最近一次握手是否由会话票据恢复
+ */
+bool bridge_tls_resumed(void);
+
+#endif // BRIDGE_TLS_H
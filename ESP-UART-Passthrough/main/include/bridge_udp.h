@@ -0,0 +1,52 @@
+#ifndef BRIDGE_UDP_H
+#define BRIDGE_UDP_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+ * @brief UDP / 组播上行的数据报发布端 (单实例)
+ * * 说明:
+ * - 每个数据报 = 4 字节递增序号 + 一条分帧记录 (格式见 bridge_frame.h)，接收端按序号发现丢包
+ * - 目的地址为组播组时设置 TTL 并关闭本机回环
+ * - 非阻塞发送: 协议栈缓冲区不足时保留数据报稍后重发；其他错误 (如尚未连上网络) 直接丢弃，
+ *   序号照常递增，同一错误只记录一次日志
+ * - 读取环形缓冲区、合包与组记录由调用方 (tcp_bridge.c 的 I/O 任务) 完成
+ */
+
+/**
+ * @brief 创建 socket 并分配数据报缓冲区
+ * @param addr 单播主机或组播组地址 (点分十进制)
+ * @param record_max 单条记录的最大长度
+ * @return true 成功
+ */
+bool bridge_udp_init(const char *addr, uint16_t port, uint8_t multicast_ttl, size_t record_max);
+
+/**
+ * @brief 是否已初始化
+ */
+bool bridge_udp_ready(void);
+
+/**
+ * @brief 下一条记录的写入位置 (序号之后)，可写 record_max 字节
+ */
+uint8_t *bridge_udp_record(void);
+
+/**
+ * @brief 记录已写好，等待 bridge_udp_flush 发出
+ */
+void bridge_udp_queue(size_t record_len);
+
+/**
+ * @brief 是否有组好但尚未发出的数据报
+ */
+bool bridge_udp_pending(void);
+
+/**
+ * @brief 发出待发的数据报
+ * @return 发出的字节数; 0 数据报已丢弃 (发送出错); -1 协议栈暂时无法发送，稍后重试
+ */
+int bridge_udp_flush(void);
+
+#endif // BRIDGE_UDP_H
@@ -0,0 +1,40 @@
+#ifndef BRIDGE_ZEROCOPY_H
+#define BRIDGE_ZEROCOPY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+ * @brief 零拷贝发送的协议栈部分: 把调用方的内存区间直接挂到 TCP 发送队列 (tcp_write 不带 COPY)
+ * * 说明:
+ * - 依赖 lwIP 内部接口 (sockets_priv.h / tcpip_priv.h)，只在本模块中引用
+ * - 每次调用经 tcpip_api_call 在 tcpip 线程中执行一次，最多两段 (环形缓冲区环绕处)
+ * - 入队的区间在重传时还会被读取: 对端确认前 (inflight > 0) 调用方必须保证其内容不被改写
+ * - 发送队列已满时只写入一部分，并像 send() 写满时一样让 select 在腾出空间后报告可写
+ */
+
+struct netconn;
+
+/**
+ * @brief 取得 socket 对应的连接，用于之后的零拷贝写入
+ * @return NULL 表示 socket 无效
+ */
+struct netconn *bridge_zc_conn(int sock);
+
+/**
+ * @brief 写入最多两段数据
+ * @param data / len 各段的地址与长度，第二段长度可为 0；两段都为 0 时只查询确认进度
+ * @param inflight 输出: 返回时协议栈中尚未被对端确认的字节数
+ * @return 写入的字节数，-1 表示连接已断开
+ */
+int bridge_zc_write(struct netconn *conn, const uint8_t *const data[2], const size_t len[2],
+                    uint32_t *inflight);
+
+/**
+ * @brief 立即复位连接，释放发送队列中仍引用调用方内存的数据
+ * * 之后仍需 close() socket
+ */
+void bridge_zc_abort(struct netconn *conn);
+
+#endif // BRIDGE_ZEROCOPY_H
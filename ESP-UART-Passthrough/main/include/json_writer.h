@@ -0,0 +1,75 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+ * @brief 流式 JSON 编码器
+ * * 设计:
+ * - 输出先写入结构体内固定大小的块缓冲区，写满即通过回调送出 (如 httpd_resp_send_chunk)，
+ *   内存占用与输出长度无关，不做任何内存分配
+ * - 逗号由编码器按嵌套层级自动插入，调用者只需按顺序写键和值
+ * - 字符串按 RFC 8259 转义；非法 UTF-8 字节 (如 SSID 中的任意字节) 替换为 U+FFFD，输出总是合法的 UTF-8
+ * - 出错后 (回调失败或嵌套不匹配) 后续写入全部忽略，错误在 jw_finish 时返回
+ * - 纯逻辑模块，可在主机端直接编译，测试见 tools/json_bench.c
+ */
+
+#define JSON_WRITER_CHUNK 256   // 块缓冲区大小，即每次回调的最大长度
+#define JSON_WRITER_DEPTH 8     // 最大嵌套层数
+
+#define JW_ERR_NESTING (-1)     // 嵌套层数超限或括号不匹配
+
+/**
+ * @brief 送出一块输出
+ * @return 0 成功，其他值为错误码 (由 jw_finish 原样返回)
+ */
+typedef int (*json_flush_t)(void *ctx, const char *data, size_t len);
+
+typedef struct {
+    json_flush_t flush;
+    void *ctx;
+    int err;
+    uint16_t len;
+    uint8_t depth;
+    uint8_t has_member;   // 第 n 位: 第 n 层容器已有成员，下一个成员前需要逗号
+    bool after_key;       // 刚写完键，接下来的值不加逗号
+    char buf[JSON_WRITER_CHUNK];
+} json_writer_t;
+
+/**
+ * @brief 初始化编码器
+ * @param flush 输出回调
+ * @param ctx 传给回调的参数
+ */
+void jw_init(json_writer_t *w, json_flush_t flush, void *ctx);
+
+/**
+ * @brief 开始 / 结束对象与数组
+ */
+void jw_object_begin(json_writer_t *w);
+void jw_object_end(json_writer_t *w);
+void jw_array_begin(json_writer_t *w);
+void jw_array_end(json_writer_t *w);
+
+/**
+ * @brief 写对象的键，随后应写一个值
+ */
+void jw_key(json_writer_t *w, const char *key);
+
+/**
+ * @brief 写值
+ */
+void jw_string(json_writer_t *w, const char *s);
+void jw_uint(json_writer_t *w, uint32_t v);
+void jw_int(json_writer_t *w, int32_t v);
+void jw_bool(json_writer_t *w, bool v);
+
+/**
+ * @brief 送出缓冲区中剩余的输出
+ * @return 0 成功，JW_ERR_NESTING 或回调返回的第一个错误码
+ */
+int jw_finish(json_writer_t *w);
+
+#endif // JSON_WRITER_H
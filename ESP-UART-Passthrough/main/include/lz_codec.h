@@ -0,0 +1,35 @@
+#ifndef LZ_CODEC_H
+#define LZ_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief 小窗口 LZ 压缩 (输出为标准 LZ4 block 格式)
+ * * 设计:
+ * - 单遍贪心匹配，哈希表 LZ_HASH_SIZE 个 16 位位置 (2KB)，由调用者提供，不做任何内存分配
+ * - 每次调用独立压缩一段数据 (不跨段引用)，适合逐个合包压缩
+ * - 输出可直接用 lz4 的 block 解码器解压，主机端见 tools/bridge_client.py
+ * - 纯逻辑模块，可在主机端直接编译
+ */
+
+#define LZ_HASH_BITS 10
+#define LZ_HASH_SIZE (1 << LZ_HASH_BITS)
+
+/**
+ * @brief 压缩输出缓冲区的最小尺寸
+ */
+#define LZ_COMPRESS_BOUND(n) ((n) + (n) / 255 + 16)
+
+/**
+ * @brief 压缩一段数据
+ * @param src 输入数据 (长度不超过 65535)
+ * @param len 输入长度
+ * @param dst 输出缓冲区
+ * @param cap 输出缓冲区大小，必须不小于 LZ_COMPRESS_BOUND(len)
+ * @param hash 工作区，LZ_HASH_SIZE 个元素
+ * @return 压缩后的长度，0 表示参数非法
+ */
+size_t lz_compress(const uint8_t *src, size_t len, uint8_t *dst, size_t cap, uint16_t *hash);
+
+#endif // LZ_CODEC_H
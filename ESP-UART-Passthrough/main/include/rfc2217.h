@@ -0,0 +1,81 @@
+#ifndef RFC2217_H
+#define RFC2217_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// === Telnet 协议字节 ===
+#define TELNET_IAC  255
+#define TELNET_DONT 254
+#define TELNET_DO   253
+#define TELNET_WONT 252
+#define TELNET_WILL 251
+#define TELNET_SB   250
+#define TELNET_SE   240
+
+// === Telnet 选项 ===
+#define TELNET_OPT_BINARY   0
+#define TELNET_OPT_SGA      3
+#define TELNET_OPT_COM_PORT 44
+
+// === RFC 2217 COM-PORT-OPTION 命令 (客户端 -> 服务端，应答时 +100) ===
+#define RFC2217_SET_BAUDRATE       1
+#define RFC2217_SET_DATASIZE       2
+#define RFC2217_SET_PARITY         3
+#define RFC2217_SET_STOPSIZE       4
+#define RFC2217_SET_CONTROL        5
+#define RFC2217_NOTIFY_LINESTATE   6
+#define RFC2217_NOTIFY_MODEMSTATE  7
+#define RFC2217_FLOWCONTROL_SUSPEND 8
+#define RFC2217_FLOWCONTROL_RESUME 9
+#define RFC2217_SET_LINESTATE_MASK 10
+#define RFC2217_SET_MODEMSTATE_MASK 11
+#define RFC2217_PURGE_DATA         12
+#define RFC2217_SERVER_OFFSET      100
+
+// 待发应答缓冲区大小
+#define RFC2217_REPLY_MAX 48
+
+/**
+ * @brief COM-PORT 命令回调
+ * @param ctx 用户上下文
+ * @param cmd 命令号 (RFC2217_SET_xxx)
+ * @param value 命令参数，0 通常表示查询
+ * @return 应答给客户端的实际生效值
+ */
+typedef uint32_t (*rfc2217_cmd_cb_t)(void *ctx, uint8_t cmd, uint32_t value);
+
+/**
+ * @brief RFC 2217 (Telnet COM-PORT-OPTION) 服务端解析器
+ * 纯逻辑模块：从下行字节流中剥离 Telnet 序列，并生成需要回给客户端的应答
+ */
+typedef struct {
+    uint8_t state;
+    uint8_t verb;               // 正在处理的 WILL/WONT/DO/DONT
+    uint8_t sb_len;
+    uint8_t sb_buf[8];          // 子协商内容 (命令号 + 最多 4 字节参数)
+    bool sb_overflow;
+    uint8_t we_opts;            // 本端已启用的选项位
+    uint8_t they_opts;          // 对端已启用的选项位
+    rfc2217_cmd_cb_t cb;
+    void *ctx;
+    uint8_t reply[RFC2217_REPLY_MAX];
+    uint8_t reply_len;          // 待发应答长度，调用者发送后清零
+} rfc2217_t;
+
+/**
+ * @brief 初始化解析器
+ */
+void rfc2217_init(rfc2217_t *t, rfc2217_cmd_cb_t cb, void *ctx);
+
+/**
+ * @brief 解析下行数据，就地去除 Telnet 序列 (含 IAC IAC 反转义)
+ * 产生的协商 / 命令应答追加到 t->reply
+ * @param buf 输入数据，同时作为输出
+ * @param len 输入长度
+ * @return 剩余的纯数据长度
+ */
+size_t rfc2217_decode(rfc2217_t *t, uint8_t *buf, size_t len);
+
+#endif // RFC2217_H
@@ -0,0 +1,114 @@
+#ifndef RINGBUF_H
+#define RINGBUF_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+ * @brief 单生产者 / 多读者无锁环形缓冲区
+ * * 设计:
+ * - 容量必须是 2 的幂，读写位置为自由递增的 32 位计数，取址时按掩码折回
+ * - 生产者永不阻塞：写满后直接覆盖最旧数据，不受任何读者牵制
+ * - 每个读者持有独立的读游标 (rb_reader_t)，慢读者只会丢数据，不会拖住其他读者
+ * - 读者在读取 / 提交时检测被覆盖的区间，丢失字节累计到 lost
+ * - 生产者可先用 rb_space() 查询不越过某个位置的剩余空间，由调用者决定是否等待
+ * - 不依赖 FreeRTOS，纯逻辑模块，可在主机端直接编译
+ */
+typedef struct {
+    uint8_t *buffer;
+    uint32_t size;     // 容量 (2 的幂)
+    uint32_t mask;     // size - 1
+    uint32_t head;     // 已发布的写位置 (仅生产者写)
+    uint32_t reserve;  // 正在写入区间的终点，head <= reserve (仅生产者写)
+} ringbuf_t;
+
+/**
+ * @brief 读游标，由单个消费者独占
+ */
+typedef struct {
+    uint32_t tail;     // 读位置
+    uint32_t lost;     // 因覆盖而丢失的累计字节数
+} rb_reader_t;
+
+/**
+ * @brief 分配并初始化环形缓冲区
+ * @param rb 缓冲区对象
+ * @param size 容量，必须是 2 的幂
+ * @return true 成功, false 参数非法或内存不足
+ */
+bool rb_init(ringbuf_t *rb, size_t size);
+
+/**
+ * @brief 释放缓冲区内存
+ */
+void rb_deinit(ringbuf_t *rb);
+
+/**
+ * @brief 调整容量，保留最新的数据与写位置，已有读游标继续有效 (超出新容量的旧数据按丢失处理)
+ * 非并发安全: 调用期间生产者与所有读者都必须停止访问
+ * @param size 新容量，必须是 2 的幂
+ * @return true 成功, false 参数非法或内存不足 (原缓冲区保持不变)
+ */
+bool rb_resize(ringbuf_t *rb, size_t size);
+
+/**
+ * @brief 当前写位置，可作为新读者的起始位置
+ */
+uint32_t rb_head(const ringbuf_t *rb);
+
+/**
+ * @brief 初始化读游标
+ * @param pos 起始位置，早于仍保留的最旧数据时会在首次读取时自动对齐
+ */
+void rb_reader_init(rb_reader_t *rd, uint32_t pos);
+
+/**
+ * @brief [生产者] 写入数据，最多两段 memcpy
+ * 空间不足时覆盖最旧的数据；len 大于容量时只保留最新的 size 字节
+ */
+void rb_write(ringbuf_t *rb, const uint8_t *data, size_t len);
+
+/**
+ * @brief [生产者] 写入时不覆盖 pin 及其之后数据的剩余空间
+ * 用于保护仍被外部引用的区间 (如零拷贝发送后尚未确认的数据)
+ * @param pin 需要保留的最早位置，已被覆盖或超前于写位置时视为无约束
+ * @return 可写入的字节数
+ */
+size_t rb_space(const ringbuf_t *rb, uint32_t pin);
+
+/**
+ * @brief [读者] 当前可读字节数 (已扣除被覆盖部分)
+ */
+size_t rb_available(ringbuf_t *rb, rb_reader_t *rd);
+
+/**
+ * @brief [读者] 拷贝读取数据
+ * 拷贝过程中若有数据被生产者覆盖，会自动丢弃受影响的前缀
+ * @return 实际读取的有效字节数
+ */
+size_t rb_read(ringbuf_t *rb, rb_reader_t *rd, uint8_t *dst, size_t max_len);
+
+/**
+ * @brief [读者] 获取从读位置开始的一段连续可读区域 (零拷贝)
+ * 使用完毕后必须调用 rb_commit() 推进读位置
+ * @param data 输出：连续区域起始地址
+ * @return 连续区域长度，0 表示无数据
+ */
+size_t rb_peek(ringbuf_t *rb, rb_reader_t *rd, const uint8_t **data);
+
+/**
+ * @brief [读者] 获取从读位置之后 offset 字节处开始的一段连续可读区域
+ * 不推进读位置，用于在发送前扫描待发数据
+ * @return 连续区域长度，0 表示 offset 之后没有数据
+ */
+size_t rb_peek_at(ringbuf_t *rb, rb_reader_t *rd, size_t offset, const uint8_t **data);
+
+/**
+ * @brief [读者] 提交 rb_peek() 区域中已消费的字节
+ * @param len 已消费字节数 (不大于 rb_peek 返回值)
+ * @return true 区域在使用期间完好, false 使用期间已被生产者覆盖 (数据可能已损坏)
+ */
+bool rb_commit(ringbuf_t *rb, rb_reader_t *rd, size_t len);
+
+#endif // RINGBUF_H
@@ -0,0 +1,51 @@
+#ifndef SOFT_UART_H
+#define SOFT_UART_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+ * @brief 软件 UART 接收 (8N1，只收)，用于在 GPIO 上扩展额外的串口通道
+ * * 设计:
+ * - 中断里只记录边沿: CPU 周期计数 + 边沿后的电平，写入单生产者 / 单消费者的边沿队列
+ * - 解码在任务中进行: 按起始位下降沿推算各位中点，两次边沿之间的位取前一个电平
+ * - 中断耗时与波特率无关，不像逐位延时采样那样长时间关中断影响 Wi-Fi
+ * - 边沿队列按 38400 波特率、10ms 解码周期估算，更高的波特率会丢边沿 (计入 edge_overflow)
+ */
+
+#define SOFT_UART_EDGES 512  // 边沿队列长度，必须是 2 的幂
+
+typedef struct {
+    int gpio;
+    uint32_t bit_cycles;          // 每位的 CPU 周期数
+    // 边沿队列 (中断写入，解码任务读取)
+    uint32_t edges[SOFT_UART_EDGES];  // 周期计数，最低位替换为边沿后的电平
+    volatile uint32_t edge_head;
+    uint32_t edge_tail;
+    volatile uint32_t edge_overflow;  // 队列满丢弃的边沿数
+    // 解码状态 (仅解码任务访问)
+    uint8_t level;                // 最近一次边沿后的电平
+    bool in_frame;
+    uint8_t bit;                  // 下一个待采样的位 (0 起始位, 1..8 数据位, 9 停止位)
+    uint8_t shift;
+    uint32_t frame_start;         // 起始位下降沿的周期计数
+    uint32_t frame_errors;        // 停止位不为 1 的帧数
+} soft_uart_t;
+
+/**
+ * @brief 配置 GPIO 为输入并注册边沿中断
+ * @param gpio 接收引脚 (需支持中断，不能是 GPIO16)
+ * @param baud 波特率
+ * @return true 成功
+ */
+bool soft_uart_init(soft_uart_t *su, int gpio, uint32_t baud);
+
+/**
+ * @brief 解码已记录的边沿，取出完整的字节
+ * 线路空闲后最后一个字节的高电平位不产生边沿，按当前时间补齐
+ * @return 取出的字节数
+ */
+size_t soft_uart_read(soft_uart_t *su, uint8_t *buf, size_t len);
+
+#endif // SOFT_UART_H
@@ -1,15 +1,73 @@
 #ifndef TCP_BRIDGE_H
 #define TCP_BRIDGE_H
 
+#include <stdint.h>
+#include "esp_err.h"
+#include "bridge_config.h"
+#include "bridge_stats.h"
+
 /**
  * @brief 初始化 TCP 到 UART 的透传桥接
  * * 硬件连接:
  * - ESP8266 D7 (GPIO13) <--> 目标 TX
  * - ESP8266 D8 (GPIO15) <--> 目标 RX
  * * 逻辑:
- * - 启动 TCP Server (Port 8888)
- * - 客户端连接后，启动双任务全双工透传
+ * - 启动 TCP Server (默认 Port 8888)，支持多个客户端同时连接
+ * - 上行: 串口数据广播给所有客户端，每个客户端独立读游标
+ * - 下行: 按控制权策略 (先写者 / 独占 / 合并) 写入串口，经发送环异步发出，
+ *   发送环满时暂停读取、由 TCP 窗口反压对端，可按线速透传固件烧录 (stm32flash / avrdude 等)
+ * - RFC 2217 (Port 2217): 同一数据流外加 Telnet 串口控制，
+ *   可远程修改波特率 / 数据位 / 校验 / 停止位，DTR->D1(GPIO5)、RTS->D2(GPIO4) 低电平有效
+ * - 分帧 (Port 8889): 同一数据流，每段附带字节序号与采集时间，溢出时给出 GAP 记录 (见 bridge_frame.h)
+ * - 分帧 + 压缩 (可选，如 Port 8890): 数据记录按合包 LZ4 压缩，主机端用 tools/bridge_client.py 解码
+ * - 附加通道 (可选): GPIO 上的软件 UART 只收通道，数据经两个分帧端口与 UART0 复用发送，帧头带通道号
+ * - TLS (可选): 同一原始数据流经 TLS-PSK 加密，支持会话票据快速重连 (见 bridge_tls.h、tools/tls_bench.py)；
+ *   首个密钥只能在配网模式下设置，之后更换须提供当前密钥；TLS_ONLY 时设置密钥后关闭明文数据端口
+ * - UDP 上行 (可选): 同一数据流以带序号的数据报发布到单播地址或组播组，接收端数量不限
+ * - 离线缓存 (可选): 没有客户端时串口数据写入 Flash spool 分区，首个原始协议客户端连接时先补发 RAM 中已覆盖的部分
+ * - 运行参数 (端口 / 波特率 / 缓存大小等) 保存在 NVS，可经网页 /bridge 或控制端口 8880 修改
+ * - 过滤: 串口数据可按模式只转发 / 丢弃匹配的行，或只转发触发模式前后的数据 (见 uart_filter.h)
+ * - 统计: 各环节计数可经网页 /stats (JSON) 或 UDP 端口 8881 (二进制快照) 查询
+ * - 失联检测: TCP 保活 + 发送停滞超时，对端消失后约十秒内释放槽位；槽位已满时新连接可替换失效会话
  */
 void tcp_bridge_init(void);
 
+/**
+ * @brief 运行时修改桥接串口的波特率 (无需重新烧录)
+ * @param baud 目标波特率，如 921600、2000000
+ * @return ESP_OK 成功，其他为驱动返回的错误码
+ */
+esp_err_t tcp_bridge_set_baudrate(uint32_t baud);
+
+/**
+ * @brief 获取桥接串口当前的波特率
+ */
+uint32_t tcp_bridge_get_baudrate(void);
+
+/**
+ * @brief 获取已保存的运行参数 (可能尚未全部生效)
+ */
+void tcp_bridge_get_config(bridge_config_t *cfg);
+
+/**
+ * @brief 保存运行参数到 NVS 并应用
+ * * 生效时机:
+ * - 波特率: 立即
+ * - 原始透传端口: 立即重新监听，已连接的客户端不受影响
+ * - 缓存 / 读写块大小: 没有客户端时立即重新分配，否则等最后一个客户端断开
+ * - TLS 密钥: 立即，现有 TLS 会话被断开，已签发的会话票据作废；TLS_ONLY 时明文数据端口随之关闭 / 重新打开
+ * @return ESP_OK 成功，其他为 NVS 错误码 (此时不做任何修改)
+ */
+esp_err_t tcp_bridge_apply_config(const bridge_config_t *cfg);
+
+/**
+ * @brief 缓存 / 读写块大小的修改是否还在等待所有客户端断开
+ */
+bool tcp_bridge_resize_pending(void);
+
+/**
+ * @brief 获取各环节的统计快照 (可在任意任务中调用，不加锁)
+ */
+void tcp_bridge_get_stats(bridge_stats_t *st);
+
 #endif // TCP_BRIDGE_H
\ No newline at end of file
@@ -0,0 +1,81 @@
+#ifndef UART_FILTER_H
+#define UART_FILTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+ * @brief 串口数据过滤: 多模式匹配 (Aho-Corasick 编译为 DFA) + 按行 / 触发捕获输出
+ * * 设计:
+ * - 模式以 '|' 分隔，如 "ERROR|panic|Guru Meditation"，区分大小写
+ * - 出现在模式中的字节各占一个等价类，其余字节共用一类，转移表为 状态数 x 类数 的字节数组
+ * - 每个输入字节固定两次查表 (等价类 + 转移)，与模式数量无关；行内已判定后只找换行符
+ * - 输出以区间回调给调用者，直通部分不拷贝
+ * - 不依赖 FreeRTOS，纯逻辑模块，可在主机端直接编译 (性能测试见 tools/filter_bench.c)
+ */
+
+#define UART_FILTER_OFF     0  // 不过滤
+#define UART_FILTER_PASS    1  // 只转发包含任一模式的行
+#define UART_FILTER_DROP    2  // 丢弃包含任一模式的行
+#define UART_FILTER_CAPTURE 3  // 只转发每次触发前后各 context 字节，触发窗口内再次触发则顺延
+
+#define UART_FILTER_MAX_PATTERNS 8
+#define UART_FILTER_PATTERNS_MAX 63  // 模式总长度 (含分隔符) 上限，DFA 状态数不超过 64
+#define UART_FILTER_LINE_MAX 256     // 行缓冲大小，超长的行只按前 LINE_MAX 字节判定
+#define UART_FILTER_CONTEXT_MAX (8 * 1024)
+
+// 输出回调: 过滤后的数据，按输入顺序分段给出
+typedef void (*uart_filter_emit_t)(void *ctx, const uint8_t *data, size_t len);
+
+typedef struct {
+    uint8_t mode;
+    uint8_t num_states;
+    uint8_t num_classes;
+    uint8_t state;             // 当前 DFA 状态
+    uint8_t byte_class[256];   // 字节 -> 等价类
+    uint8_t *delta;            // 转移表 [状态][等价类]，最高位表示目标状态命中某个模式
+    // 行模式 (PASS / DROP)
+    uint8_t *line;             // 尚未判定的行
+    uint16_t line_len;
+    uint8_t line_verdict;      // 当前行的判定: 0 未定, 1 转发其余部分, 2 丢弃其余部分
+    // 捕获模式
+    uint8_t *hist;             // 触发前的历史 (循环缓冲区，容量 context)
+    uint32_t context;
+    uint32_t hist_pos;         // 下一个写入位置
+    uint32_t hist_fill;        // 有效字节数 (不超过 context)
+    uint32_t post_remain;      // 触发后还需转发的字节数
+    // 统计
+    uint32_t matches;          // 模式命中次数
+    uint32_t bytes_in;
+    uint32_t bytes_out;
+} uart_filter_t;
+
+/**
+ * @brief 检查模式串是否合法 (非空、数量与总长度不超限、无空模式)
+ */
+bool uart_filter_check(const char *patterns);
+
+/**
+ * @brief 编译模式并分配缓冲区
+ * @param mode UART_FILTER_xxx，OFF 时不分配任何内存
+ * @param patterns '|' 分隔的模式串
+ * @param context 捕获模式下触发前后各保留的字节数，其他模式忽略
+ * @return true 成功, false 参数非法或内存不足 (此时过滤器为 OFF 状态，可直接 deinit)
+ */
+bool uart_filter_init(uart_filter_t *f, uint8_t mode, const char *patterns, uint32_t context);
+
+/**
+ * @brief 释放缓冲区，过滤器回到 OFF 状态
+ */
+void uart_filter_deinit(uart_filter_t *f);
+
+/**
+ * @brief 输入一段串口数据，通过过滤的部分经 emit 输出 (可能分多次调用)
+ * 行模式下未结束的行保留在过滤器内，等后续数据判定
+ * @return 本次输出的字节数
+ */
+size_t uart_filter_feed(uart_filter_t *f, const uint8_t *data, size_t len,
+                        uart_filter_emit_t emit, void *ctx);
+
+#endif // UART_FILTER_H
@@ -21,4 +21,13 @@ void url_decode(char *dst, const char *src, size_t dst_len);
  */
 bool parse_mac_address(const char *str, uint8_t mac[6]);
 
+/**
+ * @brief 十六进制字符串解码 (不区分大小写，不允许分隔符)
+ * @param dst 输出缓冲区，可为 NULL (只校验)
+ * @param src 输入字符串，长度必须为偶数
+ * @param dst_len 输出缓冲区大小
+ * @return 解码出的字节数，格式非法或超出 dst_len 时返回 -1
+ */
+int hex_decode(uint8_t *dst, const char *src, size_t dst_len);
+
 #endif // UTILS_H
\ No newline at end of file
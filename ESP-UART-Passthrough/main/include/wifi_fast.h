@@ -0,0 +1,45 @@
+#ifndef WIFI_FAST_H
+#define WIFI_FAST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief 快速重连缓存，保存在 NVS 命名空间 "wifi_fast"
+ * * 说明:
+ * - 每次连上路由后记录 AP 的信道、BSSID 与本次获得的地址 (IP / 掩码 / 网关 / DNS)
+ * - 下次启动时据此只在该信道上连接指定 BSSID，并先直接使用缓存的地址，省去全信道扫描与等待 DHCP；
+ *   关联后重新启动 DHCP 确认，按拿到的租约更新缓存，拿不到租约时作废缓存
+ * - 记录中带有 SSID，用户改连其他路由后旧记录自动失效
+ * - 内容不变时不写 Flash，正常使用下只在首次连接或网络变化时写入
+ */
+typedef struct {
+    uint8_t version;
+    uint8_t channel;
+    uint8_t bssid[6];
+    uint8_t ssid[32];     // 与 wifi_sta_config_t.ssid 相同，不一定以 '\0' 结尾
+    uint32_t ip;          // 以下均为网络字节序，ip 为 0 表示没有可用的地址
+    uint32_t netmask;
+    uint32_t gw;
+    uint32_t dns;
+} wifi_fast_t;
+
+/**
+ * @brief 读取缓存
+ * @param ssid 当前配置的 SSID (32 字节)
+ * @param fast 输出
+ * @return true 存在与该 SSID 对应的有效记录
+ */
+bool wifi_fast_load(const uint8_t ssid[32], wifi_fast_t *fast);
+
+/**
+ * @brief 保存缓存，与已保存的内容相同时跳过
+ */
+void wifi_fast_save(const wifi_fast_t *fast);
+
+/**
+ * @brief 作废缓存，下次启动走完整的扫描 + DHCP
+ */
+void wifi_fast_invalidate(void);
+
+#endif // WIFI_FAST_H
@@ -5,6 +5,11 @@
 #define AP_SSID "ESP8266_Config"
 #define AP_PASS "" 
 
+// WebServer 并发连接数，超出时关闭最久未用的连接
+// 另占 3 个内部 socket (监听与两个控制 socket)，与桥接共用 CONFIG_LWIP_MAX_SOCKETS (预算见 tcp_bridge.c)
+#define WEB_MAX_OPEN_SOCKETS 1
+#define WEB_SOCKETS (WEB_MAX_OPEN_SOCKETS + 3)
+
 /**
  * @brief 初始化 WiFi 逻辑
  * * 自动检测 NVS 中是否存在 WiFi 配置：
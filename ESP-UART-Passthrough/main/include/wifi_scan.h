@@ -0,0 +1,63 @@
+#ifndef WIFI_SCAN_H
+#define WIFI_SCAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief 后台 WiFi 扫描与结果缓存
+ * * 设计:
+ * - 扫描以非阻塞方式启动，结果在 WIFI_EVENT_SCAN_DONE 中整理进缓存表，HTTP 处理函数只读快照，不再等待扫描
+ * - 同名 SSID 只保留信号最强的一条，按 RSSI 从强到弱排序，隐藏网络 (空 SSID) 不收录
+ * - 快照超过 WIFI_SCAN_TTL_MS 后，下一次查询在后台触发刷新；没有人查看时不扫描
+ *   (扫描期间 SoftAP 要离开工作信道，周期性扫描会打断已连接的手机)
+ * - 每完成一次扫描快照版本号加 1，页面据此判断是否需要重绘
+ */
+
+#define WIFI_SCAN_MAX_AP 32                 // 缓存表容量 (去重之后，只保留信号最强的若干个网络)
+#define WIFI_SCAN_RAW_MAX 64                // 每次从驱动取回的原始记录上限 (临时分配，取完即释放)
+#define WIFI_SCAN_TTL_MS 30000              // 快照有效期
+#define WIFI_SCAN_MIN_INTERVAL_MS 5000      // 手动刷新的最小间隔
+#define WIFI_SCAN_TIMEOUT_MS 10000          // 超过该时间仍未收到 SCAN_DONE 视为扫描已丢失
+
+typedef struct {
+    char ssid[33];
+    uint8_t bssid[6];
+    int8_t rssi;
+    uint8_t authmode;   // wifi_auth_mode_t
+} wifi_scan_ap_t;
+
+typedef struct {
+    uint32_t gen;       // 快照版本号，0 表示还没有完成过扫描
+    uint32_t age_ms;    // 快照距今的时间
+    bool scanning;      // 后台扫描进行中
+} wifi_scan_info_t;
+
+/**
+ * @brief 初始化缓存并注册 SCAN_DONE 事件 (在 esp_wifi_init 之后调用)
+ */
+void wifi_scan_init(void);
+
+/**
+ * @brief 按需启动后台扫描，立即返回
+ * * 已在扫描中则不重复启动；否则在快照过期时启动，
+ * * force 时只要距上次扫描超过 WIFI_SCAN_MIN_INTERVAL_MS 即启动
+ * @return true 当前有扫描在进行
+ */
+bool wifi_scan_request(bool force);
+
+/**
+ * @brief 读取当前快照的信息
+ */
+void wifi_scan_info(wifi_scan_info_t *info);
+
+/**
+ * @brief 逐条读取快照，调用者无需为整张表分配内存
+ * @param gen 期望的快照版本 (来自 wifi_scan_info)
+ * @param index 序号，按 RSSI 从强到弱
+ * @param ap 输出
+ * @return false 序号越界，或快照已被新的扫描结果替换
+ */
+bool wifi_scan_entry(uint32_t gen, int index, wifi_scan_ap_t *ap);
+
+#endif // WIFI_SCAN_H
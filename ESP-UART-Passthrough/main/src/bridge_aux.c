@@ -0,0 +1,117 @@
+#include "bridge_aux.h"
+
+#if AUX_UART_NUM > 0
+#include "soft_uart.h"
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+static const char *TAG = "Bridge_Aux";
+
+typedef struct {
+    soft_uart_t su;
+    ringbuf_t rb;
+    volatile int64_t last_rx_us;  // 最近一次取出数据的时间，作为记录的近似采集时间
+    uint32_t overflow_reported;
+} aux_channel_t;
+
+static aux_channel_t *s_aux;
+static void (*s_wake)(void);
+
+static void aux_uart_task(void *arg) {
+    uint8_t buf[64];
+
+    while (1) {
+        vTaskDelay(AUX_POLL_MS / portTICK_RATE_MS > 0 ? AUX_POLL_MS / portTICK_RATE_MS : 1);
+
+        bool any = false;
+        for (int ch = 0; ch < AUX_UART_NUM; ch++) {
+            aux_channel_t *a = &s_aux[ch];
+            size_t n;
+            while ((n = soft_uart_read(&a->su, buf, sizeof(buf))) > 0) {
+                rb_write(&a->rb, buf, n);
+                a->last_rx_us = esp_timer_get_time();
+                any = true;
+            }
+            if (a->su.edge_overflow != a->overflow_reported) {
+                ESP_LOGW(TAG, "Aux UART %d: %u edges dropped, baud rate too high?", ch + 1,
+                         (unsigned)(a->su.edge_overflow - a->overflow_reported));
+                a->overflow_reported = a->su.edge_overflow;
+            }
+        }
+        if (any && s_wake) {
+            s_wake();
+        }
+    }
+}
+
+bool bridge_aux_init(void (*wake)(void)) {
+    static const int gpios[AUX_UART_NUM] = AUX_UART_GPIOS;
+
+    s_aux = calloc(AUX_UART_NUM, sizeof(aux_channel_t));
+    if (!s_aux) return false;
+    s_wake = wake;
+    // 初始化失败的通道没有缓存或中断，保持空闲，不影响其他通道
+    for (int ch = 0; ch < AUX_UART_NUM; ch++) {
+        if (!rb_init(&s_aux[ch].rb, AUX_CACHE_SIZE) ||
+            !soft_uart_init(&s_aux[ch].su, gpios[ch], AUX_UART_BAUD)) {
+            ESP_LOGE(TAG, "Aux UART %d on GPIO%d unavailable", ch + 1, gpios[ch]);
+            continue;
+        }
+        ESP_LOGI(TAG, "Aux UART %d: RX on GPIO%d, %d baud", ch + 1, gpios[ch], AUX_UART_BAUD);
+    }
+    xTaskCreate(aux_uart_task, "aux_uart", 1536, NULL, 8, NULL);
+    return true;
+}
+
+void bridge_aux_reader_init(bridge_aux_reader_t *r) {
+    r->next = 0;
+    for (int ch = 0; ch < AUX_UART_NUM; ch++) {
+        rb_reader_init(&r->reader[ch], s_aux ? rb_head(&s_aux[ch].rb) : 0);
+        r->gapped[ch] = 0;
+    }
+}
+
+size_t bridge_aux_next_record(bridge_aux_reader_t *r, const uint8_t **rec) {
+    if (!s_aux) return 0;
+    for (int k = 0; k < AUX_UART_NUM; k++) {
+        int ch = (r->next + k) % AUX_UART_NUM;
+        aux_channel_t *a = &s_aux[ch];
+        rb_reader_t *rd = &r->reader[ch];
+        uint8_t flags = BRIDGE_FRAME_F_CHANNEL(ch + 1) | BRIDGE_FRAME_F_TS_APPROX;
+        uint8_t *payload = r->rec + BRIDGE_FRAME_HDR_LEN;
+        size_t len;
+
+        // 先声明已知的丢失；读取期间发生覆盖时连同读出部分一并计入，保证 GAP 紧邻读位置
+        size_t got = 0;
+        if (rb_available(&a->rb, rd) > 0 && rd->lost == r->gapped[ch]) {
+            got = rb_read(&a->rb, rd, payload, AUX_RECORD_MAX);
+            if (rd->lost != r->gapped[ch]) {
+                rd->lost += got;
+                got = 0;
+            }
+        }
+
+        uint32_t gap = rd->lost - r->gapped[ch];
+        if (gap > 0) {
+            bridge_frame_header(r->rec, BRIDGE_FRAME_GAP, flags, 4,
+                                rd->tail - gap, esp_timer_get_time());
+            bridge_frame_put_u32(payload, gap);
+            len = BRIDGE_FRAME_HDR_LEN + 4;
+            r->gapped[ch] = rd->lost;
+        } else if (got > 0) {
+            bridge_frame_header(r->rec, BRIDGE_FRAME_DATA, flags, (uint16_t)got,
+                                rd->tail - got, a->last_rx_us);
+            len = BRIDGE_FRAME_HDR_LEN + got;
+        } else {
+            continue;
+        }
+        r->next = (ch + 1) % AUX_UART_NUM;
+        *rec = r->rec;
+        return len;
+    }
+    return 0;
+}
+#endif
@@ -0,0 +1,85 @@
+#include "bridge_bench.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+static const char *TAG = "Bridge_Bench";
+
+static const bridge_bench_ops_t *s_ops;
+static uint32_t s_busy_us = 0;   // 生成与发布的累计耗时
+
+static void bench_report(int64_t elapsed_us, uint32_t generated) {
+    static bridge_bench_snapshot_t prev;
+    static uint32_t prev_busy = 0;
+    bridge_bench_snapshot_t now;
+    s_ops->snapshot(&now);
+
+    // 直方图只取本周期的增量
+    uint32_t hist[BRIDGE_LAT_HIST_BUCKETS];
+    uint32_t samples = 0;
+    for (int i = 0; i < BRIDGE_LAT_HIST_BUCKETS; i++) {
+        hist[i] = now.hist[i] - prev.hist[i];
+        samples += hist[i];
+    }
+
+    uint32_t sent = now.sent - prev.sent;
+    uint32_t busy = (now.busy_us - prev.busy_us) + (s_busy_us - prev_busy);
+    // 客户端断开后其丢弃计数随之消失，差值为负时按 0 计
+    uint32_t lost = now.lost > prev.lost ? now.lost - prev.lost : 0;
+    prev = now;
+    prev_busy = s_busy_us;
+
+    // 字节/微秒即 MB/s，保留三位小数
+    uint32_t mbps_milli = (uint32_t)((uint64_t)sent * 1000 / elapsed_us);
+    ESP_LOGI(TAG, "Bench: gen %u B, sent %u.%03u MB/s, latency p50 <%uus p99 <%uus p999 <%uus, "
+             "dropped %u B, cpu %u us/KB",
+             (unsigned)generated, (unsigned)(mbps_milli / 1000), (unsigned)(mbps_milli % 1000),
+             (unsigned)bridge_stats_percentile(hist, samples, 500),
+             (unsigned)bridge_stats_percentile(hist, samples, 990),
+             (unsigned)bridge_stats_percentile(hist, samples, 999),
+             (unsigned)lost,
+             (unsigned)(sent > 0 ? (uint64_t)busy * 1024 / sent : 0));
+}
+
+static void bench_task(void *arg) {
+    (void)arg;
+    uint8_t burst[BENCH_BURST];
+    uint8_t seq = 0;
+    uint32_t credit = 0;
+    uint32_t generated = 0;
+    int64_t report_start = esp_timer_get_time();
+    TickType_t last_wake = xTaskGetTickCount();
+
+    ESP_LOGW(TAG, "Benchmark mode: generating %d B/s", BENCH_RATE_BPS);
+
+    while (1) {
+        vTaskDelayUntil(&last_wake, 1);
+
+        credit = s_ops->paused() ? 0 : credit + BENCH_RATE_BPS / configTICK_RATE_HZ;
+
+        while (credit >= BENCH_BURST) {
+            for (int i = 0; i < BENCH_BURST; i++) {
+                burst[i] = seq++;
+            }
+            int64_t t0 = esp_timer_get_time();
+            credit -= BENCH_BURST;
+            generated += BENCH_BURST;
+            // 本 tick 的最后一批视为线路空闲
+            s_ops->publish(burst, BENCH_BURST, t0, credit < BENCH_BURST);
+            s_busy_us += esp_timer_get_time() - t0;
+        }
+
+        int64_t now = esp_timer_get_time();
+        if (now - report_start >= BENCH_REPORT_MS * 1000LL) {
+            bench_report(now - report_start, generated);
+            report_start = now;
+            generated = 0;
+        }
+    }
+}
+
+void bridge_bench_start(const bridge_bench_ops_t *ops) {
+    s_ops = ops;
+    xTaskCreate(bench_task, "bridge_bench", 2048, NULL, 9, NULL);
+}
@@ -0,0 +1,188 @@
+#include "bridge_config.h"
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nvs.h"
+#include "esp_log.h"
+#include "utils.h"
+
+static const char *TAG = "Bridge_Cfg";
+
+#define CFG_NAMESPACE "bridge"
+
+static bool cfg_valid_port(uint32_t v) {
+    return v > 0 && v <= 65535;
+}
+
+static bool cfg_valid_baud(uint32_t v) {
+    return v >= BRIDGE_CFG_BAUD_MIN && v <= BRIDGE_CFG_BAUD_MAX;
+}
+
+static bool cfg_valid_chunk(uint32_t v) {
+    return v >= BRIDGE_CFG_CHUNK_MIN && v <= BRIDGE_CFG_CHUNK_MAX;
+}
+
+static bool cfg_valid_cache(uint32_t v) {
+    return v >= BRIDGE_CFG_CACHE_MIN && v <= BRIDGE_CFG_CACHE_MAX && (v & (v - 1)) == 0;
+}
+
+static bool cfg_valid_context(uint32_t v) {
+    return v >= BRIDGE_CFG_CONTEXT_MIN && v <= BRIDGE_CFG_CONTEXT_MAX;
+}
+
+static bool cfg_valid_psk(const char *v) {
+    size_t len = strlen(v);
+    return len == 0 || (len >= BRIDGE_CFG_PSK_MIN && len <= BRIDGE_CFG_PSK_MAX &&
+                        hex_decode(NULL, v, BRIDGE_CFG_PSK_MAX / 2) > 0);
+}
+
+static const char *s_filter_names[] = { "off", "pass", "drop", "capture" };
+#define FILTER_MODE_NUM ((int)(sizeof(s_filter_names) / sizeof(s_filter_names[0])))
+
+const char *bridge_config_filter_name(uint8_t mode) {
+    return mode < FILTER_MODE_NUM ? s_filter_names[mode] : "?";
+}
+
+void bridge_config_defaults(bridge_config_t *cfg) {
+    cfg->tcp_port = BRIDGE_CFG_TCP_PORT;
+    cfg->baudrate = BRIDGE_CFG_BAUDRATE;
+    cfg->chunk_size = BRIDGE_CFG_CHUNK_SIZE;
+    cfg->cache_size = BRIDGE_CFG_CACHE_SIZE;
+    cfg->filter_mode = BRIDGE_CFG_FILTER_MODE;
+    cfg->filter_context = BRIDGE_CFG_FILTER_CONTEXT;
+    strcpy(cfg->filter_patterns, BRIDGE_CFG_FILTER_PATTERNS);
+    cfg->tls_psk[0] = '\0';
+}
+
+esp_err_t bridge_config_load(bridge_config_t *cfg) {
+    bridge_config_defaults(cfg);
+
+    nvs_handle handle;
+    esp_err_t err = nvs_open(CFG_NAMESPACE, NVS_READONLY, &handle);
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        return ESP_OK;  // 从未保存过
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    uint8_t u8;
+    uint16_t u16;
+    uint32_t u32;
+    char str[sizeof(cfg->tls_psk) > sizeof(cfg->filter_patterns) ?
+             sizeof(cfg->tls_psk) : sizeof(cfg->filter_patterns)];
+    size_t str_len = sizeof(str);
+    if (nvs_get_u16(handle, "port", &u16) == ESP_OK && cfg_valid_port(u16)) {
+        cfg->tcp_port = u16;
+    }
+    if (nvs_get_u32(handle, "baud", &u32) == ESP_OK && cfg_valid_baud(u32)) {
+        cfg->baudrate = u32;
+    }
+    if (nvs_get_u16(handle, "chunk", &u16) == ESP_OK && cfg_valid_chunk(u16)) {
+        cfg->chunk_size = u16;
+    }
+    if (nvs_get_u32(handle, "cache", &u32) == ESP_OK && cfg_valid_cache(u32)) {
+        cfg->cache_size = u32;
+    }
+    if (nvs_get_u8(handle, "filter", &u8) == ESP_OK && u8 < FILTER_MODE_NUM) {
+        cfg->filter_mode = u8;
+    }
+    if (nvs_get_u16(handle, "context", &u16) == ESP_OK && cfg_valid_context(u16)) {
+        cfg->filter_context = u16;
+    }
+    if (nvs_get_str(handle, "patterns", str, &str_len) == ESP_OK && uart_filter_check(str)) {
+        strcpy(cfg->filter_patterns, str);
+    }
+    str_len = sizeof(str);
+    if (nvs_get_str(handle, "psk", str, &str_len) == ESP_OK && cfg_valid_psk(str)) {
+        strcpy(cfg->tls_psk, str);
+    }
+    nvs_close(handle);
+    return ESP_OK;
+}
+
+esp_err_t bridge_config_save(const bridge_config_t *cfg) {
+    nvs_handle handle;
+    esp_err_t err = nvs_open(CFG_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    err = nvs_set_u16(handle, "port", cfg->tcp_port);
+    if (err == ESP_OK) err = nvs_set_u32(handle, "baud", cfg->baudrate);
+    if (err == ESP_OK) err = nvs_set_u16(handle, "chunk", cfg->chunk_size);
+    if (err == ESP_OK) err = nvs_set_u32(handle, "cache", cfg->cache_size);
+    if (err == ESP_OK) err = nvs_set_u8(handle, "filter", cfg->filter_mode);
+    if (err == ESP_OK) err = nvs_set_u16(handle, "context", cfg->filter_context);
+    if (err == ESP_OK) err = nvs_set_str(handle, "patterns", cfg->filter_patterns);
+    if (err == ESP_OK) err = nvs_set_str(handle, "psk", cfg->tls_psk);
+    if (err == ESP_OK) err = nvs_commit(handle);
+    nvs_close(handle);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Save failed (%s)", esp_err_to_name(err));
+    }
+    return err;
+}
+
+esp_err_t bridge_config_set(bridge_config_t *cfg, const char *key, const char *value) {
+    char *end;
+    unsigned long v = strtoul(value, &end, 10);
+    bool number = end != value && *end == '\0';
+
+    if (strcmp(key, "port") == 0) {
+        if (!number || !cfg_valid_port(v)) return ESP_ERR_INVALID_ARG;
+        cfg->tcp_port = (uint16_t)v;
+    } else if (strcmp(key, "baud") == 0) {
+        if (!number || !cfg_valid_baud(v)) return ESP_ERR_INVALID_ARG;
+        cfg->baudrate = (uint32_t)v;
+    } else if (strcmp(key, "chunk") == 0) {
+        if (!number || !cfg_valid_chunk(v)) return ESP_ERR_INVALID_ARG;
+        cfg->chunk_size = (uint16_t)v;
+    } else if (strcmp(key, "cache") == 0) {
+        if (!number || !cfg_valid_cache(v)) return ESP_ERR_INVALID_ARG;
+        cfg->cache_size = (uint32_t)v;
+    } else if (strcmp(key, "filter") == 0) {
+        int mode = -1;
+        for (int i = 0; i < FILTER_MODE_NUM; i++) {
+            if (strcmp(value, s_filter_names[i]) == 0) mode = i;
+        }
+        if (mode < 0) return ESP_ERR_INVALID_ARG;
+        cfg->filter_mode = (uint8_t)mode;
+    } else if (strcmp(key, "patterns") == 0) {
+        if (!uart_filter_check(value)) return ESP_ERR_INVALID_ARG;
+        strcpy(cfg->filter_patterns, value);
+    } else if (strcmp(key, "context") == 0) {
+        if (!number || !cfg_valid_context(v)) return ESP_ERR_INVALID_ARG;
+        cfg->filter_context = (uint16_t)v;
+    } else if (strcmp(key, "psk") == 0) {
+        if (strcmp(value, "off") == 0) value = "";
+        if (!cfg_valid_psk(value)) return ESP_ERR_INVALID_ARG;
+        strcpy(cfg->tls_psk, value);
+    } else {
+        return ESP_ERR_NOT_FOUND;
+    }
+    return ESP_OK;
+}
+
+bool bridge_config_psk_equal(const bridge_config_t *cfg, const char *psk) {
+    size_t len = strlen(cfg->tls_psk);
+    if (len == 0 || strlen(psk) != len) return false;
+    uint8_t diff = 0;
+    for (size_t i = 0; i < len; i++) {
+        diff |= (uint8_t)(tolower((unsigned char)cfg->tls_psk[i]) ^ tolower((unsigned char)psk[i]));
+    }
+    return diff == 0;
+}
+
+int bridge_config_format(const bridge_config_t *cfg, char *buf, size_t len) {
+    // 密钥本身不输出
+    return snprintf(buf, len, "port=%u baud=%u chunk=%u cache=%u filter=%s context=%u tls=%s patterns=%s",
+                    (unsigned)cfg->tcp_port, (unsigned)cfg->baudrate,
+                    (unsigned)cfg->chunk_size, (unsigned)cfg->cache_size,
+                    bridge_config_filter_name(cfg->filter_mode),
+                    (unsigned)cfg->filter_context, cfg->tls_psk[0] ? "on" : "off",
+                    cfg->filter_patterns);
+}
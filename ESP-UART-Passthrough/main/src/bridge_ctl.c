@@ -0,0 +1,155 @@
+#include "bridge_ctl.h"
+#include "bridge_config.h"
+#include "tcp_bridge.h"
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+
+static const char *TAG = "Bridge_Ctl";
+
+static int s_ctl_listen = -1;
+static int s_ctl_sock = -1;
+static char s_ctl_line[BRIDGE_CTL_LINE_MAX];
+static size_t s_ctl_len = 0;
+
+static void ctl_close(void);
+
+// socket 为非阻塞: 对端不读取应答、发送缓冲区放不下时直接断开，不能拖住 I/O 任务
+static void ctl_reply(const char *msg) {
+    char line[BRIDGE_CTL_REPLY_MAX + 2];
+    int len = snprintf(line, sizeof(line), "%.*s\r\n", BRIDGE_CTL_REPLY_MAX, msg);
+    if (send(s_ctl_sock, line, len, 0) != len) {
+        ESP_LOGW(TAG, "Control connection not reading replies, closed");
+        ctl_close();
+    }
+}
+
+// 执行一行命令
+static void ctl_command(char *line) {
+    char *argv[4] = { 0 };
+    int argc = 0;
+    char *save;
+    for (char *tok = strtok_r(line, " \t", &save); tok && argc < 4; tok = strtok_r(NULL, " \t", &save)) {
+        argv[argc++] = tok;
+    }
+    if (argc == 0) return;
+
+    bridge_config_t cfg;
+    tcp_bridge_get_config(&cfg);
+    char buf[BRIDGE_CTL_REPLY_MAX];
+
+    if (strcmp(argv[0], "get") == 0) {
+        int n = bridge_config_format(&cfg, buf, sizeof(buf));
+        if (tcp_bridge_resize_pending() && n < (int)sizeof(buf)) {
+            snprintf(buf + n, sizeof(buf) - n, " (resize pending)");
+        }
+        ctl_reply(buf);
+    } else if (strcmp(argv[0], "set") == 0 && argc >= 3 && strcmp(argv[1], "psk") == 0) {
+        // 控制端口是明文: 只能凭当前密钥更换 / 清除，首个密钥须在配网页面设置
+        if (cfg.tls_psk[0] == '\0') {
+            ctl_reply("error: set the first psk from the provisioning page");
+        } else if (argc != 4 || !bridge_config_psk_equal(&cfg, argv[3])) {
+            ctl_reply("error: current psk required (set psk <new|off> <current>)");
+        } else {
+            esp_err_t err = bridge_config_set(&cfg, "psk", argv[2]);
+            if (err == ESP_OK) {
+                err = tcp_bridge_apply_config(&cfg);
+            }
+            ctl_reply(err == ESP_OK ? "ok" :
+                      err == ESP_ERR_INVALID_ARG ? "error: invalid value" : "error: save failed");
+        }
+    } else if (strcmp(argv[0], "set") == 0 && argc == 3) {
+        esp_err_t err = bridge_config_set(&cfg, argv[1], argv[2]);
+        if (err == ESP_OK) {
+            err = tcp_bridge_apply_config(&cfg);
+        }
+        ctl_reply(err == ESP_OK ? "ok" :
+                  err == ESP_ERR_NOT_FOUND ? "error: unknown key" :
+                  err == ESP_ERR_INVALID_ARG ? "error: invalid value" : "error: save failed");
+    } else {
+        ctl_reply("commands: get | set <port|baud|chunk|cache|filter|patterns|context> <value> | "
+                  "set psk <new|off> <current>");
+    }
+}
+
+static void ctl_close(void) {
+    close(s_ctl_sock);
+    s_ctl_sock = -1;
+    s_ctl_len = 0;
+}
+
+static void ctl_accept(void) {
+    int sock = accept(s_ctl_listen, NULL, NULL);
+    if (sock < 0) return;
+    if (s_ctl_sock >= 0) {
+        ctl_close();
+    }
+    fcntl(sock, F_SETFL, O_NONBLOCK);
+    s_ctl_sock = sock;
+    ESP_LOGI(TAG, "Control connection opened");
+}
+
+// 按行读取命令，超长的行直接丢弃
+static void ctl_read(void) {
+    char buf[32];
+    int len = recv(s_ctl_sock, buf, sizeof(buf), 0);
+    if (len <= 0) {
+        if (len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+        ctl_close();
+        return;
+    }
+    // 应答失败时连接已关闭，剩余的命令不再执行
+    for (int i = 0; i < len && s_ctl_sock >= 0; i++) {
+        if (buf[i] == '\n' || buf[i] == '\r') {
+            if (s_ctl_len > 0 && s_ctl_len < sizeof(s_ctl_line)) {
+                s_ctl_line[s_ctl_len] = '\0';
+                ctl_command(s_ctl_line);
+            }
+            s_ctl_len = 0;
+        } else if (s_ctl_len < sizeof(s_ctl_line)) {
+            s_ctl_line[s_ctl_len++] = buf[i];
+        }
+    }
+}
+
+bool bridge_ctl_init(uint16_t port) {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+
+    int sock = socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
+    if (sock < 0) {
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(sock, 1) != 0) {
+        close(sock);
+        return false;
+    }
+    s_ctl_listen = sock;
+    return true;
+}
+
+int bridge_ctl_fdset(fd_set *rfds, int maxfd) {
+    if (s_ctl_listen >= 0) {
+        FD_SET(s_ctl_listen, rfds);
+        if (s_ctl_listen > maxfd) maxfd = s_ctl_listen;
+    }
+    if (s_ctl_sock >= 0) {
+        FD_SET(s_ctl_sock, rfds);
+        if (s_ctl_sock > maxfd) maxfd = s_ctl_sock;
+    }
+    return maxfd;
+}
+
+void bridge_ctl_service(const fd_set *rfds) {
+    if (s_ctl_sock >= 0 && FD_ISSET(s_ctl_sock, rfds)) {
+        ctl_read();
+    }
+    if (s_ctl_listen >= 0 && FD_ISSET(s_ctl_listen, rfds)) {
+        ctl_accept();
+    }
+}
@@ -0,0 +1,84 @@
+#include "bridge_framer.h"
+#include "lz_codec.h"
+#include <stdlib.h>
+#include <string.h>
+#include "esp_timer.h"
+
+// 压缩记录缓冲区: 帧头 + 2 字节原始长度 + 压缩数据
+#define LZ_RECORD_SIZE(n) (BRIDGE_FRAME_HDR_LEN + 2 + LZ_COMPRESS_BOUND(n))
+
+static size_t s_lz_record_size = 0;
+static uint8_t *s_lz_in;      // 压缩输入 (从环形缓冲区拷出的连续数据)
+static uint16_t *s_lz_hash;   // 压缩哈希表
+static uint8_t *s_lz_out;     // 每个会话槽位一个记录缓冲区，记录可能分多次发出
+
+bool bridge_framer_lz_init(size_t chunk_max, int slots) {
+    s_lz_record_size = LZ_RECORD_SIZE(chunk_max);
+    s_lz_in = malloc(chunk_max);
+    s_lz_hash = malloc(LZ_HASH_SIZE * sizeof(uint16_t));
+    s_lz_out = malloc(slots * s_lz_record_size);
+    if (!s_lz_in || !s_lz_hash || !s_lz_out) {
+        free(s_lz_in);
+        free(s_lz_hash);
+        free(s_lz_out);
+        s_lz_in = NULL;
+        s_lz_hash = NULL;
+        s_lz_out = NULL;
+        return false;
+    }
+    return true;
+}
+
+void bridge_framer_init(bridge_framer_t *f, int slot) {
+    f->lz_rec = s_lz_out ? s_lz_out + slot * s_lz_record_size : NULL;
+}
+
+void bridge_framer_queue(bridge_framer_t *f, const uint8_t *rec, size_t len) {
+    f->pend = rec;
+    f->pend_len = (uint16_t)len;
+    f->pend_sent = 0;
+}
+
+size_t bridge_framer_gap_record(bridge_framer_t *f, uint8_t *rec, uint32_t tail, uint32_t lost) {
+    uint32_t gap = lost - f->lost_gapped;
+    if (gap == 0) return 0;
+
+    bridge_frame_header(rec, BRIDGE_FRAME_GAP, 0, 4, tail - gap, esp_timer_get_time());
+    bridge_frame_put_u32(rec + BRIDGE_FRAME_HDR_LEN, gap);
+    f->lost_gapped = lost;
+    return BRIDGE_FRAME_HDR_LEN + 4;
+}
+
+bool bridge_framer_gap(bridge_framer_t *f, uint32_t tail, uint32_t lost) {
+    size_t len = bridge_framer_gap_record(f, f->hdr, tail, lost);
+    if (len == 0) return false;
+    bridge_framer_queue(f, f->hdr, len);
+    return true;
+}
+
+void bridge_framer_data(bridge_framer_t *f, uint8_t flags, uint16_t len, uint32_t offset, int64_t ts) {
+    bridge_frame_header(f->hdr, BRIDGE_FRAME_DATA, flags, len, offset, ts);
+    bridge_framer_queue(f, f->hdr, BRIDGE_FRAME_HDR_LEN);
+    f->frame_remain = len;
+}
+
+uint8_t *bridge_framer_lz_input(void) {
+    return s_lz_in;
+}
+
+void bridge_framer_lz(bridge_framer_t *f, size_t len, uint8_t flags, uint32_t offset, int64_t ts) {
+    uint8_t *rec = f->lz_rec;
+    uint8_t *payload = rec + BRIDGE_FRAME_HDR_LEN;
+    size_t clen = lz_compress(s_lz_in, len, payload + 2, s_lz_record_size - BRIDGE_FRAME_HDR_LEN - 2,
+                              s_lz_hash);
+
+    if (clen > 0 && clen + 2 < len) {
+        bridge_frame_put_u16(payload, (uint16_t)len);
+        bridge_frame_header(rec, BRIDGE_FRAME_DATA_LZ, flags, (uint16_t)(clen + 2), offset, ts);
+        bridge_framer_queue(f, rec, BRIDGE_FRAME_HDR_LEN + clen + 2);
+    } else {
+        memcpy(payload, s_lz_in, len);
+        bridge_frame_header(rec, BRIDGE_FRAME_DATA, flags, (uint16_t)len, offset, ts);
+        bridge_framer_queue(f, rec, BRIDGE_FRAME_HDR_LEN + len);
+    }
+}
@@ -0,0 +1,42 @@
+#include "bridge_lat.h"
+#include <stdio.h>
+#include "esp_log.h"
+
+static const char *TAG = "Bridge_Lat";
+
+static uint32_t s_hist[BRIDGE_LAT_HIST_BUCKETS];
+
+void bridge_lat_record(int64_t us) {
+    int bucket = 0;
+    while (us > 1 && bucket < BRIDGE_LAT_HIST_BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+    s_hist[bucket]++;
+}
+
+uint32_t bridge_lat_percentile(uint32_t permille) {
+    uint32_t samples = 0;
+    for (int i = 0; i < BRIDGE_LAT_HIST_BUCKETS; i++) {
+        samples += s_hist[i];
+    }
+    return bridge_stats_percentile(s_hist, samples, permille);
+}
+
+void bridge_lat_copy(uint32_t *hist) {
+    for (int i = 0; i < BRIDGE_LAT_HIST_BUCKETS; i++) {
+        hist[i] = s_hist[i];
+    }
+}
+
+void bridge_lat_dump(void) {
+    char line[BRIDGE_LAT_HIST_BUCKETS * 16];
+    int pos = 0;
+    for (int i = 0; i < BRIDGE_LAT_HIST_BUCKETS; i++) {
+        if (s_hist[i] == 0) continue;
+        pos += snprintf(line + pos, sizeof(line) - pos, " <%luus:%u",
+                        1UL << (i + 1), (unsigned)s_hist[i]);
+        if (pos >= (int)sizeof(line)) break;
+    }
+    ESP_LOGI(TAG, "UART->TCP latency histogram:%s", pos > 0 ? line : " (empty)");
+}
@@ -0,0 +1,165 @@
+#include "bridge_rfc2217.h"
+#include <string.h>
+#include "driver/gpio.h"
+#include "bridge_config.h"
+
+static const bridge_rfc2217_ops_t *s_ops;
+static uart_config_t *s_line;
+static int s_dtr_gpio;
+static int s_rts_gpio;
+static uint8_t s_flow_control;
+static uint8_t s_modem_ctrl = 0;  // bit0: DTR, bit1: RTS (1 = 有效)
+
+#define MODEM_DTR 0x01
+#define MODEM_RTS 0x02
+
+static void modem_ctrl_set(uint8_t bit, bool on) {
+    if (on) {
+        s_modem_ctrl |= bit;
+    } else {
+        s_modem_ctrl &= ~bit;
+    }
+    gpio_set_level(bit == MODEM_DTR ? s_dtr_gpio : s_rts_gpio, on ? 0 : 1);
+}
+
+void bridge_rfc2217_init(const bridge_rfc2217_ops_t *ops, uart_config_t *line,
+                         int dtr_gpio, int rts_gpio, uint8_t flow_control) {
+    s_ops = ops;
+    s_line = line;
+    s_dtr_gpio = dtr_gpio;
+    s_rts_gpio = rts_gpio;
+    s_flow_control = flow_control;
+
+    gpio_config_t io_conf = {};
+    io_conf.pin_bit_mask = (1ULL << dtr_gpio) | (1ULL << rts_gpio);
+    io_conf.mode = GPIO_MODE_OUTPUT;
+    io_conf.pull_up_en = GPIO_PULLUP_DISABLE;
+    io_conf.pull_down_en = GPIO_PULLDOWN_DISABLE;
+    io_conf.intr_type = GPIO_INTR_DISABLE;
+    gpio_config(&io_conf);
+
+    // 上电默认无效 (高电平)，避免复位目标设备
+    modem_ctrl_set(MODEM_DTR, false);
+    modem_ctrl_set(MODEM_RTS, false);
+}
+
+// 修改一项参数: 排队成功才更新当前值
+static void line_apply(const uart_config_t *next) {
+    if (s_ops->reconfigure(next)) *s_line = *next;
+}
+
+static uint32_t line_command(void *ctx, uint8_t cmd, uint32_t value) {
+    // 参数 0 与 SET-CONTROL 的查询子命令只读，不参与下行控制权争夺
+    bool is_set = value != 0 && cmd != RFC2217_SET_LINESTATE_MASK &&
+                  cmd != RFC2217_SET_MODEMSTATE_MASK;
+    if (cmd == RFC2217_SET_CONTROL && (value == 4 || value == 7 || value == 10)) {
+        is_set = false;
+    }
+    bool may_set = is_set && s_ops->acquire(ctx);
+
+    switch (cmd) {
+        case RFC2217_SET_BAUDRATE:
+            // 修改排在已入环的下行数据之后，由发送任务执行；应答新值
+            // 范围同 NVS / 网页参数，超出时串口不变，应答当前值
+            if (may_set && value >= BRIDGE_CFG_BAUD_MIN && value <= BRIDGE_CFG_BAUD_MAX) {
+                uart_config_t next = *s_line;
+                next.baud_rate = value;
+                line_apply(&next);
+            }
+            return s_line->baud_rate;
+
+        case RFC2217_SET_DATASIZE:
+            if (may_set && value >= 5 && value <= 8) {
+                uart_config_t next = *s_line;
+                next.data_bits = UART_DATA_5_BITS + (value - 5);
+                line_apply(&next);
+            }
+            return s_line->data_bits - UART_DATA_5_BITS + 5;
+
+        case RFC2217_SET_PARITY: {
+            // 1: NONE, 2: ODD, 3: EVEN (MARK / SPACE 硬件不支持)
+            static const uart_parity_t parity_map[] = {
+                UART_PARITY_DISABLE, UART_PARITY_ODD, UART_PARITY_EVEN
+            };
+            if (may_set && value >= 1 && value <= 3) {
+                uart_config_t next = *s_line;
+                next.parity = parity_map[value - 1];
+                line_apply(&next);
+            }
+            for (uint32_t i = 0; i < 3; i++) {
+                if (parity_map[i] == s_line->parity) return i + 1;
+            }
+            return 1;
+        }
+
+        case RFC2217_SET_STOPSIZE: {
+            // 1: 1 位, 2: 2 位, 3: 1.5 位
+            static const uart_stop_bits_t stop_map[] = {
+                UART_STOP_BITS_1, UART_STOP_BITS_2, UART_STOP_BITS_1_5
+            };
+            if (may_set && value >= 1 && value <= 3) {
+                uart_config_t next = *s_line;
+                next.stop_bits = stop_map[value - 1];
+                line_apply(&next);
+            }
+            for (uint32_t i = 0; i < 3; i++) {
+                if (stop_map[i] == s_line->stop_bits) return i + 1;
+            }
+            return 1;
+        }
+
+        case RFC2217_SET_CONTROL:
+            switch (value) {
+                case 0: case 1: case 2: case 3:
+                    return s_flow_control;
+                case 4: case 5: case 6:
+                    // 不支持 BREAK
+                    return 6;
+                case 8: case 9:
+                    if (may_set) modem_ctrl_set(MODEM_DTR, value == 8);
+                    // fall through
+                case 7:
+                    return (s_modem_ctrl & MODEM_DTR) ? 8 : 9;
+                case 11: case 12:
+                    if (may_set) modem_ctrl_set(MODEM_RTS, value == 11);
+                    // fall through
+                case 10:
+                    return (s_modem_ctrl & MODEM_RTS) ? 11 : 12;
+                default:
+                    return value;
+            }
+
+        case RFC2217_FLOWCONTROL_SUSPEND:
+            s_ops->suspend(ctx, true);
+            return 0;
+
+        case RFC2217_FLOWCONTROL_RESUME:
+            s_ops->suspend(ctx, false);
+            return 0;
+
+        case RFC2217_PURGE_DATA:
+            // 1: 串口接收方向, 2: 发送方向, 3: 两者
+            if (may_set && (value == 1 || value == 3)) {
+                s_ops->purge_rx(ctx);
+            }
+            if (may_set && (value == 2 || value == 3)) {
+                s_ops->purge_tx();
+            }
+            return value;
+
+        default:
+            // 线路 / 调制解调器状态掩码: 不主动上报，原样确认
+            return value;
+    }
+}
+
+void bridge_rfc2217_start(rfc2217_t *tn, void *client) {
+    static const uint8_t greeting[] = {
+        TELNET_IAC, TELNET_WILL, TELNET_OPT_BINARY,
+        TELNET_IAC, TELNET_WILL, TELNET_OPT_SGA,
+    };
+    rfc2217_init(tn, line_command, client);
+    memcpy(tn->reply, greeting, sizeof(greeting));
+    tn->reply_len = sizeof(greeting);
+    tn->we_opts = 0x03;
+}
@@ -0,0 +1,256 @@
+#include "bridge_spool.h"
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_partition.h"
+#include "esp_log.h"
+
+static const char *TAG = "Spool";
+
+#define SPOOL_PARTITION_SUBTYPE 0x40
+#define SPOOL_PARTITION_LABEL "spool"
+
+#define SPOOL_SECTOR_SIZE 4096
+#define SPOOL_MAGIC 0x314C5053  // "SPL1"
+#define SPOOL_MIN_RECORD 64     // 扇区剩余空间不足以容纳该长度的记录时直接换扇区
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;       // 轮转序号，挂载时序号最大的扇区即当前写入扇区
+    uint32_t pos;       // 扇区内首字节的位置
+    uint32_t seq_inv;   // ~seq，用于识别擦写中断的扇区头
+} sector_hdr_t;
+
+typedef struct {
+    uint16_t len;
+    uint16_t len_inv;   // ~len，记录头写入不完整时校验失败
+    uint32_t pos;
+} record_hdr_t;
+
+static const esp_partition_t *s_part;
+static SemaphoreHandle_t s_lock;
+static uint32_t s_sector_num;
+static uint32_t *s_sector_pos;   // 各扇区首字节位置 (缓存扇区头，读取时免去逐个读 Flash)
+static uint8_t *s_sector_valid;  // 扇区是否含有效数据 (位图)
+
+static uint32_t s_cur = 0;       // 当前写入扇区
+static uint32_t s_cur_seq = 0;
+static uint32_t s_write_off = SPOOL_SECTOR_SIZE;  // 当前扇区内的写偏移，满值表示需要换扇区
+static uint32_t s_end = 0;       // 最新数据之后的位置
+
+static inline bool sector_valid(uint32_t s) {
+    return s_sector_valid[s >> 3] & (1 << (s & 7));
+}
+
+static inline void sector_set_valid(uint32_t s, bool valid) {
+    if (valid) {
+        s_sector_valid[s >> 3] |= (1 << (s & 7));
+    } else {
+        s_sector_valid[s >> 3] &= ~(1 << (s & 7));
+    }
+}
+
+static inline uint32_t align4(uint32_t v) {
+    return (v + 3) & ~3u;
+}
+
+// 读取扇区 s 中偏移 off 处的记录头，返回 false 表示扇区内已无有效记录
+static bool record_at(uint32_t s, uint32_t off, record_hdr_t *rec) {
+    if (off + sizeof(*rec) > SPOOL_SECTOR_SIZE) return false;
+    if (esp_partition_read(s_part, s * SPOOL_SECTOR_SIZE + off, rec, sizeof(*rec)) != ESP_OK) {
+        return false;
+    }
+    return rec->len != 0 && rec->len != 0xFFFF && (rec->len ^ rec->len_inv) == 0xFFFF &&
+           off + sizeof(*rec) + rec->len <= SPOOL_SECTOR_SIZE;
+}
+
+// 擦除下一个扇区并写入扇区头，调用前需持有锁
+static bool sector_advance(uint32_t pos) {
+    uint32_t s = (s_cur + 1) % s_sector_num;
+
+    // 先从缓存中摘除，读者不会再访问正在擦除的扇区
+    sector_set_valid(s, false);
+    if (esp_partition_erase_range(s_part, s * SPOOL_SECTOR_SIZE, SPOOL_SECTOR_SIZE) != ESP_OK) {
+        ESP_LOGE(TAG, "Erase sector %u failed", (unsigned)s);
+        return false;
+    }
+
+    sector_hdr_t hdr = {
+        .magic = SPOOL_MAGIC,
+        .seq = s_cur_seq + 1,
+        .pos = pos,
+        .seq_inv = ~(s_cur_seq + 1),
+    };
+    if (esp_partition_write(s_part, s * SPOOL_SECTOR_SIZE, &hdr, sizeof(hdr)) != ESP_OK) {
+        ESP_LOGE(TAG, "Write sector %u header failed", (unsigned)s);
+        return false;
+    }
+
+    s_cur = s;
+    s_cur_seq = hdr.seq;
+    s_write_off = sizeof(hdr);
+    s_sector_pos[s] = pos;
+    sector_set_valid(s, true);
+    return true;
+}
+
+esp_err_t bridge_spool_init(void) {
+    s_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, SPOOL_PARTITION_SUBTYPE,
+                                      SPOOL_PARTITION_LABEL);
+    if (!s_part) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    s_sector_num = s_part->size / SPOOL_SECTOR_SIZE;
+    s_sector_pos = calloc(s_sector_num, sizeof(uint32_t));
+    s_sector_valid = calloc((s_sector_num + 7) / 8, 1);
+    s_lock = xSemaphoreCreateMutex();
+    if (s_sector_num < 2 || !s_sector_pos || !s_sector_valid || !s_lock) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // 1. 扫描所有扇区头，序号最大者为上次写入的扇区
+    bool found = false;
+    for (uint32_t s = 0; s < s_sector_num; s++) {
+        sector_hdr_t hdr;
+        if (esp_partition_read(s_part, s * SPOOL_SECTOR_SIZE, &hdr, sizeof(hdr)) != ESP_OK ||
+            hdr.magic != SPOOL_MAGIC || hdr.seq_inv != ~hdr.seq) {
+            continue;
+        }
+        s_sector_pos[s] = hdr.pos;
+        sector_set_valid(s, true);
+        if (!found || (int32_t)(hdr.seq - s_cur_seq) > 0) {
+            s_cur = s;
+            s_cur_seq = hdr.seq;
+            found = true;
+        }
+    }
+
+    if (!found) {
+        // 空分区: 第一次写入时从扇区 0 开始
+        s_cur = s_sector_num - 1;
+        ESP_LOGI(TAG, "Empty spool, %u sectors", (unsigned)s_sector_num);
+        return ESP_OK;
+    }
+
+    // 2. 遍历当前扇区的记录，恢复写偏移与末尾位置
+    uint32_t off = sizeof(sector_hdr_t);
+    record_hdr_t rec;
+    s_end = s_sector_pos[s_cur];
+    while (record_at(s_cur, off, &rec)) {
+        s_end = rec.pos + rec.len;
+        off += sizeof(rec) + align4(rec.len);
+    }
+
+    // 记录头之后不是擦除状态，说明上次掉电时写了一半，放弃本扇区剩余空间
+    uint32_t blank = 0;
+    if (off + sizeof(blank) <= SPOOL_SECTOR_SIZE) {
+        esp_partition_read(s_part, s_cur * SPOOL_SECTOR_SIZE + off, &blank, sizeof(blank));
+    }
+    s_write_off = blank == 0xFFFFFFFF ? off : SPOOL_SECTOR_SIZE;
+
+    ESP_LOGI(TAG, "Spool mounted: %u sectors, current %u, end position %u",
+             (unsigned)s_sector_num, (unsigned)s_cur, (unsigned)s_end);
+    return ESP_OK;
+}
+
+uint32_t bridge_spool_end(void) {
+    return s_end;
+}
+
+void bridge_spool_append(uint32_t pos, const uint8_t *data, size_t len) {
+    if (!s_part) return;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    while (len > 0) {
+        if (s_write_off + sizeof(record_hdr_t) + SPOOL_MIN_RECORD > SPOOL_SECTOR_SIZE &&
+            !sector_advance(pos)) {
+            break;
+        }
+
+        uint32_t room = SPOOL_SECTOR_SIZE - s_write_off - sizeof(record_hdr_t);
+        uint32_t n = len < room ? len : room;
+        uint32_t addr = s_cur * SPOOL_SECTOR_SIZE + s_write_off;
+
+        // 数据按 4 字节对齐写入，不足部分补 0xFF
+        uint32_t body = n & ~3u;
+        bool ok = body == 0 ||
+                  esp_partition_write(s_part, addr + sizeof(record_hdr_t), data, body) == ESP_OK;
+        if (ok && body < n) {
+            uint8_t tail[4] = { 0xFF, 0xFF, 0xFF, 0xFF };
+            memcpy(tail, data + body, n - body);
+            ok = esp_partition_write(s_part, addr + sizeof(record_hdr_t) + body, tail,
+                                     sizeof(tail)) == ESP_OK;
+        }
+
+        // 数据落盘后再写记录头，记录才算生效
+        record_hdr_t rec = { .len = n, .len_inv = ~n, .pos = pos };
+        if (!ok || esp_partition_write(s_part, addr, &rec, sizeof(rec)) != ESP_OK) {
+            ESP_LOGE(TAG, "Write failed at 0x%x, skipping to next sector", (unsigned)addr);
+            s_write_off = SPOOL_SECTOR_SIZE;
+            break;
+        }
+
+        s_write_off += sizeof(rec) + align4(n);
+        s_end = pos + n;
+        pos += n;
+        data += n;
+        len -= n;
+    }
+    xSemaphoreGive(s_lock);
+}
+
+size_t bridge_spool_read(uint32_t *pos, uint8_t *buf, size_t max_len) {
+    if (!s_part || max_len == 0) return 0;
+
+    size_t copied = 0;
+    bool done = false;
+    uint32_t target = *pos;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+
+    // 按写入顺序 (从最旧的扇区开始) 找到最后一个首字节不晚于 target 的扇区
+    uint32_t first = (s_cur + 1) % s_sector_num;
+    uint32_t start = s_sector_num;
+    for (uint32_t i = 0; i < s_sector_num; i++) {
+        uint32_t s = (first + i) % s_sector_num;
+        if (!sector_valid(s)) continue;
+        if (start == s_sector_num || (int32_t)(s_sector_pos[s] - target) <= 0) {
+            start = s;
+        }
+        if ((int32_t)(s_sector_pos[s] - target) > 0) break;
+    }
+
+    // 从该扇区起逐条查找包含 target 的记录；target 落在空洞中则前移到下一条记录
+    for (uint32_t s = start; s < s_sector_num && !done; ) {
+        if (sector_valid(s)) {
+            uint32_t off = sizeof(sector_hdr_t);
+            record_hdr_t rec;
+            while (record_at(s, off, &rec)) {
+                if ((int32_t)(rec.pos + rec.len - target) > 0) {
+                    if ((int32_t)(rec.pos - target) > 0) {
+                        target = rec.pos;
+                    }
+                    uint32_t skip = target - rec.pos;
+                    uint32_t n = rec.len - skip;
+                    if (n > max_len) n = max_len;
+                    if (esp_partition_read(s_part, s * SPOOL_SECTOR_SIZE + off + sizeof(rec) + skip,
+                                           buf, n) == ESP_OK) {
+                        copied = n;
+                    }
+                    done = true;
+                    break;
+                }
+                off += sizeof(rec) + align4(rec.len);
+            }
+        }
+        if (s == s_cur) break;
+        s = (s + 1) % s_sector_num;
+    }
+
+    xSemaphoreGive(s_lock);
+
+    *pos = target;
+    return copied;
+}
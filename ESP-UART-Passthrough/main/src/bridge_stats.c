@@ -0,0 +1,89 @@
+#include "bridge_stats.h"
+#include <stdio.h>
+#include <stddef.h>
+
+// 字段表: 二进制快照与 JSON 共用，顺序即二进制中的顺序，只能在末尾追加
+typedef struct {
+    const char *name;
+    uint16_t offset;
+} stats_field_t;
+
+#define STATS_FIELD(f) { #f, offsetof(bridge_stats_t, f) }
+
+static const stats_field_t s_fields[] = {
+    STATS_FIELD(uptime_s),
+    STATS_FIELD(uart_rx_bytes),
+    STATS_FIELD(uart_fifo_ovf),
+    STATS_FIELD(uart_buffer_full),
+    STATS_FIELD(uart_frame_err),
+    STATS_FIELD(uart_parity_err),
+    STATS_FIELD(rb_high_water),
+    STATS_FIELD(rb_overwritten),
+    STATS_FIELD(tx_bytes),
+    STATS_FIELD(tx_segments),
+    STATS_FIELD(tx_eagain),
+    STATS_FIELD(tx_partial),
+    STATS_FIELD(client_dropped),
+    STATS_FIELD(lat_p50_us),
+    STATS_FIELD(lat_p99_us),
+    STATS_FIELD(sessions_total),
+    STATS_FIELD(sessions_active),
+    STATS_FIELD(session_s_total),
+    STATS_FIELD(session_s_max),
+    STATS_FIELD(filter_out),
+    STATS_FIELD(filter_matches),
+    STATS_FIELD(dl_bytes),
+    STATS_FIELD(dl_stalls),
+};
+#define STATS_FIELD_NUM ((int)(sizeof(s_fields) / sizeof(s_fields[0])))
+
+_Static_assert(STATS_FIELD_NUM * sizeof(uint32_t) == sizeof(bridge_stats_t),
+               "every bridge_stats_t member must be listed in s_fields");
+
+static inline uint32_t stats_get(const bridge_stats_t *st, int i) {
+    return *(const uint32_t *)((const uint8_t *)st + s_fields[i].offset);
+}
+
+size_t bridge_stats_encode(const bridge_stats_t *st, uint8_t *buf, size_t len) {
+    size_t total = BRIDGE_STATS_HDR_LEN + STATS_FIELD_NUM * 4;
+    if (len < total) return 0;
+
+    buf[0] = (uint8_t)(BRIDGE_STATS_MAGIC >> 8);
+    buf[1] = (uint8_t)BRIDGE_STATS_MAGIC;
+    buf[2] = BRIDGE_STATS_VERSION;
+    buf[3] = (uint8_t)STATS_FIELD_NUM;
+
+    uint8_t *p = buf + BRIDGE_STATS_HDR_LEN;
+    for (int i = 0; i < STATS_FIELD_NUM; i++) {
+        uint32_t v = stats_get(st, i);
+        p[0] = (uint8_t)(v >> 24);
+        p[1] = (uint8_t)(v >> 16);
+        p[2] = (uint8_t)(v >> 8);
+        p[3] = (uint8_t)v;
+        p += 4;
+    }
+    return total;
+}
+
+int bridge_stats_format_json(const bridge_stats_t *st, char *buf, size_t len) {
+    int pos = snprintf(buf, len, "{");
+    for (int i = 0; i < STATS_FIELD_NUM && pos < (int)len; i++) {
+        pos += snprintf(buf + pos, len - pos, "%s\"%s\":%u", i > 0 ? "," : "",
+                        s_fields[i].name, (unsigned)stats_get(st, i));
+    }
+    if (pos < (int)len) {
+        pos += snprintf(buf + pos, len - pos, "}");
+    }
+    return pos;
+}
+
+uint32_t bridge_stats_percentile(const uint32_t *hist, uint32_t total, uint32_t permille) {
+    if (total == 0) return 0;
+    uint32_t rank = (uint32_t)(((uint64_t)total * permille + 999) / 1000);
+    uint32_t acc = 0;
+    for (int i = 0; i < BRIDGE_LAT_HIST_BUCKETS; i++) {
+        acc += hist[i];
+        if (acc >= rank) return 1UL << (i + 1);
+    }
+    return 1UL << BRIDGE_LAT_HIST_BUCKETS;
+}
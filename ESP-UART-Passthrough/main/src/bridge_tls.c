@@ -0,0 +1,150 @@
+#include "bridge_tls.h"
+#include <string.h>
+#include "mbedtls/ssl_ticket.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/platform_util.h"
+#include "esp_log.h"
+#include "utils.h"
+
+static const char *TAG = "Bridge_TLS";
+
+#define TLS_PSK_MAX 32  // 字节
+
+static mbedtls_entropy_context s_entropy;
+static mbedtls_ctr_drbg_context s_drbg;
+static mbedtls_ssl_ticket_context s_ticket;
+static mbedtls_ssl_config s_conf;
+static mbedtls_ssl_context s_ssl;   // 唯一的会话上下文，收发缓冲区随之常驻
+
+static bool s_inited = false;
+static bool s_has_psk = false;
+static bool s_busy = false;
+static bool s_resumed = false;
+
+static const int s_ciphersuites[] = {
+    MBEDTLS_TLS_PSK_WITH_AES_128_GCM_SHA256,
+    MBEDTLS_TLS_PSK_WITH_AES_128_CCM_8,
+    0
+};
+
+// 包装票据解析，记录本次握手是否走了会话恢复
+static int tls_ticket_parse(void *p_ticket, mbedtls_ssl_session *session,
+                            unsigned char *buf, size_t len) {
+    int ret = mbedtls_ssl_ticket_parse(p_ticket, session, buf, len);
+    s_resumed = ret == 0;
+    return ret;
+}
+
+static bool tls_ticket_setup(void) {
+    int ret = mbedtls_ssl_ticket_setup(&s_ticket, mbedtls_ctr_drbg_random, &s_drbg,
+                                       MBEDTLS_CIPHER_AES_128_GCM, BRIDGE_TLS_TICKET_LIFETIME_S);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "Ticket key setup failed (-0x%04x)", -ret);
+        return false;
+    }
+    return true;
+}
+
+bool bridge_tls_init(void) {
+    static const char pers[] = "bridge_tls";
+    int ret;
+
+    mbedtls_entropy_init(&s_entropy);
+    mbedtls_ctr_drbg_init(&s_drbg);
+    mbedtls_ssl_ticket_init(&s_ticket);
+    mbedtls_ssl_config_init(&s_conf);
+    mbedtls_ssl_init(&s_ssl);
+
+    ret = mbedtls_ctr_drbg_seed(&s_drbg, mbedtls_entropy_func, &s_entropy,
+                                (const unsigned char *)pers, sizeof(pers) - 1);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "DRBG seed failed (-0x%04x)", -ret);
+        return false;
+    }
+
+    ret = mbedtls_ssl_config_defaults(&s_conf, MBEDTLS_SSL_IS_SERVER,
+                                      MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "Config defaults failed (-0x%04x)", -ret);
+        return false;
+    }
+    mbedtls_ssl_conf_rng(&s_conf, mbedtls_ctr_drbg_random, &s_drbg);
+    mbedtls_ssl_conf_ciphersuites(&s_conf, s_ciphersuites);
+    mbedtls_ssl_conf_min_version(&s_conf, MBEDTLS_SSL_MAJOR_VERSION_3, MBEDTLS_SSL_MINOR_VERSION_3);
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+    // 服务端: 限制发出的记录长度 (客户端请求更小的值时取更小者)
+    mbedtls_ssl_conf_max_frag_len(&s_conf, MBEDTLS_SSL_MAX_FRAG_LEN_1024);
+#endif
+
+    if (!tls_ticket_setup()) {
+        return false;
+    }
+    mbedtls_ssl_conf_session_tickets_cb(&s_conf, mbedtls_ssl_ticket_write, tls_ticket_parse, &s_ticket);
+
+    // 收发缓冲区在这里分配，之后所有连接复用
+    ret = mbedtls_ssl_setup(&s_ssl, &s_conf);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "Session setup failed (-0x%04x)", -ret);
+        return false;
+    }
+    s_inited = true;
+    return true;
+}
+
+bool bridge_tls_set_psk(const char *psk_hex) {
+    uint8_t psk[TLS_PSK_MAX];
+    int len = hex_decode(psk, psk_hex, sizeof(psk));
+
+    s_has_psk = false;
+    if (!s_inited || len <= 0) {
+        return false;
+    }
+
+    int ret = mbedtls_ssl_conf_psk(&s_conf, psk, len, (const unsigned char *)BRIDGE_TLS_PSK_IDENTITY,
+                                   strlen(BRIDGE_TLS_PSK_IDENTITY));
+    mbedtls_platform_zeroize(psk, sizeof(psk));
+    if (ret != 0) {
+        ESP_LOGE(TAG, "Unable to set PSK (-0x%04x)", -ret);
+        return false;
+    }
+
+    // 换一套票据密钥，旧密钥签发的票据无法再恢复会话
+    mbedtls_ssl_ticket_free(&s_ticket);
+    mbedtls_ssl_ticket_init(&s_ticket);
+    if (!tls_ticket_setup()) {
+        return false;
+    }
+    s_has_psk = true;
+    return true;
+}
+
+bool bridge_tls_available(void) {
+    return s_has_psk && !s_busy;
+}
+
+mbedtls_ssl_context *bridge_tls_acquire(void *bio, mbedtls_ssl_send_t *f_send, mbedtls_ssl_recv_t *f_recv) {
+    if (!bridge_tls_available()) {
+        return NULL;
+    }
+    int ret = mbedtls_ssl_session_reset(&s_ssl);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "Session reset failed (-0x%04x)", -ret);
+        return NULL;
+    }
+    mbedtls_ssl_set_bio(&s_ssl, bio, f_send, f_recv, NULL);
+    s_busy = true;
+    s_resumed = false;
+    return &s_ssl;
+}
+
+void bridge_tls_release(bool notify) {
+    if (notify) {
+        mbedtls_ssl_close_notify(&s_ssl);
+    }
+    s_busy = false;
+}
+
+bool bridge_tls_resumed(void) {
+    return s_resumed;
+}
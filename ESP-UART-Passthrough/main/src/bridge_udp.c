@@ -0,0 +1,85 @@
+#include "bridge_udp.h"
+#include "bridge_frame.h"
+#include <stdlib.h>
+#include <string.h>
+#include "lwip/sockets.h"
+#include "esp_log.h"
+
+static const char *TAG = "Bridge_UDP";
+
+static int s_sock = -1;
+static struct sockaddr_in s_dest;
+static uint8_t *s_buf;             // 数据报缓冲区: 序号 + 一条记录
+static size_t s_pend_len = 0;      // 已组好但尚未发出的数据报长度
+static uint32_t s_seq = 0;
+static int s_last_errno = 0;       // 上次报告的发送错误，避免重复刷屏
+
+bool bridge_udp_init(const char *addr, uint16_t port, uint8_t multicast_ttl, size_t record_max) {
+    memset(&s_dest, 0, sizeof(s_dest));
+    s_dest.sin_family = AF_INET;
+    s_dest.sin_port = htons(port);
+    if (inet_aton(addr, &s_dest.sin_addr) != 1) {
+        ESP_LOGE(TAG, "Invalid UDP uplink address '%s'", addr);
+        return false;
+    }
+
+    s_buf = malloc(BRIDGE_UDP_SEQ_LEN + record_max);
+    if (!s_buf) {
+        return false;
+    }
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_IP);
+    if (sock < 0) {
+        free(s_buf);
+        s_buf = NULL;
+        return false;
+    }
+
+    bool multicast = IN_MULTICAST(ntohl(s_dest.sin_addr.s_addr));
+    if (multicast) {
+        uint8_t loop = 0;
+        setsockopt(sock, IPPROTO_IP, IP_MULTICAST_TTL, &multicast_ttl, sizeof(multicast_ttl));
+        setsockopt(sock, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+    }
+    fcntl(sock, F_SETFL, O_NONBLOCK);
+    s_sock = sock;
+
+    ESP_LOGI(TAG, "UDP uplink publishing to %s %s:%d", multicast ? "multicast group" : "host",
+             addr, port);
+    return true;
+}
+
+bool bridge_udp_ready(void) {
+    return s_sock >= 0;
+}
+
+uint8_t *bridge_udp_record(void) {
+    return s_buf + BRIDGE_UDP_SEQ_LEN;
+}
+
+void bridge_udp_queue(size_t record_len) {
+    s_pend_len = BRIDGE_UDP_SEQ_LEN + record_len;
+}
+
+bool bridge_udp_pending(void) {
+    return s_pend_len > 0;
+}
+
+int bridge_udp_flush(void) {
+    bridge_frame_put_u32(s_buf, s_seq);
+    int sent = sendto(s_sock, s_buf, s_pend_len, 0, (struct sockaddr *)&s_dest, sizeof(s_dest));
+    if (sent < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOMEM) {
+            return -1;
+        }
+        if (errno != s_last_errno) {
+            ESP_LOGW(TAG, "UDP uplink send failed (errno: %d), dropping datagrams", errno);
+            s_last_errno = errno;
+        }
+        sent = 0;
+    } else {
+        s_last_errno = 0;
+    }
+    s_seq++;
+    s_pend_len = 0;
+    return sent;
+}
@@ -0,0 +1,74 @@
+#include "bridge_zerocopy.h"
+#include "lwip/tcp.h"
+#include "lwip/api.h"
+#include "lwip/priv/tcpip_priv.h"
+#include "lwip/priv/sockets_priv.h"
+
+typedef struct {
+    struct tcpip_api_call_data call;  // 必须是第一个成员
+    struct netconn *conn;
+    const uint8_t *data[2];
+    size_t len[2];
+    size_t written;
+    uint32_t inflight;  // 返回时协议栈中尚未确认的字节数
+    bool abort;
+} zc_call_t;
+
+// 在 tcpip 线程中执行，可直接操作 pcb
+static err_t zc_tcpip_call(struct tcpip_api_call_data *call) {
+    zc_call_t *m = (zc_call_t *)call;
+    struct tcp_pcb *pcb = m->conn->pcb.tcp;
+    if (!pcb) return ERR_CLSD;  // 连接已被复位
+
+    if (m->abort) {
+        // 立即释放仍引用缓存的发送队列；err 回调会清空 conn->pcb，随后的 close() 按已复位处理
+        tcp_abort(pcb);
+        return ERR_OK;
+    }
+
+    err_t err = ERR_OK;
+    for (int i = 0; i < 2 && m->len[i] > 0; i++) {
+        size_t n = m->len[i];
+        if (n > tcp_sndbuf(pcb)) n = tcp_sndbuf(pcb);
+        if (n == 0) break;
+        bool more = n < m->len[i] || (i == 0 && m->len[1] > 0);
+        err = tcp_write(pcb, m->data[i], (u16_t)n, more ? TCP_WRITE_FLAG_MORE : 0);
+        if (err != ERR_OK) break;
+        m->written += n;
+        if (n < m->len[i]) break;
+    }
+    if (err == ERR_MEM) err = ERR_OK;  // 发送队列已满，等确认后继续
+    if (m->written > 0) tcp_output(pcb);
+
+    if (m->written < m->len[0] + m->len[1]) {
+        // 与 netconn 写满时的处理一致: sent 回调腾出空间后通知 select 可写
+        netconn_set_flags(m->conn, NETCONN_FLAG_CHECK_WRITESPACE);
+        API_EVENT(m->conn, NETCONN_EVT_SENDMINUS, 0);
+    }
+    m->inflight = pcb->snd_lbb - pcb->lastack;
+    return err;
+}
+
+struct netconn *bridge_zc_conn(int sock) {
+    struct lwip_sock *ls = lwip_socket_dbg_get_socket(sock);
+    return ls ? ls->conn : NULL;
+}
+
+int bridge_zc_write(struct netconn *conn, const uint8_t *const data[2], const size_t len[2],
+                    uint32_t *inflight) {
+    zc_call_t m = {
+        .conn = conn,
+        .data = { data[0], data[1] },
+        .len = { len[0], len[1] },
+    };
+    if (tcpip_api_call(zc_tcpip_call, &m.call) != ERR_OK) {
+        return -1;
+    }
+    *inflight = m.inflight;
+    return (int)m.written;
+}
+
+void bridge_zc_abort(struct netconn *conn) {
+    zc_call_t m = { .conn = conn, .abort = true };
+    tcpip_api_call(zc_tcpip_call, &m.call);
+}
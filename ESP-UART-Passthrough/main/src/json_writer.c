@@ -0,0 +1,230 @@
+#include "json_writer.h"
+#include <string.h>
+
+static const char HEX[] = "0123456789abcdef";
+
+static void jw_flush(json_writer_t *w) {
+    if (w->len > 0 && w->err == 0) {
+        w->err = w->flush(w->ctx, w->buf, w->len);
+    }
+    w->len = 0;
+}
+
+static inline void jw_putc(json_writer_t *w, char c) {
+    if (w->len == JSON_WRITER_CHUNK) {
+        jw_flush(w);
+    }
+    w->buf[w->len++] = c;
+}
+
+static void jw_put(json_writer_t *w, const char *s, size_t n) {
+    while (n > 0) {
+        if (w->len == JSON_WRITER_CHUNK) {
+            jw_flush(w);
+        }
+        size_t room = JSON_WRITER_CHUNK - w->len;
+        size_t k = n < room ? n : room;
+        memcpy(w->buf + w->len, s, k);
+        w->len += k;
+        s += k;
+        n -= k;
+    }
+}
+
+// 写一个值或键之前: 同层已有成员则补逗号 (键之后的值除外)
+static bool jw_member(json_writer_t *w) {
+    if (w->err != 0) {
+        return false;
+    }
+    if (w->after_key) {
+        w->after_key = false;
+        return true;
+    }
+    if (w->depth > 0) {
+        uint8_t bit = 1u << (w->depth - 1);
+        if (w->has_member & bit) {
+            jw_putc(w, ',');
+        }
+        w->has_member |= bit;
+    }
+    return true;
+}
+
+// UTF-8 合法序列的长度 (按 RFC 3629 排除超长编码、代理区与超出 U+10FFFF 的码点)，非法返回 0
+static size_t utf8_seq_len(const uint8_t *s) {
+    uint8_t c = s[0];
+    uint8_t lo = 0x80, hi = 0xBF;
+    size_t n;
+
+    if (c >= 0xC2 && c <= 0xDF) {
+        n = 2;
+    } else if (c >= 0xE0 && c <= 0xEF) {
+        n = 3;
+        if (c == 0xE0) lo = 0xA0;
+        if (c == 0xED) hi = 0x9F;
+    } else if (c >= 0xF0 && c <= 0xF4) {
+        n = 4;
+        if (c == 0xF0) lo = 0x90;
+        if (c == 0xF4) hi = 0x8F;
+    } else {
+        return 0;
+    }
+    // 结尾的 '\0' 不在 0x80..0xBF 内，不会越过字符串末尾
+    if (s[1] < lo || s[1] > hi) {
+        return 0;
+    }
+    for (size_t i = 2; i < n; i++) {
+        if (s[i] < 0x80 || s[i] > 0xBF) {
+            return 0;
+        }
+    }
+    return n;
+}
+
+static void jw_quoted(json_writer_t *w, const char *str) {
+    const uint8_t *s = (const uint8_t *)str;
+
+    jw_putc(w, '"');
+    while (*s) {
+        // 不需要转义的 ASCII 连续段整体复制
+        const uint8_t *run = s;
+        while (*s >= 0x20 && *s < 0x80 && *s != '"' && *s != '\\') {
+            s++;
+        }
+        jw_put(w, (const char *)run, s - run);
+
+        uint8_t c = *s;
+        if (c == 0) {
+            break;
+        }
+        if (c == '"' || c == '\\') {
+            jw_putc(w, '\\');
+            jw_putc(w, (char)c);
+            s++;
+        } else if (c < 0x20) {
+            if (c == '\n') {
+                jw_put(w, "\\n", 2);
+            } else if (c == '\r') {
+                jw_put(w, "\\r", 2);
+            } else if (c == '\t') {
+                jw_put(w, "\\t", 2);
+            } else {
+                char esc[6] = { '\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0xF] };
+                jw_put(w, esc, sizeof(esc));
+            }
+            s++;
+        } else {
+            size_t n = utf8_seq_len(s);
+            if (n > 0) {
+                jw_put(w, (const char *)s, n);
+                s += n;
+            } else {
+                jw_put(w, "\\ufffd", 6);
+                s++;
+            }
+        }
+    }
+    jw_putc(w, '"');
+}
+
+void jw_init(json_writer_t *w, json_flush_t flush, void *ctx) {
+    w->flush = flush;
+    w->ctx = ctx;
+    w->err = 0;
+    w->len = 0;
+    w->depth = 0;
+    w->has_member = 0;
+    w->after_key = false;
+}
+
+static void jw_open(json_writer_t *w, char c) {
+    if (!jw_member(w)) {
+        return;
+    }
+    if (w->depth == JSON_WRITER_DEPTH) {
+        w->err = JW_ERR_NESTING;
+        return;
+    }
+    w->depth++;
+    w->has_member &= ~(1u << (w->depth - 1));
+    jw_putc(w, c);
+}
+
+static void jw_close(json_writer_t *w, char c) {
+    if (w->err != 0) {
+        return;
+    }
+    if (w->depth == 0 || w->after_key) {
+        w->err = JW_ERR_NESTING;
+        return;
+    }
+    w->depth--;
+    jw_putc(w, c);
+}
+
+void jw_object_begin(json_writer_t *w) { jw_open(w, '{'); }
+void jw_object_end(json_writer_t *w)   { jw_close(w, '}'); }
+void jw_array_begin(json_writer_t *w)  { jw_open(w, '['); }
+void jw_array_end(json_writer_t *w)    { jw_close(w, ']'); }
+
+void jw_key(json_writer_t *w, const char *key) {
+    if (w->after_key) {
+        w->err = JW_ERR_NESTING;
+    }
+    if (!jw_member(w)) {
+        return;
+    }
+    jw_quoted(w, key);
+    jw_putc(w, ':');
+    w->after_key = true;
+}
+
+void jw_string(json_writer_t *w, const char *s) {
+    if (jw_member(w)) {
+        jw_quoted(w, s);
+    }
+}
+
+static void jw_digits(json_writer_t *w, uint32_t v, bool neg) {
+    char tmp[11];
+    int i = sizeof(tmp);
+    do {
+        tmp[--i] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v > 0);
+    if (neg) {
+        tmp[--i] = '-';
+    }
+    jw_put(w, tmp + i, sizeof(tmp) - i);
+}
+
+void jw_uint(json_writer_t *w, uint32_t v) {
+    if (jw_member(w)) {
+        jw_digits(w, v, false);
+    }
+}
+
+void jw_int(json_writer_t *w, int32_t v) {
+    if (jw_member(w)) {
+        // 取绝对值时先转为无符号，INT32_MIN 也不会溢出
+        jw_digits(w, v < 0 ? 0u - (uint32_t)v : (uint32_t)v, v < 0);
+    }
+}
+
+void jw_bool(json_writer_t *w, bool v) {
+    if (jw_member(w)) {
+        if (v) {
+            jw_put(w, "true", 4);
+        } else {
+            jw_put(w, "false", 5);
+        }
+    }
+}
+
+int jw_finish(json_writer_t *w) {
+    if (w->err == 0 && (w->depth != 0 || w->after_key)) {
+        w->err = JW_ERR_NESTING;
+    }
+    jw_flush(w);
+    return w->err;
+}
@@ -0,0 +1,95 @@
+#include "lz_codec.h"
+#include <string.h>
+
+// 注意：输出必须满足 LZ4 block 格式的约束，否则标准解码器会拒绝
+// - 最后 5 个字节必须是字面量
+// - 最后一个匹配的起点距离结尾至少 12 个字节
+
+#define LZ_MIN_MATCH   4
+#define LZ_LAST_LITERALS 5
+#define LZ_MFLIMIT     12
+#define LZ_MAX_OFFSET  65535
+
+static inline uint32_t lz_read32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t lz_hash(uint32_t v) {
+    return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+// 长度 >= 15 时的扩展字节: 连续的 255，最后一个字节 < 255
+static uint8_t *lz_put_len(uint8_t *op, size_t len) {
+    while (len >= 255) {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = (uint8_t)len;
+    return op;
+}
+
+// 输出一个序列: token + 字面量 + (可选) 偏移与匹配长度
+static uint8_t *lz_put_sequence(uint8_t *op, const uint8_t *lit, size_t lit_len,
+                                size_t offset, size_t match_len) {
+    uint8_t *token = op++;
+    *token = (uint8_t)((lit_len >= 15 ? 15 : lit_len) << 4);
+    if (lit_len >= 15) op = lz_put_len(op, lit_len - 15);
+    memcpy(op, lit, lit_len);
+    op += lit_len;
+
+    if (offset == 0) return op;  // 最后一个序列只有字面量
+
+    *op++ = (uint8_t)offset;
+    *op++ = (uint8_t)(offset >> 8);
+    size_t ml = match_len - LZ_MIN_MATCH;
+    *token |= (uint8_t)(ml >= 15 ? 15 : ml);
+    if (ml >= 15) op = lz_put_len(op, ml - 15);
+    return op;
+}
+
+size_t lz_compress(const uint8_t *src, size_t len, uint8_t *dst, size_t cap, uint16_t *hash) {
+    if (len > 0xFFFF || cap < LZ_COMPRESS_BOUND(len)) {
+        return 0;
+    }
+
+    const uint8_t *ip = src;
+    const uint8_t *anchor = src;
+    const uint8_t *end = src + len;
+    uint8_t *op = dst;
+
+    if (len >= LZ_MFLIMIT + 1) {
+        const uint8_t *match_limit = end - LZ_LAST_LITERALS;
+        const uint8_t *ip_limit = end - LZ_MFLIMIT;
+
+        memset(hash, 0, LZ_HASH_SIZE * sizeof(uint16_t));
+
+        while (ip <= ip_limit) {
+            uint32_t seq = lz_read32(ip);
+            uint32_t h = lz_hash(seq);
+            const uint8_t *ref = src + hash[h];
+            hash[h] = (uint16_t)(ip - src);
+
+            if (ref >= ip || ip - ref > LZ_MAX_OFFSET || lz_read32(ref) != seq) {
+                ip++;
+                continue;
+            }
+
+            // 向后扩展匹配
+            const uint8_t *mp = ip + LZ_MIN_MATCH;
+            const uint8_t *rp = ref + LZ_MIN_MATCH;
+            while (mp < match_limit && *mp == *rp) {
+                mp++;
+                rp++;
+            }
+
+            op = lz_put_sequence(op, anchor, ip - anchor, ip - ref, mp - ip);
+            ip = mp;
+            anchor = ip;
+        }
+    }
+
+    op = lz_put_sequence(op, anchor, end - anchor, 0, 0);
+    return op - dst;
+}
@@ -10,6 +10,7 @@ static const char *TAG = "Peripherals";
 
 void reset_button_task(void *arg)
 {
+    (void)arg;
     // 初始化 GPIO 0 (FLASH Button)
     gpio_config_t io_conf = {};
     io_conf.pin_bit_mask = (1ULL << FLASH_BUTTON_GPIO);
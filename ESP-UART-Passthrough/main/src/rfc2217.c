@@ -0,0 +1,212 @@
+#include "rfc2217.h"
+#include <string.h>
+
+// 注意：本模块只处理协议逻辑，串口参数的实际修改由回调完成
+
+enum {
+    ST_DATA,
+    ST_IAC,
+    ST_OPT,
+    ST_SB,
+    ST_SB_IAC,
+};
+
+// 选项位: 对端可启用 BINARY / SGA / COM-PORT，本端只启用 BINARY / SGA
+#define OPT_BIT_BINARY   0x01
+#define OPT_BIT_SGA      0x02
+#define OPT_BIT_COM_PORT 0x04
+
+static uint8_t they_bit(uint8_t opt) {
+    switch (opt) {
+        case TELNET_OPT_BINARY:   return OPT_BIT_BINARY;
+        case TELNET_OPT_SGA:      return OPT_BIT_SGA;
+        case TELNET_OPT_COM_PORT: return OPT_BIT_COM_PORT;
+        default:                  return 0;
+    }
+}
+
+static uint8_t we_bit(uint8_t opt) {
+    switch (opt) {
+        case TELNET_OPT_BINARY: return OPT_BIT_BINARY;
+        case TELNET_OPT_SGA:    return OPT_BIT_SGA;
+        default:                return 0;
+    }
+}
+
+static void reply_put(rfc2217_t *t, const uint8_t *data, size_t len) {
+    // 应答缓冲区满时丢弃，客户端会超时重发
+    if (t->reply_len + len > RFC2217_REPLY_MAX) return;
+    memcpy(t->reply + t->reply_len, data, len);
+    t->reply_len += len;
+}
+
+static void reply_opt(rfc2217_t *t, uint8_t verb, uint8_t opt) {
+    const uint8_t seq[3] = { TELNET_IAC, verb, opt };
+    reply_put(t, seq, sizeof(seq));
+}
+
+// 处理 WILL/WONT/DO/DONT，只在状态变化时应答，避免协商死循环
+static void handle_opt(rfc2217_t *t, uint8_t verb, uint8_t opt) {
+    uint8_t bit;
+
+    switch (verb) {
+        case TELNET_WILL:
+            bit = they_bit(opt);
+            if (!bit) {
+                reply_opt(t, TELNET_DONT, opt);
+            } else if (!(t->they_opts & bit)) {
+                t->they_opts |= bit;
+                reply_opt(t, TELNET_DO, opt);
+            }
+            break;
+
+        case TELNET_WONT:
+            bit = they_bit(opt);
+            if (t->they_opts & bit) {
+                t->they_opts &= ~bit;
+                reply_opt(t, TELNET_DONT, opt);
+            }
+            break;
+
+        case TELNET_DO:
+            bit = we_bit(opt);
+            if (!bit) {
+                reply_opt(t, TELNET_WONT, opt);
+            } else if (!(t->we_opts & bit)) {
+                t->we_opts |= bit;
+                reply_opt(t, TELNET_WILL, opt);
+            }
+            break;
+
+        case TELNET_DONT:
+            bit = we_bit(opt);
+            if (t->we_opts & bit) {
+                t->we_opts &= ~bit;
+                reply_opt(t, TELNET_WONT, opt);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+// 处理一条完整的子协商: IAC SB COM-PORT-OPTION <cmd> <value...> IAC SE
+static void handle_sb(rfc2217_t *t) {
+    if (t->sb_overflow || t->sb_len < 2 || t->sb_buf[0] != TELNET_OPT_COM_PORT) {
+        return;
+    }
+
+    uint8_t cmd = t->sb_buf[1];
+    uint32_t value = 0;
+    for (int i = 2; i < t->sb_len; i++) {
+        value = (value << 8) | t->sb_buf[i];
+    }
+
+    uint32_t actual = t->cb ? t->cb(t->ctx, cmd, value) : value;
+
+    // 流控暂停 / 恢复没有参数，也不需要应答
+    int width = 1;
+    if (cmd == RFC2217_SET_BAUDRATE) {
+        width = 4;
+    } else if (cmd == RFC2217_FLOWCONTROL_SUSPEND || cmd == RFC2217_FLOWCONTROL_RESUME) {
+        return;
+    }
+
+    uint8_t seq[4 + 4 * 2 + 2];
+    size_t n = 0;
+    seq[n++] = TELNET_IAC;
+    seq[n++] = TELNET_SB;
+    seq[n++] = TELNET_OPT_COM_PORT;
+    seq[n++] = cmd + RFC2217_SERVER_OFFSET;
+    for (int i = width - 1; i >= 0; i--) {
+        uint8_t b = (uint8_t)(actual >> (i * 8));
+        seq[n++] = b;
+        if (b == TELNET_IAC) seq[n++] = TELNET_IAC;
+    }
+    seq[n++] = TELNET_IAC;
+    seq[n++] = TELNET_SE;
+    reply_put(t, seq, n);
+}
+
+static void sb_append(rfc2217_t *t, uint8_t b) {
+    if (t->sb_len < sizeof(t->sb_buf)) {
+        t->sb_buf[t->sb_len++] = b;
+    } else {
+        t->sb_overflow = true;
+    }
+}
+
+void rfc2217_init(rfc2217_t *t, rfc2217_cmd_cb_t cb, void *ctx) {
+    memset(t, 0, sizeof(*t));
+    t->state = ST_DATA;
+    t->cb = cb;
+    t->ctx = ctx;
+}
+
+size_t rfc2217_decode(rfc2217_t *t, uint8_t *buf, size_t len) {
+    size_t out = 0;
+
+    for (size_t i = 0; i < len; i++) {
+        uint8_t b = buf[i];
+
+        switch (t->state) {
+            case ST_DATA:
+                if (b == TELNET_IAC) {
+                    t->state = ST_IAC;
+                } else {
+                    buf[out++] = b;
+                }
+                break;
+
+            case ST_IAC:
+                if (b == TELNET_IAC) {
+                    buf[out++] = b;
+                    t->state = ST_DATA;
+                } else if (b >= TELNET_WILL && b <= TELNET_DONT) {
+                    t->verb = b;
+                    t->state = ST_OPT;
+                } else if (b == TELNET_SB) {
+                    t->sb_len = 0;
+                    t->sb_overflow = false;
+                    t->state = ST_SB;
+                } else {
+                    // NOP / GA / AYT 等其他命令忽略
+                    t->state = ST_DATA;
+                }
+                break;
+
+            case ST_OPT:
+                handle_opt(t, t->verb, b);
+                t->state = ST_DATA;
+                break;
+
+            case ST_SB:
+                if (b == TELNET_IAC) {
+                    t->state = ST_SB_IAC;
+                } else {
+                    sb_append(t, b);
+                }
+                break;
+
+            case ST_SB_IAC:
+                if (b == TELNET_SE) {
+                    handle_sb(t);
+                    t->state = ST_DATA;
+                } else if (b == TELNET_IAC) {
+                    sb_append(t, b);
+                    t->state = ST_SB;
+                } else {
+                    // 畸形子协商，丢弃
+                    t->state = ST_DATA;
+                }
+                break;
+
+            default:
+                t->state = ST_DATA;
+                break;
+        }
+    }
+
+    return out;
+}
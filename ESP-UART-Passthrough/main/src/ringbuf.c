@@ -0,0 +1,203 @@
+#include "ringbuf.h"
+#include <stdlib.h>
+#include <string.h>
+
+// 注意：本模块只依赖 GCC 内建原子操作，ESP8266 (单核) 与主机端 (多核) 均适用
+// - 生产者先发布 reserve，再拷贝数据，最后发布 head
+// - 读者拷贝完成后重新读取 reserve，判断拷贝期间是否被覆盖 (类似 seqlock)
+// - 读者之间互不共享状态，生产者也从不读取读者状态
+
+#define RB_LOAD(p)      __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define RB_STORE(p, v)  __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define RB_FENCE()      __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+// 自由递增计数的有符号差值，正确处理 32 位回绕
+static inline int32_t rb_diff(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b);
+}
+
+bool rb_init(ringbuf_t *rb, size_t size) {
+    if (size == 0 || (size & (size - 1)) != 0 || size > 0x40000000) {
+        return false;
+    }
+    memset(rb, 0, sizeof(*rb));
+    rb->buffer = malloc(size);
+    if (!rb->buffer) return false;
+    rb->size = (uint32_t)size;
+    rb->mask = (uint32_t)size - 1;
+    return true;
+}
+
+void rb_deinit(ringbuf_t *rb) {
+    free(rb->buffer);
+    memset(rb, 0, sizeof(*rb));
+}
+
+bool rb_resize(ringbuf_t *rb, size_t size) {
+    if (size == 0 || (size & (size - 1)) != 0 || size > 0x40000000) {
+        return false;
+    }
+    uint8_t *buf = malloc(size);
+    if (!buf) return false;
+
+    // 最新的数据按同一逻辑位置搬到新缓冲区，新旧两侧都可能折回，逐段拷贝
+    uint32_t new_mask = (uint32_t)size - 1;
+    uint32_t keep = rb->size < size ? rb->size : (uint32_t)size;
+    uint32_t pos = rb->head - keep;
+    while (keep > 0) {
+        uint32_t src = pos & rb->mask;
+        uint32_t dst = pos & new_mask;
+        uint32_t n = keep;
+        if (n > rb->size - src) n = rb->size - src;
+        if (n > size - dst) n = (uint32_t)size - dst;
+        memcpy(buf + dst, rb->buffer + src, n);
+        pos += n;
+        keep -= n;
+    }
+
+    free(rb->buffer);
+    rb->buffer = buf;
+    rb->size = (uint32_t)size;
+    rb->mask = new_mask;
+    rb->reserve = rb->head;
+    return true;
+}
+
+uint32_t rb_head(const ringbuf_t *rb) {
+    return RB_LOAD(&rb->head);
+}
+
+void rb_reader_init(rb_reader_t *rd, uint32_t pos) {
+    rd->tail = pos;
+    rd->lost = 0;
+}
+
+// 从逻辑位置 pos 开始拷入 len 字节 (len <= size)，最多两段
+static void rb_copy_in(ringbuf_t *rb, uint32_t pos, const uint8_t *src, uint32_t len) {
+    uint32_t off = pos & rb->mask;
+    uint32_t first = rb->size - off;
+    if (first > len) first = len;
+    memcpy(rb->buffer + off, src, first);
+    memcpy(rb->buffer, src + first, len - first);
+}
+
+// 从逻辑位置 pos 开始拷出 len 字节 (len <= size)，最多两段
+static void rb_copy_out(const ringbuf_t *rb, uint32_t pos, uint8_t *dst, uint32_t len) {
+    uint32_t off = pos & rb->mask;
+    uint32_t first = rb->size - off;
+    if (first > len) first = len;
+    memcpy(dst, rb->buffer + off, first);
+    memcpy(dst + first, rb->buffer, len - first);
+}
+
+void rb_write(ringbuf_t *rb, const uint8_t *data, size_t len) {
+    if (!rb->buffer || len == 0) return;
+
+    uint32_t start = rb->head;
+    uint32_t end = start + (uint32_t)len;
+
+    // 超过容量的部分必然被覆盖，直接跳过，只保留最新的 size 字节
+    if (len > rb->size) {
+        data += len - rb->size;
+        start = end - rb->size;
+        len = rb->size;
+    }
+
+    // 先声明即将覆盖的范围，再动数据
+    RB_STORE(&rb->reserve, end);
+    RB_FENCE();
+    rb_copy_in(rb, start, data, (uint32_t)len);
+    RB_STORE(&rb->head, end);
+}
+
+size_t rb_space(const ringbuf_t *rb, uint32_t pin) {
+    int32_t used = rb_diff(RB_LOAD(&rb->head), pin);
+    if (used < 0 || (uint32_t)used > rb->size) {
+        return rb->size;
+    }
+    return rb->size - (uint32_t)used;
+}
+
+// 将读位置跳过已被覆盖 (或正在被覆盖) 的数据，返回当前 head
+static uint32_t rb_sync(ringbuf_t *rb, rb_reader_t *rd) {
+    // 先读 reserve 再读 head，保证 oldest 不会超过本次读到的 head
+    uint32_t oldest = RB_LOAD(&rb->reserve) - rb->size;
+    uint32_t head = RB_LOAD(&rb->head);
+    if (rb_diff(oldest, rd->tail) > 0) {
+        rd->lost += oldest - rd->tail;
+        rd->tail = oldest;
+    }
+    // 读者起始位置超前于写位置 (不应出现)，对齐到 head
+    if (rb_diff(rd->tail, head) > 0) {
+        rd->tail = head;
+    }
+    return head;
+}
+
+// 数据使用完后检查：[tail, ...) 中有多少字节在使用期间被覆盖
+static uint32_t rb_clobbered(ringbuf_t *rb, rb_reader_t *rd) {
+    RB_FENCE();
+    uint32_t oldest = RB_LOAD(&rb->reserve) - rb->size;
+    int32_t bad = rb_diff(oldest, rd->tail);
+    return bad > 0 ? (uint32_t)bad : 0;
+}
+
+size_t rb_available(ringbuf_t *rb, rb_reader_t *rd) {
+    if (!rb->buffer) return 0;
+    uint32_t head = rb_sync(rb, rd);
+    int32_t avail = rb_diff(head, rd->tail);
+    return avail > 0 ? (size_t)avail : 0;
+}
+
+size_t rb_read(ringbuf_t *rb, rb_reader_t *rd, uint8_t *dst, size_t max_len) {
+    if (!rb->buffer || max_len == 0) return 0;
+
+    uint32_t head = rb_sync(rb, rd);
+    int32_t avail = rb_diff(head, rd->tail);
+    if (avail <= 0) return 0;
+
+    uint32_t n = (uint32_t)avail;
+    if (n > max_len) n = (uint32_t)max_len;
+    rb_copy_out(rb, rd->tail, dst, n);
+
+    // 拷贝期间生产者可能绕圈覆盖了开头部分，丢弃这段无效前缀
+    uint32_t bad = rb_clobbered(rb, rd);
+    if (bad >= n) {
+        rd->lost += bad;
+        rd->tail += bad;
+        return 0;
+    }
+    if (bad > 0) {
+        memmove(dst, dst + bad, n - bad);
+        rd->lost += bad;
+    }
+    rd->tail += n;
+    return n - bad;
+}
+
+size_t rb_peek_at(ringbuf_t *rb, rb_reader_t *rd, size_t offset, const uint8_t **data) {
+    if (!rb->buffer) return 0;
+
+    uint32_t head = rb_sync(rb, rd);
+    uint32_t pos = rd->tail + (uint32_t)offset;
+    int32_t avail = rb_diff(head, pos);
+    if (avail <= 0) return 0;
+
+    uint32_t off = pos & rb->mask;
+    uint32_t span = rb->size - off;
+    if (span > (uint32_t)avail) span = (uint32_t)avail;
+
+    *data = rb->buffer + off;
+    return span;
+}
+
+size_t rb_peek(ringbuf_t *rb, rb_reader_t *rd, const uint8_t **data) {
+    return rb_peek_at(rb, rd, 0, data);
+}
+
+bool rb_commit(ringbuf_t *rb, rb_reader_t *rd, size_t len) {
+    if (!rb->buffer) return true;
+    bool intact = rb_clobbered(rb, rd) == 0;
+    rd->tail += (uint32_t)len;
+    return intact;
+}
@@ -0,0 +1,114 @@
+#include "soft_uart.h"
+#include <string.h>
+#include "driver/gpio.h"
+#include "esp_attr.h"
+#include "esp8266/gpio_struct.h"
+#include "sdkconfig.h"
+
+#define SU_CPU_HZ (CONFIG_ESP8266_DEFAULT_CPU_FREQ_MHZ * 1000000UL)
+#define SU_EDGE_MASK (SOFT_UART_EDGES - 1)
+
+static inline uint32_t su_ccount(void) {
+    uint32_t ccount;
+    __asm__ __volatile__("rsr %0, ccount" : "=a"(ccount));
+    return ccount;
+}
+
+// 边沿中断: 只记录时间与电平，队列满时丢弃 (解码时按记录的电平重新同步)
+static void IRAM_ATTR soft_uart_isr(void *arg) {
+    soft_uart_t *su = (soft_uart_t *)arg;
+    uint32_t t = su_ccount();
+    uint32_t level = (GPIO.in.val >> su->gpio) & 1;  // 直接读寄存器，gpio_get_level 不在 IRAM 中
+    uint32_t head = su->edge_head;
+
+    if (head - su->edge_tail >= SOFT_UART_EDGES) {
+        su->edge_overflow++;
+        return;
+    }
+    su->edges[head & SU_EDGE_MASK] = (t & ~1u) | level;
+    __atomic_store_n(&su->edge_head, head + 1, __ATOMIC_RELEASE);
+}
+
+bool soft_uart_init(soft_uart_t *su, int gpio, uint32_t baud) {
+    if (baud == 0 || gpio < 0 || gpio >= 16) {
+        return false;
+    }
+    memset(su, 0, sizeof(*su));
+    su->gpio = gpio;
+    su->bit_cycles = SU_CPU_HZ / baud;
+    su->level = 1;
+
+    gpio_config_t io_conf = {};
+    io_conf.pin_bit_mask = (1ULL << gpio);
+    io_conf.mode = GPIO_MODE_INPUT;
+    // 空闲为高电平，开启上拉避免引脚悬空时产生大量边沿
+    io_conf.pull_up_en = 1;
+    io_conf.pull_down_en = 0;
+    io_conf.intr_type = GPIO_INTR_ANYEDGE;
+    if (gpio_config(&io_conf) != ESP_OK) {
+        return false;
+    }
+
+    // 多个通道共用 GPIO 中断服务，重复安装的错误可以忽略
+    gpio_install_isr_service(0);
+    return gpio_isr_handler_add(gpio, soft_uart_isr, su) == ESP_OK;
+}
+
+// 线路在 until 之前保持 su->level 不变: 采样其间经过的位中点
+// 返回 true 表示一帧结束并输出了一个字节
+static bool su_advance(soft_uart_t *su, uint32_t until, uint8_t *out) {
+    while (su->in_frame) {
+        uint32_t center = su->frame_start + su->bit * su->bit_cycles + su->bit_cycles / 2;
+        if ((int32_t)(until - center) <= 0) {
+            return false;
+        }
+
+        if (su->bit == 0) {
+            if (su->level != 0) {
+                su->in_frame = false;  // 起始位中点已回到高电平，是毛刺
+                return false;
+            }
+        } else if (su->bit <= 8) {
+            su->shift = (su->shift >> 1) | (su->level ? 0x80 : 0);  // 低位先发
+        } else {
+            su->in_frame = false;
+            if (su->level == 0) {
+                su->frame_errors++;
+                return false;
+            }
+            *out = su->shift;
+            return true;
+        }
+        su->bit++;
+    }
+    return false;
+}
+
+size_t soft_uart_read(soft_uart_t *su, uint8_t *buf, size_t len) {
+    // 先取时间再取队列位置: 早于 now 的边沿此时必然都已入队
+    uint32_t now = su_ccount();
+    uint32_t head = __atomic_load_n(&su->edge_head, __ATOMIC_ACQUIRE);
+    size_t n = 0;
+
+    // 两个边沿之间最多结束一帧，每处理一个边沿前保证还能放下一个字节
+    while (n < len && su->edge_tail != head) {
+        uint32_t e = su->edges[su->edge_tail & SU_EDGE_MASK];
+        uint32_t t = e & ~1u;
+        if (su_advance(su, t, &buf[n])) n++;
+
+        su->level = e & 1;
+        if (!su->in_frame && su->level == 0) {
+            su->in_frame = true;
+            su->bit = 0;
+            su->shift = 0;
+            su->frame_start = t;
+        }
+        su->edge_tail++;
+    }
+
+    // 队列已空: 最后一帧剩余的高电平位没有边沿，按当前时间补齐
+    if (n < len && su->edge_tail == head && su_advance(su, now, &buf[n])) {
+        n++;
+    }
+    return n;
+}
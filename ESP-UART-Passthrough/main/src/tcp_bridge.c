@@ -1,280 +1,2600 @@
 #include "tcp_bridge.h"
+#include "bridge_config.h"
+#include "ringbuf.h"
+#include "rfc2217.h"
+#include "bridge_rfc2217.h"
+#include "bridge_frame.h"
+#include "bridge_framer.h"
+#include "bridge_spool.h"
+#include "bridge_stats.h"
+#include "bridge_lat.h"
+#include "uart_filter.h"
+#include "bridge_tls.h"
+#include "bridge_zerocopy.h"
+#include "bridge_udp.h"
+#include "bridge_ctl.h"
+#include "bridge_bench.h"
+#include "bridge_aux.h"
+#include "wifi_prov.h"
 #include <stdio.h>
 #include <string.h>
 #include <sys/socket.h>
+#include "sdkconfig.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
+#include "freertos/queue.h"
 #include "driver/uart.h"
+#include "esp8266/uart_struct.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "lwip/err.h"
 #include "lwip/sockets.h"
+#include "mbedtls/net_sockets.h"
 
 static const char *TAG = "TCP_Bridge";
 
 // === 配置参数 ===
-#define TCP_PORT 8888
+// 端口、波特率、读写块大小与缓存大小为运行时参数，保存在 NVS 中 (见 bridge_config.h)
 #define UART_NUM UART_NUM_0
-#define BRIDGE_BAUDRATE 115200
-#define BUF_SIZE 512       // 单次读写临时缓冲区大小
 
-// 离线缓存大小 (8KB)
-// 请根据 ESP8266 剩余内存实际情况调整，太大会导致 malloc 失败
-#define UART_CACHE_SIZE (8 * 1024) 
+// === 控制端口 ===
+// 文本行命令 "get" / "set <参数名> <值>" (见 bridge_ctl.h)，修改即写入 NVS，0 表示不启用
+#define CONTROL_PORT 8880
 
-// === 共享上下文结构体 ===
+// === 统计快照端口 (UDP) ===
+// 向该端口发送任意数据报，回复一份二进制统计快照 (格式见 bridge_stats.h)，0 表示不启用
+// 用 UDP 请求 / 应答而不是 TCP，只占一个 socket 且轮询无需建连
+#define STATS_PORT 8881
+
+// === RFC 2217 (Telnet COM-PORT-OPTION) ===
+// 供 pyserial 的 rfc2217:// 使用，可远程修改波特率 / 数据位 / 校验 / 停止位并控制 DTR/RTS
+// 与原始透传端口共用缓存与客户端槽位，0 表示不启用
+#define RFC2217_PORT 2217
+#define BRIDGE_DTR_GPIO 5   // D1，低电平有效 (与 USB 串口芯片一致)
+#define BRIDGE_RTS_GPIO 4   // D2，低电平有效
+
+// === 分帧上行 ===
+// 每段数据附带字节序号与采集时间，缓存溢出时发送显式的 GAP 记录，格式见 bridge_frame.h
+// 0 表示不启用
+#define FRAMED_PORT 8889
+#define TS_INDEX_SIZE 128   // 采集时间索引条目数，必须是 2 的幂
+
+// === 分帧 + 压缩上行 ===
+// 同分帧协议，数据记录改为逐个合包压缩 (LZ4 block 格式)，用于拥挤信道下节省空口时间
+// 默认不启用: 初始化时即分配压缩工作区 (约 2KB) 与每个客户端一个输出缓冲区，
+// 监听端口另占 1 个 socket，启用前须按下方的 socket 预算先腾出
+#define FRAMED_LZ_PORT 0  // 如 8890
+#define LZ_CHUNK_MAX 1024   // 单条压缩记录的最大原始长度
+
+// === TLS 上行 ===
+// 与原始透传端口相同的数据流，经 TLS (PSK) 加密，同时只服务一个 TLS 会话 (见 bridge_tls.h)
+// 首个密钥只能在配网页面 (设备自身热点) 设置，之后经网页 /bridge 或控制端口更换时须提供当前密钥
+// 未设置密钥时拒绝连接
+// 默认不启用: 会话上下文常驻 RAM (默认 sdkconfig 下约 22KB，缩小收发缓冲区后约 8KB，见 bridge_tls.h)；
+// 会话占用客户端槽位，监听端口另占 1 个 socket，启用前须按下方的 socket 预算先腾出
+#define TLS_PORT 0  // 如 8443
+// 1: 设置了密钥后只经 TLS 提供串口数据，明文的原始 / RFC 2217 / 分帧端口关闭、UDP 上行暂停
+// (控制端口与统计端口不传串口数据，保留)；清除密钥后明文端口重新打开
+#define TLS_ONLY 0
+
+// === 附加串口通道 ===
+// GPIO 上的软件 UART 只收通道，数据复用分帧端口发送，开关 AUX_UART_NUM 与各项参数见 bridge_aux.h
+
+// === UDP / 组播上行 ===
+// 合包后的数据以 UDP 数据报发布到单播地址或组播组，任意数量的接收端订阅不增加设备开销
+// 每个数据报带递增序号 (格式见 bridge_frame.h)；不占用客户端槽位、不参与流控，下行仍走 TCP
+// 默认不启用: 发送 socket 另占 1 个，启用前须按下方的 socket 预算先腾出
+#define UDP_UPLINK_PORT 0
+#define UDP_UPLINK_ADDR "239.255.88.88"  // 组播组或单播主机地址
+#define UDP_MULTICAST_TTL 1              // 组播跳数，1 表示不出本网段
+#define UDP_RETRY_US 10000               // 协议栈缓冲区不足时的重试间隔
+
+// === Flash 离线缓存 (spool) ===
+// 没有客户端 (或最慢的客户端已严重落后) 时，串口数据批量写入 "spool" 分区的循环日志 (见 partitions.csv)，
+// 首个客户端连接时先从 Flash 补发 RAM 缓存已覆盖的历史数据；分区不存在时自动禁用
+// 擦写寿命: 512KB 分区在 115200 波特率下持续写入约 45 秒轮转一圈，每个扇区每天擦除约 1900 次，
+// 按 10 万次寿命约两个月即耗尽。因此客户端在线且跟得上时不写入，
+// 寿命预算折合约 50GB 的离线数据 (115200 波特率下持续离线约 50 天)，分区加大则按比例延长
+// 默认不启用
+#define BRIDGE_SPOOL 0
+#define SPOOL_FLUSH_MS 100                  // 批量写入周期，115200 波特率下每批约 1.1KB
+#define SPOOL_BOOT_REPLAY_MAX (64 * 1024)   // 启动后首个客户端最多补发的上次运行数据
+#define SPOOL_BEHIND_THRESH (s_rb.size / 2) // 客户端在线时，最慢客户端积压超过该值才写入 (数据面临覆盖)
+
+// === 零拷贝发送 ===
+// 原始协议客户端绕过 send() 的拷贝，直接把缓存区间挂到 TCP 发送队列 (tcp_write 不带 COPY)，
+// 区间在对端确认前由 pin 保护不被覆盖。依赖 lwIP 内部接口 (见 bridge_zerocopy.c)，0 表示不启用
+// 对端迟迟不确认时守护任务最多等待 ZC_PIN_WAIT_MS (期间由驱动接收缓冲区承接)，随后断开该连接
+#define BRIDGE_TX_ZEROCOPY 1
+#define ZC_BACKLOG_MAX (s_rb.size / 2)       // 零拷贝客户端的最大积压，超出时提前丢弃最旧数据
+#define ZC_PIN_WAIT_MS 200                    // 生产者等待确认的上限，超时后断开被钉住的连接
+
+// 最大同时在线客户端数
+#define BRIDGE_MAX_CLIENTS 3
+
+// === socket 预算 ===
+// 所有 socket 共用 CONFIG_LWIP_MAX_SOCKETS (SDK 上限 16)，默认配置正好用满:
+//   唤醒 2 + 监听 3 (原始 / RFC 2217 / 分帧) + 控制 2 + 统计 1 + 客户端 3
+//   + 槽位已满时先 accept 再拒绝或接管的连接 1 + WebServer 4 (见 wifi_prov.h) = 16
+// FRAMED_LZ_PORT / TLS_PORT / UDP_UPLINK_PORT 各另占 1 个，启用前先腾出等量的 socket，
+// 如关闭 RFC2217_PORT 或 FRAMED_PORT，或减少 BRIDGE_MAX_CLIENTS；超出时编译报错
+#define BRIDGE_SOCKETS (2 + 1 + (RFC2217_PORT > 0) + (FRAMED_PORT > 0) + (FRAMED_LZ_PORT > 0) + \
+                        (TLS_PORT > 0) + (CONTROL_PORT > 0) * 2 + (STATS_PORT > 0) + \
+                        (UDP_UPLINK_PORT > 0) + BRIDGE_MAX_CLIENTS + 1)
+#if BRIDGE_SOCKETS + WEB_SOCKETS > CONFIG_LWIP_MAX_SOCKETS
+#error "socket budget exceeds CONFIG_LWIP_MAX_SOCKETS, see the socket budget above"
+#endif
+
+// === 会话保活与接管 ===
+// 客户端 Wi-Fi 消失时既不会收到 FIN 也不会收到 RST，需要主动发现并释放槽位
+#define KEEPALIVE_IDLE_S 5        // 空闲多久后开始保活探测，0 表示不启用保活
+#define KEEPALIVE_INTVL_S 2       // 探测间隔
+#define KEEPALIVE_COUNT 3         // 连续无应答次数，约 IDLE + INTVL * COUNT 秒后断开
+#define STALL_TIMEOUT_MS 8000     // 发送持续无进展超过该时间即断开 (相当于 TCP_USER_TIMEOUT)
+#define PREEMPT_SAME_HOST 1       // 槽位已满时，同一地址的新连接替换旧会话 (漫游后重连)
+#define PREEMPT_STALLED_MS 2000   // 槽位已满时，新连接替换发送已阻塞超过该时间最久的会话
+
+// === 下行 (TCP -> UART) 控制权策略 ===
+#define DOWNLINK_FIRST_WRITER 0  // 第一个发送数据的客户端获得控制权，空闲超时后可被接管
+#define DOWNLINK_EXCLUSIVE    1  // 最早连接的客户端独占，断开后顺延给下一个最早连接的客户端
+#define DOWNLINK_MERGED       2  // 所有客户端的数据按到达顺序合并写入串口
+#define BRIDGE_DOWNLINK_POLICY DOWNLINK_FIRST_WRITER
+#define DOWNLINK_IDLE_RELEASE_MS 5000  // FIRST_WRITER 模式下控制权空闲释放时间
+
+// === 下行发送 ===
+// I/O 任务只把下行数据放入发送环，由发送任务写入驱动；驱动发送缓冲区由 TX FIFO 空中断续填
+// 发送环将满时暂停读取客户端 socket，TCP 窗口随之关闭，对端 (如烧录工具) 自然减速
+#define UART_TX_BUF_SIZE 512      // 驱动层发送缓冲区 (必须大于 128 字节的硬件 FIFO)
+#define UART_TX_RING_SIZE 4096    // 下行发送环，必须是 2 的幂且不小于读写块上限
+#define UART_TX_DRAIN_MS 500      // 修改串口参数前等待已排队数据按旧参数发完的上限
+#define UART_TX_CMD_NUM 4         // 排在下行数据之后、尚未执行的串口参数修改
+
+// === 串口流控 ===
+#define FLOW_CTRL_NONE    0  // 无流控，缓存满时覆盖最旧数据
+#define FLOW_CTRL_RTSCTS  1  // 硬件 RTS/CTS (swap 后 RTS->GPIO1/TX0 焊盘, CTS->GPIO3/RX0 焊盘)
+#define FLOW_CTRL_XONXOFF 2  // 软件 XON/XOFF
+#define BRIDGE_FLOW_CTRL FLOW_CTRL_NONE
+#define FLOW_HIGH_WATER (s_rb.size * 3 / 4)  // 客户端积压超过该值时向目标设备施加背压
+#define FLOW_LOW_WATER  (s_rb.size / 4)      // 积压回落到该值以下时解除背压
+#define UART_HW_RTS_THRESH 100                     // 硬件 FIFO 超过该字节数时拉高 RTS
+#define XON_CHAR  0x11
+#define XOFF_CHAR 0x13
+
+// === 波特率自动协商 ===
+// 短时间内出现大量帧错误，说明两端波特率不一致，按候选表依次切换
+#define BRIDGE_AUTOBAUD 0
+#define AUTOBAUD_ERR_THRESH 8       // 窗口内帧错误次数阈值
+#define AUTOBAUD_WINDOW_MS 500
+
+// UART 驱动参数
+#define UART_RX_BUF_SIZE 2048       // 驱动层接收缓冲区
+#define UART_EVENT_QUEUE_LEN 20     // 驱动事件队列深度
+#define UART_RX_TOUT_THRESH 2       // 线路空闲 N 个字符时间后触发 RX 超时中断
+#define UART_RXFIFO_FULL_THRESH 64  // 硬件 FIFO 达到该字节数时触发中断
+
+// === 上行合包 (Coalescing) 参数 ===
+// 数据先在环形缓冲区中攒包，满足任一条件即发送，在每秒报文数与时延之间取舍
+#ifdef CONFIG_LWIP_TCP_MSS
+#define COALESCE_MAX_BYTES CONFIG_LWIP_TCP_MSS  // 攒够一个 MSS 立即发送
+#else
+#define COALESCE_MAX_BYTES 1440
+#endif
+#define COALESCE_HOLD_US 20000      // 最早的未发送字节最长滞留时间 (微秒)
+#define COALESCE_FLUSH_ON_IDLE 1    // UART 线路空闲 (RX 超时中断) 时立即发送
+#define COALESCE_DELIMITER (-1)     // 分隔符 (如 '\n')，发送到最后一个分隔符为止；-1 不启用
+
+// === 性能测试 ===
+// 启用后由内部任务按固定速率生成数据代替目标设备 (速率等参数见 bridge_bench.h)
+#define BRIDGE_BENCH 0
+
+// === 合包状态 (每个客户端一份) ===
+typedef struct {
+    int64_t hold_start_us;  // 最早未发送字节的到达时间，0 表示当前无待发数据
+    uint32_t idle_seen;     // 已处理的线路空闲计数
+    uint32_t scan_pos;      // 分隔符扫描进度 (环形缓冲区绝对位置)
+    uint32_t delim_end;     // 最后一个分隔符之后的位置 (绝对位置)
+} coalesce_state_t;
+
+// === 客户端协议 ===
+#define BRIDGE_PROTO_RAW     0  // 原始字节流
+#define BRIDGE_PROTO_RFC2217 1  // Telnet + COM-PORT-OPTION
+#define BRIDGE_PROTO_FRAMED  2  // 带序号与时间戳的分帧记录
+#define BRIDGE_PROTO_FRAMED_LZ 3  // 分帧记录，数据负载压缩
+#define BRIDGE_PROTO_TLS     4  // 原始字节流，TLS 加密
+
+// === 客户端会话 ===
+typedef struct {
+    int sock;
+    uint8_t proto;
+    rb_reader_t reader;         // 在共享环形缓冲区中的读游标
+    coalesce_state_t cs;        // 合包状态
+    uint32_t lost_reported;     // 已上报的丢失字节数
+    bool want_write;            // 上次发送遇到 EAGAIN，等待 socket 可写
+    bool rx_pending;            // 协议层还缓存着已收到的下行数据 (发送环满时暂停处理)
+    int64_t connected_us;       // 连接建立时间
+    int64_t last_write_us;      // 最近一次下行写入时间
+    int64_t blocked_since_us;   // 发送缓冲区持续满的起始时间，0 表示未阻塞
+    char addr[16];
+    // 以下仅 RFC 2217 客户端使用
+    rfc2217_t tn;               // 下行 Telnet 解析器
+    bool iac_pending;           // 上行已发出数据中的 0xFF，转义用的第二个 0xFF 尚未发出
+    bool suspended;             // 客户端请求暂停上行 (FLOWCONTROL-SUSPEND)
+    // 以下仅分帧客户端 (及 UDP 上行) 使用
+    bridge_framer_t fr;         // 记录编码器
+#if AUX_UART_NUM > 0
+    bridge_aux_reader_t aux;    // 附加通道的读游标与记录缓冲
+#endif
+#if TLS_PORT > 0
+    // 以下仅 TLS 客户端使用
+    mbedtls_ssl_context *tls;   // 非 NULL 表示 TLS 会话
+    bool tls_ready;             // 握手已完成
+    uint16_t tls_unsent;        // 已交给 mbedTLS、但记录尚未完全发出的明文长度
+#endif
+    // Flash 补发 (仅原始协议客户端)
+    bool replaying;
+    uint32_t replay_pos;        // 下一个补发字节的 spool 位置
+    uint32_t replay_end;        // 补发终点，即 RAM 缓存接续的位置
+#if BRIDGE_TX_ZEROCOPY
+    struct netconn *zc_conn;    // 非 NULL 表示使用零拷贝发送
+    bool zc_pinned;             // 协议栈中有尚未确认、直接引用缓存的数据
+    uint32_t zc_acked;          // 最早仍被引用的位置 (zc_pinned 时有效)
+#endif
+} bridge_client_t;
+
+// === 监听端口 ===
 typedef struct {
-    int sock;               
-    SemaphoreHandle_t exit_sem; 
-    volatile bool running;  
-} bridge_context_t;
+    uint16_t port;
+    uint8_t proto;
+    int sock;
+} bridge_listener_t;
+
+// === 环形缓冲区 (单生产者: 守护任务, 多读者: 每个客户端一个游标) ===
+static ringbuf_t s_rb;
+
+// UART 驱动事件队列
+static QueueHandle_t s_uart_queue;
+
+// 最近一次串口数据写入缓存的时间戳 (us)
+static volatile int64_t s_last_rx_us = 0;
+
+// UART 线路空闲 (RX 超时) 次数，上行合包据此判断是否立即发送
+static volatile uint32_t s_line_idle_cnt = 0;
+
+// 合包滞留超时定时器，到期后唤醒 I/O 任务
+static esp_timer_handle_t s_hold_timer;
+
+// 当前波特率
+static volatile uint32_t s_baudrate = BRIDGE_CFG_BAUDRATE;
+
+// 当前串口参数，RFC 2217 修改数据位 / 校验 / 停止位时整体重新下发
+static uart_config_t s_uart_config;
+
+// 在线客户端中最慢的读位置 (I/O 任务维护)，守护任务据此计算积压量决定是否背压
+static volatile uint32_t s_backlog_tail = 0;
+static volatile bool s_flow_paused = false;
+static TaskHandle_t s_daemon_task = NULL;
+
+#if BRIDGE_TX_ZEROCOPY
+// 所有零拷贝客户端中最早仍被协议栈引用的位置 (I/O 任务发布，守护任务写入前检查)
+static volatile uint32_t s_zc_pin = 0;
+static volatile bool s_zc_pinned = false;
+static volatile bool s_zc_waiting = false;  // 守护任务正在等待确认
+static volatile bool s_zc_break = false;    // 等待超时，要求 I/O 任务断开被钉住的连接
+#endif
+
+#if BRIDGE_AUTOBAUD
+static const uint32_t s_autobaud_rates[] = {
+    115200, 921600, 2000000, 460800, 230400, 74880, 57600, 38400, 19200, 9600
+};
+#endif
+
+// === 启动时一次性分配的资源，运行期间不再 malloc/free ===
+static bridge_client_t *s_client_pool;  // BRIDGE_MAX_CLIENTS 个会话槽位
+static uint8_t *s_uart_buf;             // 守护任务的串口读取缓冲区
+static uint8_t *s_net_buf;              // I/O 任务的下行接收缓冲区
+static bridge_listener_t s_listeners[] = {
+    { BRIDGE_CFG_TCP_PORT, BRIDGE_PROTO_RAW, -1 },  // 端口启动时按配置改写
+#if RFC2217_PORT > 0
+    { RFC2217_PORT, BRIDGE_PROTO_RFC2217, -1 },
+#endif
+#if FRAMED_PORT > 0
+    { FRAMED_PORT, BRIDGE_PROTO_FRAMED, -1 },
+#endif
+#if FRAMED_LZ_PORT > 0
+    { FRAMED_LZ_PORT, BRIDGE_PROTO_FRAMED_LZ, -1 },
+#endif
+#if TLS_PORT > 0
+    { TLS_PORT, BRIDGE_PROTO_TLS, -1 },
+#endif
+};
+#define BRIDGE_LISTENER_NUM ((int)(sizeof(s_listeners) / sizeof(s_listeners[0])))
+
+// === 运行时参数 ===
+static bridge_config_t s_cfg;          // 当前生效的参数 (I/O 任务修改，修改缓冲区时其他任务已暂停)
+static bridge_config_t s_cfg_target;   // 已保存、待生效的参数 (由 s_cfg_lock 保护)
+static SemaphoreHandle_t s_cfg_lock;
+static volatile bool s_cfg_pending = false;
+
+// 串口数据过滤器，仅守护任务访问；配置修改后由守护任务自己重建
+static uart_filter_t s_filter;
+static volatile bool s_filter_pending = false;
+
+// 调整缓冲区大小期间，守护任务与 spool 任务在安全点暂停，各自归还一次 s_rb_parked
+static volatile bool s_rb_resize_req = false;
+static SemaphoreHandle_t s_rb_parked;
+
+// === 以下状态仅由 I/O 任务访问 ===
+static bridge_client_t *s_clients[BRIDGE_MAX_CLIENTS];  // 指向 s_client_pool 中在用的槽位
+static volatile int s_client_count = 0;
+
+// UDP 上行已启用: 它不占用客户端槽位，没有客户端时同样需要唤醒 I/O 任务
+static bool s_udp_active = false;
+static bridge_client_t *s_downlink_owner = NULL;
+
+// 已投递给任一客户端的最远位置，新客户端从这里开始接收
+// 单客户端时即为原来的语义: 断线期间缓存的数据在重连后补发
+static uint32_t s_delivered_pos = 0;
+
+#if BRIDGE_SPOOL
+static bool s_spool_ok = false;
+static uint32_t s_spool_base = 0;      // 环形缓冲区位置 0 对应的 spool 位置
+static bool s_boot_replayed = false;   // 上次运行的数据是否已补发过
+static uint8_t *s_spool_buf;
+#endif
+
+// 各环节计数，每个字段只由一个任务写入 (见 bridge_stats.h)
+static bridge_stats_t s_stats;
+
+#if BRIDGE_BENCH
+static volatile uint32_t s_bench_sent = 0;     // 所有客户端累计发出的字节数
+static volatile uint32_t s_bench_busy_us = 0;  // I/O 任务累计处理耗时
+#endif
+
+// ====================================================
+// 唤醒门铃
+// select() 无法等待任务通知，改为向本地回环 UDP 端口投递 1 字节报文唤醒 I/O 任务
+// 守护任务与定时器回调共用发送 socket，由互斥锁串行化 (仅在未挂起唤醒时才会取锁)
+// ====================================================
+static int s_wake_rx_sock = -1;
+static int s_wake_tx_sock = -1;
+static struct sockaddr_in s_wake_addr;
+static SemaphoreHandle_t s_wake_lock;
+static volatile bool s_wake_pending = false;
+
+static bool doorbell_init(void) {
+    s_wake_rx_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    s_wake_tx_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    s_wake_lock = xSemaphoreCreateMutex();
+    if (s_wake_rx_sock < 0 || s_wake_tx_sock < 0 || !s_wake_lock) {
+        return false;
+    }
+
+    memset(&s_wake_addr, 0, sizeof(s_wake_addr));
+    s_wake_addr.sin_family = AF_INET;
+    s_wake_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    s_wake_addr.sin_port = 0;
+
+    // 绑定随机端口，再取回实际端口号
+    socklen_t addr_len = sizeof(s_wake_addr);
+    if (bind(s_wake_rx_sock, (struct sockaddr *)&s_wake_addr, sizeof(s_wake_addr)) != 0 ||
+        getsockname(s_wake_rx_sock, (struct sockaddr *)&s_wake_addr, &addr_len) != 0) {
+        return false;
+    }
+    fcntl(s_wake_rx_sock, F_SETFL, O_NONBLOCK);
+    return true;
+}
+
+// 无条件唤醒 I/O 任务 (如参数修改)
+static void doorbell_wake(void) {
+    if (s_wake_pending) return;
+
+    xSemaphoreTake(s_wake_lock, portMAX_DELAY);
+    if (!s_wake_pending) {
+        s_wake_pending = true;
+        uint8_t b = 0;
+        sendto(s_wake_tx_sock, &b, 1, 0, (struct sockaddr *)&s_wake_addr, sizeof(s_wake_addr));
+    }
+    xSemaphoreGive(s_wake_lock);
+}
+
+// 有新的上行数据: 没有任何消费者 (客户端或 UDP 上行) 时不必唤醒
+static void doorbell_ring(void) {
+    if (s_client_count == 0 && !s_udp_active) return;
+    doorbell_wake();
+}
+
+static void doorbell_drain(void) {
+    uint8_t buf[8];
+    // 先收包再清标志: 收包期间挂起的唤醒若被这里收掉，标志会停在 true 而不再有包，
+    // 之后的唤醒全部被跳过，I/O 任务只能靠 select 超时醒来
+    // 清除之前被跳过的唤醒由本轮随后的处理覆盖，清除之后的唤醒会触发下一次 select
+    while (recv(s_wake_rx_sock, buf, sizeof(buf), 0) > 0) {
+    }
+    s_wake_pending = false;
+}
+
+// ====================================================
+// 下行发送环 (单生产者: I/O 任务, 单消费者: 发送任务)
+// 取代在 I/O 任务中直接调用 uart_write_bytes: 驱动没有发送缓冲区时，
+// 每次写入都阻塞到数据进入 FIFO，期间所有客户端的收发都停顿
+// ====================================================
+_Static_assert(UART_TX_RING_SIZE >= BRIDGE_CFG_CHUNK_MAX &&
+               (UART_TX_RING_SIZE & (UART_TX_RING_SIZE - 1)) == 0, "bad UART_TX_RING_SIZE");
+
+static uint8_t *s_tx_ring;
+static volatile uint32_t s_tx_head = 0;  // 写位置 (I/O 任务)
+static volatile uint32_t s_tx_tail = 0;  // 读位置 (发送任务)
+static volatile bool s_tx_full = false;  // I/O 任务因空间不足暂停了下行读取
+static TaskHandle_t s_tx_task = NULL;
+
+// 串口参数修改 (RFC 2217): 排在修改前已进入发送环的数据之后，由发送任务执行，
+// 等这些数据按旧参数发完再切换，期间 I/O 任务照常服务其他客户端
+typedef struct {
+    uint32_t pos;         // 发送环写位置，此前的数据按旧参数发送
+    uart_config_t cfg;    // 完整的新参数
+} uart_tx_cmd_t;
+static QueueHandle_t s_tx_cmd_queue;
+
+// 清空下行 (RFC 2217 PURGE_DATA): 发送任务丢弃此位置之前尚未发出的数据
+static volatile uint32_t s_tx_purge_pos;
+static volatile bool s_tx_purge = false;
+
+static inline size_t tx_ring_space(void) {
+    return UART_TX_RING_SIZE - (s_tx_head - __atomic_load_n(&s_tx_tail, __ATOMIC_ACQUIRE));
+}
+
+// [I/O 任务] 写入发送环，调用方已按剩余空间限制长度
+static void tx_ring_push(const uint8_t *data, size_t len) {
+    uint32_t head = s_tx_head;
+    size_t off = head & (UART_TX_RING_SIZE - 1);
+    size_t first = UART_TX_RING_SIZE - off;
+    if (first > len) first = len;
+    memcpy(s_tx_ring + off, data, first);
+    memcpy(s_tx_ring, data + first, len - first);
+    __atomic_store_n(&s_tx_head, head + (uint32_t)len, __ATOMIC_RELEASE);
+    xTaskNotifyGive(s_tx_task);
+}
+
+// [I/O 任务] 发送环剩余空间不足一个读写块时暂停下行读取，发送任务腾出空间后按门铃
+static bool tx_ring_paused(void) {
+    if (tx_ring_space() >= s_cfg.chunk_size) {
+        s_tx_full = false;
+        return false;
+    }
+    if (!s_tx_full) {
+        s_tx_full = true;
+        s_stats.dl_stalls++;
+    }
+    // 置位后再确认一次: 发送任务可能在置位之前已腾出空间，不会再按门铃
+    return tx_ring_space() < s_cfg.chunk_size;
+}
+
+#if RFC2217_PORT > 0
+// [I/O 任务] 把串口参数修改排在已入环的数据之后，队列满时返回 false (不修改)
+static bool uart_tx_reconfigure(const uart_config_t *cfg) {
+    uart_tx_cmd_t cmd = { .pos = s_tx_head, .cfg = *cfg };
+    if (xQueueSend(s_tx_cmd_queue, &cmd, 0) != pdTRUE) {
+        return false;
+    }
+    xTaskNotifyGive(s_tx_task);
+    return true;
+}
+
+// [I/O 任务] 丢弃发送环中尚未发出的数据；读位置归发送任务所有，由它执行
+static void uart_tx_purge(void) {
+    s_tx_purge_pos = s_tx_head;
+    __atomic_store_n(&s_tx_purge, true, __ATOMIC_RELEASE);
+    xTaskNotifyGive(s_tx_task);
+}
+#endif
+
+// 复位硬件发送 FIFO (驱动没有对应接口)；已拷入驱动发送缓冲区 (UART_TX_BUF_SIZE) 的数据仍会发出
+static void uart_tx_fifo_reset(void) {
+    volatile uart_dev_t *dev = UART_NUM == UART_NUM_0 ? &uart0 : &uart1;
+    portENTER_CRITICAL();
+    dev->conf0.txfifo_rst = 1;
+    dev->conf0.txfifo_rst = 0;
+    portEXIT_CRITICAL();
+}
+
+// [发送任务] 等此前的数据发完后应用新参数
+static void uart_tx_apply(const uart_tx_cmd_t *cmd) {
+    uart_wait_tx_done(UART_NUM, UART_TX_DRAIN_MS / portTICK_RATE_MS);
+    if (uart_param_config(UART_NUM, (uart_config_t *)&cmd->cfg) != ESP_OK) {
+        ESP_LOGW(TAG, "Unable to apply UART parameters");
+        return;
+    }
+    if ((uint32_t)cmd->cfg.baud_rate != s_baudrate) {
+        s_baudrate = cmd->cfg.baud_rate;
+        ESP_LOGI(TAG, "UART baud rate set to %u", (unsigned)s_baudrate);
+    }
+}
+
+static void uart_tx_task(void *arg) {
+    (void)arg;
+    while (1) {
+        uint32_t tail = s_tx_tail;
+        if (__atomic_load_n(&s_tx_purge, __ATOMIC_ACQUIRE)) {
+            s_tx_purge = false;
+            // 清空位置之后才入环的数据保留
+            if ((int32_t)(s_tx_purge_pos - tail) > 0) {
+                tail = s_tx_purge_pos;
+                __atomic_store_n(&s_tx_tail, tail, __ATOMIC_RELEASE);
+            }
+            uart_tx_fifo_reset();
+            if (s_tx_full) {
+                doorbell_ring();
+            }
+        }
+
+        // 到达排队命令的位置时先执行命令 (清空可能已越过该位置)，此前只发到该位置为止
+        uint32_t head = __atomic_load_n(&s_tx_head, __ATOMIC_ACQUIRE);
+        uart_tx_cmd_t cmd;
+        if (xQueuePeek(s_tx_cmd_queue, &cmd, 0) == pdTRUE) {
+            if ((int32_t)(cmd.pos - tail) <= 0) {
+                xQueueReceive(s_tx_cmd_queue, &cmd, 0);
+                uart_tx_apply(&cmd);
+                continue;
+            }
+            if (cmd.pos - tail < head - tail) head = cmd.pos;
+        }
+        if (head == tail) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        size_t off = tail & (UART_TX_RING_SIZE - 1);
+        size_t n = head - tail;
+        if (n > UART_TX_RING_SIZE - off) n = UART_TX_RING_SIZE - off;
+        // 拷入驱动发送缓冲区，缓冲区满时在这里阻塞，不影响 I/O 任务
+        uart_write_bytes(UART_NUM, (const char *)s_tx_ring + off, n);
+        __atomic_store_n(&s_tx_tail, tail + (uint32_t)n, __ATOMIC_RELEASE);
+
+        if (s_tx_full) {
+            doorbell_ring();
+        }
+    }
+}
+
+// ====================================================
+// 串口流控: 客户端积压超过高水位时向目标设备施加背压
+// 仅在有客户端在线时生效；离线时无人消费，仍按覆盖最旧数据处理
+// ====================================================
+static void flow_update(void) {
+#if BRIDGE_FLOW_CTRL != FLOW_CTRL_NONE
+    uint32_t backlog = s_client_count > 0 ? rb_head(&s_rb) - s_backlog_tail : 0;
+
+    if (!s_flow_paused && backlog >= FLOW_HIGH_WATER) {
+        s_flow_paused = true;
+#if BRIDGE_FLOW_CTRL == FLOW_CTRL_XONXOFF
+        const char xoff = XOFF_CHAR;
+        uart_write_bytes(UART_NUM, &xoff, 1);
+#endif
+        ESP_LOGW(TAG, "Backlog %u bytes, asserting flow control", (unsigned)backlog);
+    } else if (s_flow_paused && backlog <= FLOW_LOW_WATER) {
+        s_flow_paused = false;
+#if BRIDGE_FLOW_CTRL == FLOW_CTRL_XONXOFF
+        const char xon = XON_CHAR;
+        uart_write_bytes(UART_NUM, &xon, 1);
+#endif
+        ESP_LOGI(TAG, "Backlog drained, flow control released");
+    }
+#endif
+}
+
+#if BRIDGE_AUTOBAUD
+// 统计帧错误，窗口内超过阈值则切换到下一个候选波特率
+static void autobaud_on_frame_error(void) {
+    static int64_t window_start = 0;
+    static int errors = 0;
+    static int rate_idx = 0;
+
+    int64_t now = esp_timer_get_time();
+    if (now - window_start > AUTOBAUD_WINDOW_MS * 1000LL) {
+        window_start = now;
+        errors = 0;
+    }
+    if (++errors < AUTOBAUD_ERR_THRESH) return;
+
+    rate_idx = (rate_idx + 1) % (sizeof(s_autobaud_rates) / sizeof(s_autobaud_rates[0]));
+    ESP_LOGW(TAG, "Too many frame errors, trying %u baud", (unsigned)s_autobaud_rates[rate_idx]);
+    tcp_bridge_set_baudrate(s_autobaud_rates[rate_idx]);
+    uart_flush_input(UART_NUM);
+    window_start = now;
+    errors = 0;
+}
+#endif
+
+esp_err_t tcp_bridge_set_baudrate(uint32_t baud) {
+    esp_err_t err = uart_set_baudrate(UART_NUM, baud);
+    if (err == ESP_OK) {
+        s_baudrate = baud;
+        s_uart_config.baud_rate = baud;
+        ESP_LOGI(TAG, "UART baud rate set to %u", (unsigned)baud);
+    }
+    return err;
+}
+
+uint32_t tcp_bridge_get_baudrate(void) {
+    return s_baudrate;
+}
+
+// ====================================================
+// 采集时间索引: 记录每批串口数据在环形缓冲区中的结束位置与读出时间
+// 单生产者 (守护任务) 写入，I/O 任务查询；条目先于数据发布，查询时数据必然已有索引
+// ====================================================
+typedef struct {
+    uint32_t end;     // 该批数据之后的位置 (环形缓冲区绝对位置)
+    uint32_t ts_lo;   // 采集时间低 32 位 (微秒)
+} ts_entry_t;
+
+static ts_entry_t s_ts_index[TS_INDEX_SIZE];
+static volatile uint32_t s_ts_count = 0;  // 已写入的条目数 (自由递增)
+
+// 写入一批串口数据并记录其采集时间
+static void capture_publish(const uint8_t *data, size_t len, int64_t now) {
+    uint32_t end = rb_head(&s_rb) + (uint32_t)len;
+
+    // 以最慢客户端的读位置估算积压与覆盖 (I/O 任务每轮发布一次，可能略微滞后)
+    if (s_client_count > 0) {
+        uint32_t backlog = end - s_backlog_tail;
+        if (backlog > s_rb.size) {
+            uint32_t over = backlog - s_rb.size;
+            s_stats.rb_overwritten += over < len ? over : (uint32_t)len;
+            backlog = s_rb.size;
+        }
+        if (backlog > s_stats.rb_high_water) s_stats.rb_high_water = backlog;
+    }
+
+    uint32_t n = s_ts_count;
+    ts_entry_t *last = &s_ts_index[(n - 1) & (TS_INDEX_SIZE - 1)];
+
+    if (n > 0 && last->ts_lo == (uint32_t)now) {
+        // 同一次读取分多段写入，合并为一条 (单次 32 位写入，查询方最多看到旧的结束位置)
+        last->end = end;
+    } else {
+        ts_entry_t *e = &s_ts_index[n & (TS_INDEX_SIZE - 1)];
+        e->end = end;
+        e->ts_lo = (uint32_t)now;
+        __atomic_store_n(&s_ts_count, n + 1, __ATOMIC_RELEASE);
+    }
+    rb_write(&s_rb, data, len);
+}
+
+// 查询位置 pos 处字节的采集时间与所在批次的结束位置
+// 返回 false 表示索引已被覆盖，*ts 为近似值 (取仍在索引中的最早一批)
+static bool ts_index_lookup(uint32_t pos, int64_t *ts, uint32_t *end) {
+    uint32_t n = __atomic_load_n(&s_ts_count, __ATOMIC_ACQUIRE);
+    int64_t now = esp_timer_get_time();
+    if (n == 0) {
+        *ts = now;
+        *end = pos;
+        return false;
+    }
+
+    // 条目结束位置单调递增，二分查找第一个 end > pos 的条目
+    uint32_t lo = n > TS_INDEX_SIZE ? n - TS_INDEX_SIZE : 0;
+    uint32_t hi = n - 1;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if ((int32_t)(s_ts_index[mid & (TS_INDEX_SIZE - 1)].end - pos) > 0) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+
+    ts_entry_t e = s_ts_index[lo & (TS_INDEX_SIZE - 1)];
+    uint32_t n2 = __atomic_load_n(&s_ts_count, __ATOMIC_ACQUIRE);
+
+    // 由低 32 位恢复完整时间 (要求数据滞留不超过约 71 分钟)
+    *ts = now - (int64_t)(uint32_t)((uint32_t)now - e.ts_lo);
+    *end = e.end;
+
+    // 最早的条目缺少前驱，无法确认 pos 落在其中；查询期间条目被改写同样视为近似
+    bool oldest = n > TS_INDEX_SIZE && lo == n - TS_INDEX_SIZE;
+    return !oldest && n2 - lo < TS_INDEX_SIZE;
+}
+
+#if BRIDGE_TX_ZEROCOPY
+// 写入前确认不会覆盖协议栈仍在引用的数据，否则等待对端确认
+// 驱动层接收缓冲区在此期间继续收数据；等待过久则由 I/O 任务断开被钉住的连接
+static void zc_wait_space(size_t len) {
+    int waited_ms = 0;
+    while (s_zc_pinned && rb_space(&s_rb, s_zc_pin) < len) {
+        s_zc_waiting = true;
+        if (waited_ms >= ZC_PIN_WAIT_MS && !s_zc_break) {
+            ESP_LOGW(TAG, "Cache pinned by unacked data for %d ms", waited_ms);
+            s_zc_break = true;
+        }
+        // I/O 任务刷新确认位置后通知
+        doorbell_ring();
+        ulTaskNotifyTake(pdTRUE, 1);
+        waited_ms += portTICK_RATE_MS;
+    }
+    s_zc_waiting = false;
+}
+#endif
+
+// 过滤器输出回调: 按读写块大小分段写入缓存，保持每次写入不超过一块
+// 行模式下积存的行在判定时才写入，其采集时间为判定时刻
+static void filter_emit(void *ctx, const uint8_t *data, size_t len) {
+    int64_t now = *(const int64_t *)ctx;
+    while (len > 0) {
+        size_t n = len > s_cfg.chunk_size ? s_cfg.chunk_size : len;
+#if BRIDGE_TX_ZEROCOPY
+        zc_wait_space(n);
+#endif
+        capture_publish(data, n, now);
+        data += n;
+        len -= n;
+    }
+}
+
+// 串口数据经过滤器写入缓存
+static void filter_publish(const uint8_t *data, size_t len, int64_t now) {
+    uint32_t matches = s_filter.matches;
+    s_stats.filter_out += uart_filter_feed(&s_filter, data, len, filter_emit, &now);
+    s_stats.filter_matches += s_filter.matches - matches;
+}
+
+// 按已保存的配置重建过滤器 (模式只在配置修改时编译一次)
+static void filter_reload(void) {
+    bridge_config_t cfg;
+    s_filter_pending = false;
+    tcp_bridge_get_config(&cfg);
+
+    uart_filter_deinit(&s_filter);
+    if (!uart_filter_init(&s_filter, cfg.filter_mode, cfg.filter_patterns, cfg.filter_context)) {
+        ESP_LOGE(TAG, "Unable to build UART filter, filtering disabled");
+        return;
+    }
+    if (cfg.filter_mode != UART_FILTER_OFF) {
+        ESP_LOGI(TAG, "UART filter: %s '%s' (%d DFA states)",
+                 bridge_config_filter_name(cfg.filter_mode), cfg.filter_patterns, s_filter.num_states);
+    }
+}
+
+// 守护任务与 spool 任务访问缓存前调用: 有调整请求时暂停，直到 I/O 任务完成调整
+static void rb_park_point(void) {
+    if (!s_rb_resize_req) return;
+    xSemaphoreGive(s_rb_parked);
+    while (s_rb_resize_req) {
+        ulTaskNotifyTake(pdTRUE, 10 / portTICK_RATE_MS);
+    }
+}
+
+// ====================================================
+// 守护任务: 持续从串口读取数据到环形缓冲区
+// 即使没有 TCP 连接，这个任务也在后台运行
+// ====================================================
+static void uart_rx_daemon_task(void *arg) {
+    (void)arg;
+    uint8_t *tmp_buf = s_uart_buf;
+
+    ESP_LOGI(TAG, "UART Capture Daemon Started (Cache: %u bytes)", (unsigned)s_rb.size);
+
+    uart_event_t event;
+    while (1) {
+#if BRIDGE_FLOW_CTRL == FLOW_CTRL_RTSCTS
+        // 背压期间停止读取驱动缓冲区: 驱动缓冲区满后关闭接收中断，
+        // 硬件 FIFO 随之填满并拉高 RTS，目标设备暂停发送
+        while (s_flow_paused) {
+            ulTaskNotifyTake(pdTRUE, 100 / portTICK_RATE_MS);
+            flow_update();
+        }
+#endif
+
+        // 阻塞等待驱动事件: FIFO 满或 RX 超时 (线路空闲) 时由中断投递
+        if (!xQueueReceive(s_uart_queue, (void *)&event, portMAX_DELAY)) {
+            continue;
+        }
+        rb_park_point();
+        tmp_buf = s_uart_buf;  // 读写块大小可能刚被调整
+        if (s_filter_pending) {
+            filter_reload();
+        }
+
+        switch (event.type) {
+            case UART_DATA: {
+                int64_t now = esp_timer_get_time();
+
+                // 连同背压期间积存、或因事件队列溢出而漏报的数据一并读出
+                size_t remain = event.size;
+                size_t buffered = 0;
+                if (uart_get_buffered_data_len(UART_NUM, &buffered) == ESP_OK && buffered > remain) {
+                    remain = buffered;
+                }
+                while (remain > 0) {
+                    int len = uart_read_bytes(UART_NUM, tmp_buf,
+                                              remain > s_cfg.chunk_size ? s_cfg.chunk_size : remain, 0);
+                    if (len <= 0) break;
+                    s_stats.uart_rx_bytes += len;
+                    filter_publish(tmp_buf, len, now);
+                    remain -= len;
+                }
+                s_last_rx_us = now;
+
+                // 驱动在 FIFO 满或 RX 超时时投递 UART_DATA
+                // 不足 FIFO 阈值的事件只可能来自 RX 超时，即线路已空闲
+                if (event.size < UART_RXFIFO_FULL_THRESH) {
+                    s_line_idle_cnt++;
+                }
+
+                // 唤醒 I/O 任务
+                doorbell_ring();
+                flow_update();
+                break;
+            }
+
+            case UART_BUFFER_FULL:
+                s_stats.uart_buffer_full++;
+#if BRIDGE_FLOW_CTRL == FLOW_CTRL_RTSCTS
+                // 硬件流控下这是背压的正常状态，数据仍留在 FIFO 中，下次读取时恢复
+                break;
+#endif
+                // fall through
+            case UART_FIFO_OVF:
+                if (event.type == UART_FIFO_OVF) s_stats.uart_fifo_ovf++;
+                // 驱动已丢弃数据，清空后继续接收
+                ESP_LOGW(TAG, "UART overflow (event %d), input flushed", event.type);
+                uart_flush_input(UART_NUM);
+                xQueueReset(s_uart_queue);
+                break;
+
+            case UART_FRAME_ERR:
+                s_stats.uart_frame_err++;
+#if BRIDGE_AUTOBAUD
+                autobaud_on_frame_error();
+#endif
+                // fall through
+            case UART_PARITY_ERR:
+                if (event.type == UART_PARITY_ERR) s_stats.uart_parity_err++;
+                ESP_LOGW(TAG, "UART line error (event %d)", event.type);
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+// ====================================================
+// 上行合包: 决定何时把某个客户端游标之后的数据交给 send()
+// ====================================================
+static void hold_timer_cb(void *arg) {
+    (void)arg;
+    doorbell_ring();
+}
+
+#if COALESCE_DELIMITER >= 0
+// 扫描新到达的数据，返回截至最后一个分隔符 (含) 的字节数
+static size_t coalesce_scan_delimiter(bridge_client_t *c, size_t avail) {
+    coalesce_state_t *cs = &c->cs;
+    uint32_t tail = c->reader.tail;
+
+    // 读位置可能因缓存溢出而跳跃，扫描进度不能落后于它
+    if ((int32_t)(cs->scan_pos - tail) < 0) cs->scan_pos = tail;
+    if ((int32_t)(cs->delim_end - tail) < 0) cs->delim_end = tail;
+
+    size_t off = cs->scan_pos - tail;
+    while (off < avail) {
+        const uint8_t *data;
+        size_t span = rb_peek_at(&s_rb, &c->reader, off, &data);
+        if (span == 0) break;
+        if (span > avail - off) span = avail - off;
+
+        const uint8_t *p = data;
+        const uint8_t *end = data + span;
+        while ((p = memchr(p, COALESCE_DELIMITER, end - p)) != NULL) {
+            p++;
+            cs->delim_end = tail + off + (p - data);
+        }
+        off += span;
+    }
+    cs->scan_pos = tail + off;
+
+    return cs->delim_end - tail;
+}
+#endif
+
+// 返回应立即发送的字节数，0 表示继续攒包，此时 *wait_us 为距强制发送的剩余时间
+static size_t coalesce_ready(bridge_client_t *c, size_t avail, int64_t *wait_us) {
+    coalesce_state_t *cs = &c->cs;
+    *wait_us = 0;
+
+    if (cs->hold_start_us == 0) {
+        cs->hold_start_us = s_last_rx_us;
+    }
+
+    // 1. 攒够一个 MSS
+    if (avail >= COALESCE_MAX_BYTES) {
+        return COALESCE_MAX_BYTES;
+    }
+
+#if COALESCE_FLUSH_ON_IDLE
+    // 2. 线路空闲，对端这一批数据已发完
+    uint32_t idle = s_line_idle_cnt;
+    if (idle != cs->idle_seen) {
+        cs->idle_seen = idle;
+        return avail;
+    }
+#endif
+
+#if COALESCE_DELIMITER >= 0
+    // 3. 出现分隔符
+    size_t cut = coalesce_scan_delimiter(c, avail);
+    if (cut > 0) {
+        return cut;
+    }
+#endif
+
+    // 4. 最早的字节已滞留过久
+    int64_t held = esp_timer_get_time() - cs->hold_start_us;
+    if (held >= COALESCE_HOLD_US) {
+        return avail;
+    }
+    *wait_us = COALESCE_HOLD_US - held;
+    return 0;
+}
+
+// send() 并计入发送统计 (仅 I/O 任务调用)，返回值与 errno 同 send()
+static int bridge_send(int sock, const void *data, size_t len, int flags) {
+    int sent = send(sock, data, len, flags);
+    if (sent < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) s_stats.tx_eagain++;
+    } else {
+        s_stats.tx_bytes += sent;
+        s_stats.tx_segments++;
+        if ((size_t)sent < len) s_stats.tx_partial++;
+    }
+    return sent;
+}
+
+// 补发 0xFF 转义的第二个字节，返回 1 已发出 / 0 发送缓冲区满 / -1 socket 出错
+static int flush_iac(bridge_client_t *c) {
+    static const uint8_t iac = TELNET_IAC;
+    int sent = bridge_send(c->sock, &iac, 1, 0);
+    if (sent < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+        ESP_LOGE(TAG, "Client %s send failed (errno: %d)", c->addr, errno);
+        return -1;
+    }
+    c->iac_pending = false;
+    return 1;
+}
+
+// 发送待发的 Telnet 协商 / 命令应答，发送缓冲区满时保留到下次，返回 false 表示 socket 出错
+static bool client_flush_reply(bridge_client_t *c) {
+    // 上行转义序列必须先补全，否则应答会被拼进 IAC IAC 中
+    if (c->iac_pending) {
+        int r = flush_iac(c);
+        if (r < 0) return false;
+        if (r == 0) {
+            c->want_write = true;
+            return true;
+        }
+    }
+    if (c->tn.reply_len == 0) return true;
+
+    int sent = bridge_send(c->sock, c->tn.reply, c->tn.reply_len, 0);
+    if (sent < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) return false;
+        sent = 0;
+    }
+    c->tn.reply_len -= sent;
+    memmove(c->tn.reply, c->tn.reply + sent, c->tn.reply_len);
+    if (c->tn.reply_len > 0) c->want_write = true;
+    return true;
+}
+
+// 从环形缓冲区直接发送 len 字节 (最多两段)
+// RFC 2217 客户端在每个 0xFF 处截断分段并补发一个 0xFF，数据本身仍不拷贝
+// 返回实际发送的缓存字节数 (socket 发送缓冲区满时可能不足 len)，-1 表示 socket 出错
+static int send_from_ring(bridge_client_t *c, size_t len) {
+    bool telnet = c->proto == BRIDGE_PROTO_RFC2217;
+    size_t total = 0;
+    while (total < len) {
+        if (c->iac_pending) {
+            int r = flush_iac(c);
+            if (r < 0) return -1;
+            if (r == 0) break;
+        }
+
+        const uint8_t *data;
+        size_t span = rb_peek(&s_rb, &c->reader, &data);
+        if (span == 0) break;
+        if (span > len - total) span = len - total;
+
+        // 环绕处的前半段带 MSG_MORE，让协议栈与后半段合成一个报文
+        int flags = span < len - total ? MSG_MORE : 0;
+        bool ends_iac = false;
+        if (telnet) {
+            const uint8_t *ff = memchr(data, TELNET_IAC, span);
+            if (ff) {
+                span = ff - data + 1;
+                flags = MSG_MORE;
+                ends_iac = true;
+            }
+        }
+
+        int sent = bridge_send(c->sock, data, span, flags);
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            ESP_LOGE(TAG, "Client %s send failed (errno: %d)", c->addr, errno);
+            return -1;
+        }
+        if (!rb_commit(&s_rb, &c->reader, sent)) {
+            ESP_LOGW(TAG, "Cache overrun while sending, %d bytes may be corrupted", sent);
+        }
+        total += sent;
+        if ((size_t)sent < span) break;
+        if (ends_iac) c->iac_pending = true;
+    }
+    if (c->iac_pending && flush_iac(c) < 0) {
+        return -1;
+    }
+    return total;
+}
+
+static void client_close(int slot);
+
+#if BRIDGE_TX_ZEROCOPY
+// ====================================================
+// 零拷贝发送: 一次 tcpip 线程往返把最多两段缓存区间挂到发送队列，不经 pbuf 拷贝 (见 bridge_zerocopy.h)
+// 入队的区间在重传时还会被读取，直到对端确认前都由 pin 保护
+// ====================================================
+// 汇总所有零拷贝客户端的 pin，供守护任务写入前检查
+static void zc_publish_pin(void) {
+    bool pinned = false;
+    uint32_t pin = 0;
+    for (int i = 0; i < BRIDGE_MAX_CLIENTS; i++) {
+        bridge_client_t *c = s_clients[i];
+        if (!c || !c->zc_pinned) continue;
+        if (!pinned || (int32_t)(c->zc_acked - pin) < 0) {
+            pin = c->zc_acked;
+            pinned = true;
+        }
+    }
+    s_zc_pin = pin;
+    s_zc_pinned = pinned;
+}
+
+// 查询确认进度 (len 为 0 的写入)，返回 false 表示连接已断开
+static bool zc_refresh(bridge_client_t *c) {
+    static const uint8_t *const none[2] = { NULL, NULL };
+    static const size_t zero[2] = { 0, 0 };
+    uint32_t inflight;
+    if (bridge_zc_write(c->zc_conn, none, zero, &inflight) < 0) return false;
+    c->zc_acked = c->reader.tail - inflight;
+    c->zc_pinned = inflight > 0;
+    return true;
+}
+
+// 丢弃协议栈中仍引用缓存的数据，关闭零拷贝客户端前调用
+static void zc_abort(bridge_client_t *c) {
+    bridge_zc_abort(c->zc_conn);
+    c->zc_pinned = false;
+}
+
+// 零拷贝发送最多 len 字节，返回值同 send_from_ring
+static int zc_send(bridge_client_t *c, size_t len) {
+    // 先钉住待发区间再取数据: 之后的写入不会越过它，之前已开始的写入由 rb_commit 检出
+    rb_available(&s_rb, &c->reader);
+    if (!c->zc_pinned) {
+        c->zc_acked = c->reader.tail;
+        c->zc_pinned = true;
+        zc_publish_pin();
+    }
+
+    const uint8_t *data[2] = { NULL, NULL };
+    size_t spans[2] = { 0, 0 };
+    size_t got = 0;
+    for (int i = 0; i < 2 && got < len; i++) {
+        size_t span = rb_peek_at(&s_rb, &c->reader, got, &data[i]);
+        if (span == 0) break;
+        if (span > len - got) span = len - got;
+        spans[i] = span;
+        got += span;
+    }
+
+    uint32_t inflight;
+    int written = bridge_zc_write(c->zc_conn, data, spans, &inflight);
+    if (written < 0) {
+        ESP_LOGE(TAG, "Client %s zero-copy write failed", c->addr);
+        return -1;
+    }
+    if (written > 0) {
+        s_stats.tx_bytes += written;
+        s_stats.tx_segments++;
+        if ((size_t)written < got) s_stats.tx_partial++;
+    } else if (got > 0) {
+        s_stats.tx_eagain++;
+    }
+    if (!rb_commit(&s_rb, &c->reader, written)) {
+        ESP_LOGW(TAG, "Cache overrun while sending, %d bytes may be corrupted", written);
+    }
+    c->zc_acked = c->reader.tail - inflight;
+    c->zc_pinned = inflight > 0;
+    zc_publish_pin();
+    return written;
+}
+
+// 每轮 I/O 之后: 守护任务在等待时刷新确认进度，等待超时则断开被钉住的连接
+static void zc_service(void) {
+    if (!s_zc_waiting) return;
+
+    bool broken = s_zc_break;
+    for (int i = 0; i < BRIDGE_MAX_CLIENTS; i++) {
+        bridge_client_t *c = s_clients[i];
+        if (!c || !c->zc_pinned) continue;
+        if (broken || !zc_refresh(c)) {
+            ESP_LOGW(TAG, "Client %s not acknowledging, connection dropped", c->addr);
+            client_close(i);
+        }
+    }
+    s_zc_break = false;
+    zc_publish_pin();
+}
+#endif
+
+static inline bool client_framed(const bridge_client_t *c) {
+    return c->proto == BRIDGE_PROTO_FRAMED || c->proto == BRIDGE_PROTO_FRAMED_LZ;
+}
+
+// 是否有协议层的字节 (转义、帧头、填充) 尚未发出
+static bool client_tx_pending(const bridge_client_t *c) {
+#if TLS_PORT > 0
+    if (c->tls_unsent > 0) return true;
+#endif
+    return c->iac_pending || bridge_framer_pending(&c->fr);
+}
+
+#if FRAMED_LZ_PORT > 0 || TLS_PORT > 0 || UDP_UPLINK_PORT > 0
+// 从读位置拷出最多 n 字节到 dst 并提交
+// 返回取出的字节数，0 表示拷贝期间发生覆盖，数据已计入丢失，由随后的 GAP 记录声明
+static size_t ring_copy_out(bridge_client_t *c, uint8_t *dst, size_t n) {
+    uint32_t lost_before = c->reader.lost;
+    size_t got = 0;
+    while (got < n) {
+        const uint8_t *data;
+        size_t span = rb_peek_at(&s_rb, &c->reader, got, &data);
+        if (span == 0) break;
+        if (span > n - got) span = n - got;
+        memcpy(dst + got, data, span);
+        got += span;
+    }
+    if (c->reader.lost != lost_before || got == 0) return 0;
+
+    if (!rb_commit(&s_rb, &c->reader, got)) {
+        c->reader.lost += got;
+        return 0;
+    }
+    return got;
+}
+#endif
+
+// 以 0 填充被覆盖的 DATA 负载
+static const uint8_t s_zero_fill[64];
+
+// 分帧发送最多 len 字节缓存数据，每条 DATA 记录不跨越采集批次，保证时间戳精确
+// 帧头可能只发出一部分，剩余部分保存在会话中，下次继续发送
+// 返回实际发送的缓存字节数，-1 表示 socket 出错
+static int send_framed(bridge_client_t *c, size_t len) {
+    bridge_framer_t *f = &c->fr;
+    size_t total = 0;
+
+    while (1) {
+        // 1. 补发未完成的帧头 / 压缩记录
+        if (f->pend_sent < f->pend_len) {
+            int sent = bridge_send(c->sock, f->pend + f->pend_sent, f->pend_len - f->pend_sent,
+                            f->frame_remain > 0 ? MSG_MORE : 0);
+            if (sent < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                ESP_LOGE(TAG, "Client %s send failed (errno: %d)", c->addr, errno);
+                return -1;
+            }
+            f->pend_sent += sent;
+            if (f->pend_sent < f->pend_len) break;
+            continue;
+        }
+
+        // 2. 发送当前 DATA 记录的负载
+        if (f->frame_remain > 0) {
+            const uint8_t *data = s_zero_fill;
+            size_t span = sizeof(s_zero_fill);
+            if (!f->frame_filler) {
+                uint32_t lost_before = c->reader.lost;
+                span = rb_peek(&s_rb, &c->reader, &data);
+                uint32_t jumped = c->reader.lost - lost_before;
+                if (jumped > 0) {
+                    // 帧头已声明的字节被覆盖: 本条记录剩余部分以 0 补齐，
+                    // 读位置跳过与之重叠的范围，全部计入随后的 GAP 记录
+                    uint32_t skip = jumped > f->frame_remain ? jumped : f->frame_remain;
+                    c->reader.tail = c->reader.tail - jumped + skip;
+                    c->reader.lost = lost_before + skip;
+                    f->frame_filler = true;
+                    data = s_zero_fill;
+                    span = sizeof(s_zero_fill);
+                }
+            }
+            if (span == 0) break;
+            if (span > f->frame_remain) span = f->frame_remain;
+
+            bool more = span < f->frame_remain || total + span < len;
+            int sent = bridge_send(c->sock, data, span, more ? MSG_MORE : 0);
+            if (sent < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                ESP_LOGE(TAG, "Client %s send failed (errno: %d)", c->addr, errno);
+                return -1;
+            }
+            if (!f->frame_filler) {
+                if (!rb_commit(&s_rb, &c->reader, sent)) {
+                    ESP_LOGW(TAG, "Cache overrun while sending, %d bytes may be corrupted", sent);
+                }
+                total += sent;
+            }
+            f->frame_remain -= sent;
+            if (f->frame_remain == 0) f->frame_filler = false;
+            if ((size_t)sent < span) break;
+            continue;
+        }
+
+        // 3. 有未声明的丢失，先发 GAP 记录
+        if (bridge_framer_gap(f, c->reader.tail, c->reader.lost)) {
+            continue;
+        }
+
+#if AUX_UART_NUM > 0
+        // 附加通道的记录插在 UART0 的记录之间发送 (数据量小，不参与合包)
+        const uint8_t *aux_rec;
+        size_t aux_len = bridge_aux_next_record(&c->aux, &aux_rec);
+        if (aux_len > 0) {
+            bridge_framer_queue(f, aux_rec, aux_len);
+            continue;
+        }
+#endif
+
+        // 4. 开始新的 DATA 记录
+        if (total >= len) break;
+        size_t avail = rb_available(&s_rb, &c->reader);
+        if (c->reader.lost != f->lost_gapped) continue;
+        if (avail == 0) break;
+
+        size_t n = len - total;
+        if (n > avail) n = avail;
+
+        int64_t ts;
+        uint32_t batch_end;
+        uint8_t flags = 0;
+        if (!ts_index_lookup(c->reader.tail, &ts, &batch_end)) {
+            flags |= BRIDGE_FRAME_F_TS_APPROX;
+        }
+
+#if FRAMED_LZ_PORT > 0
+        if (c->proto == BRIDGE_PROTO_FRAMED_LZ) {
+            // 压缩记录跨越多个采集批次 (批次太小压缩无效)，时间戳为首字节的采集时间
+            if (n > LZ_CHUNK_MAX) n = LZ_CHUNK_MAX;
+            uint32_t offset = c->reader.tail;
+            size_t got = ring_copy_out(c, bridge_framer_lz_input(), n);
+            if (got > 0) {
+                bridge_framer_lz(f, got, flags, offset, ts);
+                total += got;
+            }
+            continue;
+        }
+#endif
+
+        uint32_t batch_len = batch_end - c->reader.tail;
+        if ((int32_t)batch_len > 0 && batch_len < n) n = batch_len;
+        if (n > 0xFFFF) n = 0xFFFF;
+
+        bridge_framer_data(f, flags, (uint16_t)n, c->reader.tail, ts);
+    }
+    return total;
+}
+
+#if TLS_PORT > 0
+// ====================================================
+// TLS: 非阻塞 socket 上的 mbedTLS 会话，收发回调直接使用会话的 socket
+// ====================================================
+static uint8_t *s_tls_plain;  // 待加密的明文 (mbedTLS 要求 WANT_WRITE 后以相同参数重试)
+
+static int tls_bio_send(void *ctx, const unsigned char *buf, size_t len) {
+    bridge_client_t *c = (bridge_client_t *)ctx;
+    int sent = bridge_send(c->sock, buf, len, 0);
+    if (sent < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK ? MBEDTLS_ERR_SSL_WANT_WRITE :
+                                                         MBEDTLS_ERR_NET_SEND_FAILED;
+    }
+    return sent;
+}
+
+static int tls_bio_recv(void *ctx, unsigned char *buf, size_t len) {
+    bridge_client_t *c = (bridge_client_t *)ctx;
+    int n = recv(c->sock, buf, len, 0);
+    if (n < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK ? MBEDTLS_ERR_SSL_WANT_READ :
+                                                         MBEDTLS_ERR_NET_RECV_FAILED;
+    }
+    return n;  // 0 表示对端关闭
+}
+
+// 推进握手，返回 false 表示握手失败需要关闭连接
+static bool tls_handshake(bridge_client_t *c) {
+    int ret = mbedtls_ssl_handshake(c->tls);
+    if (ret == MBEDTLS_ERR_SSL_WANT_READ) return true;
+    if (ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
+        c->want_write = true;
+        return true;
+    }
+    if (ret != 0) {
+        ESP_LOGW(TAG, "Client %s TLS handshake failed (-0x%04x)", c->addr, -ret);
+        return false;
+    }
+    c->tls_ready = true;
+    ESP_LOGI(TAG, "Client %s TLS established in %u ms (%s, %s)", c->addr,
+             (unsigned)((esp_timer_get_time() - c->connected_us) / 1000),
+             mbedtls_ssl_get_ciphersuite(c->tls), bridge_tls_resumed() ? "resumed" : "full handshake");
+    return true;
+}
+
+// 加密发送最多 len 字节缓存数据，每条记录不超过 BRIDGE_TLS_RECORD_MAX
+// 明文拷出后即提交读位置，记录未发完时保留在 mbedTLS 的发送缓冲区中
+// 返回取出的缓存字节数，-1 表示连接出错
+static int send_tls(bridge_client_t *c, size_t len) {
+    size_t total = 0;
+
+    while (1) {
+        if (c->tls_unsent == 0) {
+            if (total >= len) break;
+            size_t n = len - total;
+            if (n > BRIDGE_TLS_RECORD_MAX) n = BRIDGE_TLS_RECORD_MAX;
+            size_t got = ring_copy_out(c, s_tls_plain, n);
+            if (got == 0) break;  // 拷贝期间被覆盖，已计入丢失
+            total += got;
+            c->tls_unsent = (uint16_t)got;
+        }
+
+        int ret = mbedtls_ssl_write(c->tls, s_tls_plain, c->tls_unsent);
+        if (ret == MBEDTLS_ERR_SSL_WANT_WRITE || ret == MBEDTLS_ERR_SSL_WANT_READ) break;
+        if (ret < 0) {
+            ESP_LOGE(TAG, "Client %s TLS write failed (-0x%04x)", c->addr, -ret);
+            return -1;
+        }
+        c->tls_unsent = 0;
+    }
+    return total;
+}
+
+// 同一地址重连时替换旧的 TLS 会话 (漫游)，否则只有会话上下文空闲才接受
+static bool tls_claim(const char *addr) {
+#if PREEMPT_SAME_HOST
+    for (int i = 0; i < BRIDGE_MAX_CLIENTS; i++) {
+        bridge_client_t *c = s_clients[i];
+        if (c && c->tls && strcmp(c->addr, addr) == 0) {
+            ESP_LOGW(TAG, "TLS client %s replaced by new connection", c->addr);
+            client_close(i);
+        }
+    }
+#endif
+    return bridge_tls_available();
+}
+#endif
+
+#if BRIDGE_SPOOL
+// ====================================================
+// Flash 离线缓存: 后台任务以独立读游标跟随环形缓冲区，批量写入 spool 分区
+// 只在数据可能送不到客户端时写入，以节省 Flash 擦写次数
+// ====================================================
+// 是否需要写入 Flash: 没有客户端，或最慢的客户端积压过多 (I/O 任务每轮发布一次读位置)
+static bool spool_needed(void) {
+    if (s_client_count == 0) return true;
+    return rb_head(&s_rb) - s_backlog_tail >= SPOOL_BEHIND_THRESH;
+}
+
+static void spool_task(void *arg) {
+    (void)arg;
+    rb_reader_t reader;
+    rb_reader_init(&reader, rb_head(&s_rb));
+    uint32_t lost_reported = 0;
+
+    while (1) {
+        vTaskDelay(SPOOL_FLUSH_MS / portTICK_RATE_MS);
+        rb_park_point();
+
+        if (!spool_needed()) {
+            // 数据即将送达客户端，游标直接跟到写位置；断开或落后后从这里接着写
+            // (Flash 中留下的空洞在补发时自动跳过，这段数据客户端已经收到)
+            reader.tail = rb_head(&s_rb);
+            continue;
+        }
+
+        size_t n;
+        while ((n = rb_read(&s_rb, &reader, s_spool_buf, s_cfg.chunk_size)) > 0) {
+            // 读出的数据紧邻新的读位置之前
+            bridge_spool_append(reader.tail - n + s_spool_base, s_spool_buf, n);
+        }
+
+        if (reader.lost != lost_reported) {
+            ESP_LOGW(TAG, "Spool fell behind, %u bytes not persisted",
+                     (unsigned)(reader.lost - lost_reported));
+            lost_reported = reader.lost;
+        }
+    }
+}
+
+// 首个客户端连接时确定补发范围: 从尚未投递的位置到 RAM 缓存中仍有效的最早位置
+static void spool_replay_start(bridge_client_t *c) {
+    // 同步读游标; 被覆盖的部分改由 Flash 补发，不计为丢失
+    rb_available(&s_rb, &c->reader);
+    c->reader.lost = 0;
+
+    uint32_t from = s_delivered_pos + s_spool_base;
+    if (!s_boot_replayed) {
+        // 启动后的第一个客户端，连同上次运行 (可能正是崩溃前) 的最后一段数据
+        from = s_spool_base - SPOOL_BOOT_REPLAY_MAX;
+        s_boot_replayed = true;
+    }
+    uint32_t end = c->reader.tail + s_spool_base;
+    if ((int32_t)(end - from) <= 0) return;
+
+    c->replaying = true;
+    c->replay_pos = from;
+    c->replay_end = end;
+    ESP_LOGI(TAG, "Client %s: replaying up to %u bytes from flash spool", c->addr,
+             (unsigned)(end - from));
+}
+
+// 从 Flash 补发历史数据，返回 false 表示 socket 出错
+static bool spool_replay(bridge_client_t *c) {
+    while ((int32_t)(c->replay_end - c->replay_pos) > 0) {
+        uint32_t pos = c->replay_pos;
+        size_t n = bridge_spool_read(&pos, s_net_buf, s_cfg.chunk_size);
+        if (n == 0 || (int32_t)(c->replay_end - pos) <= 0) break;
+        if (n > c->replay_end - pos) n = c->replay_end - pos;
+        c->replay_pos = pos;
+
+        int sent = bridge_send(c->sock, s_net_buf, n, 0);
+        if (sent < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                ESP_LOGE(TAG, "Client %s send failed (errno: %d)", c->addr, errno);
+                return false;
+            }
+            sent = 0;
+        }
+        c->replay_pos += sent;
+        if ((size_t)sent < n) {
+            c->want_write = true;
+            return true;
+        }
+    }
+
+    c->replaying = false;
+    ESP_LOGI(TAG, "Client %s: flash spool replay done", c->addr);
+    return true;
+}
+#endif
+
+#if UDP_UPLINK_PORT > 0
+// ====================================================
+// UDP / 组播上行: I/O 任务以独立读游标跟随环形缓冲区，每个合包组成一个数据报
+// socket 与数据报的发送见 bridge_udp.h
+// ====================================================
+static bridge_client_t s_udp;      // 复用会话的读游标与合包状态，不占用会话槽位
+
+static bool udp_uplink_init(void) {
+    if (!bridge_udp_init(UDP_UPLINK_ADDR, UDP_UPLINK_PORT, UDP_MULTICAST_TTL,
+                         BRIDGE_FRAME_HDR_LEN + COALESCE_MAX_BYTES)) {
+        return false;
+    }
+    // 与新客户端一样从尚未投递的位置开始
+    strcpy(s_udp.addr, "udp");
+    rb_reader_init(&s_udp.reader, s_delivered_pos);
+    s_udp.cs.idle_seen = s_line_idle_cnt;
+    s_udp.cs.scan_pos = s_udp.reader.tail;
+    s_udp.cs.delim_end = s_udp.reader.tail;
+    s_udp_active = true;
+    return true;
+}
+
+// 发出待发的数据报并计入统计，返回 false 表示协议栈暂时无法发送，稍后重试
+static bool udp_flush(void) {
+    int sent = bridge_udp_flush();
+    if (sent < 0) {
+        s_stats.tx_eagain++;
+        return false;
+    }
+    if (sent > 0) {
+        s_stats.tx_bytes += sent;
+        s_stats.tx_segments++;
+#if BRIDGE_BENCH
+        s_bench_sent += sent;
+#endif
+    }
+    return true;
+}
 
-// === 环形缓冲区结构 ===
-typedef struct {
-    uint8_t *buffer;
-    size_t size;
-    size_t head; // 写指针
-    size_t tail; // 读指针
-    size_t count;// 当前数据量
-    SemaphoreHandle_t mutex;
-} ringbuf_t;
+// 推进 UDP 上行，*next_wait_us 的含义同 client_uplink
+static void udp_uplink(int64_t *next_wait_us) {
+    bridge_client_t *c = &s_udp;
+    uint8_t *rec = bridge_udp_record();
 
-static ringbuf_t s_rb;
+    while (1) {
+        // 1. 补发上次未能发出的数据报
+        if (bridge_udp_pending() && !udp_flush()) {
+            if (*next_wait_us == 0 || UDP_RETRY_US < *next_wait_us) {
+                *next_wait_us = UDP_RETRY_US;
+            }
+            break;
+        }
 
-// 初始化环形缓冲区
-static bool rb_init(size_t size) {
-    s_rb.buffer = malloc(size);
-    if (!s_rb.buffer) return false;
-    s_rb.size = size;
-    s_rb.head = 0;
-    s_rb.tail = 0;
-    s_rb.count = 0;
-    s_rb.mutex = xSemaphoreCreateMutex();
-    return true;
+        // 2. 缓存溢出造成的丢失以 GAP 记录声明
+        size_t avail = rb_available(&s_rb, &c->reader);
+        size_t gap_len = bridge_framer_gap_record(&c->fr, rec, c->reader.tail, c->reader.lost);
+        if (gap_len > 0) {
+            bridge_udp_queue(gap_len);
+            continue;
+        }
+        if (avail == 0) {
+            c->cs.hold_start_us = 0;
+            break;
+        }
+
+        // 3. 合包就绪后组成一个 DATA 数据报，时间戳为首字节的采集时间
+        int64_t wait_us;
+        size_t len = coalesce_ready(c, avail, &wait_us);
+        if (len == 0) {
+            if (*next_wait_us == 0 || wait_us < *next_wait_us) {
+                *next_wait_us = wait_us;
+            }
+            break;
+        }
+        if (len > COALESCE_MAX_BYTES) len = COALESCE_MAX_BYTES;
+
+        int64_t ts;
+        uint32_t batch_end;
+        uint8_t flags = 0;
+        if (!ts_index_lookup(c->reader.tail, &ts, &batch_end)) {
+            flags |= BRIDGE_FRAME_F_TS_APPROX;
+        }
+        uint32_t offset = c->reader.tail;
+        size_t got = ring_copy_out(c, rec + BRIDGE_FRAME_HDR_LEN, len);
+        if (got == 0) continue;
+
+        bridge_frame_header(rec, BRIDGE_FRAME_DATA, flags, (uint16_t)got, offset, ts);
+        bridge_udp_queue(BRIDGE_FRAME_HDR_LEN + got);
+    }
+
+    if (c->reader.lost != c->lost_reported) {
+        ESP_LOGW(TAG, "UDP uplink fell behind, %u bytes dropped",
+                 (unsigned)(c->reader.lost - c->lost_reported));
+        s_stats.client_dropped += c->reader.lost - c->lost_reported;
+        c->lost_reported = c->reader.lost;
+    }
 }
+#endif
+
+// 推进单个客户端的上行数据，返回 false 表示连接需要关闭
+// *next_wait_us 汇总所有客户端中最近的合包到期时间
+static bool client_uplink(bridge_client_t *c, int64_t *next_wait_us) {
+    // 上次发送缓冲区已满，等 select 报告可写后再继续
+    if (c->want_write) return true;
+    if (!client_flush_reply(c)) return false;
+#if TLS_PORT > 0
+    if (c->tls) {
+        if (!c->tls_ready) return tls_handshake(c);
+        if (send_tls(c, 0) < 0) return false;
+    }
+#endif
+    if (client_framed(c) && send_framed(c, 0) < 0) return false;
+    if (client_tx_pending(c)) c->want_write = true;
+    if (c->want_write || c->suspended) return true;
+#if BRIDGE_SPOOL
+    if (c->replaying) {
+        if (!spool_replay(c)) return false;
+        if (c->replaying) return true;  // 发送缓冲区已满，等待可写后继续补发
+    }
+#endif
 
-// 写入数据 (如果满了，覆盖最旧的数据)
-static void rb_write(const uint8_t *data, size_t len) {
-    if (!s_rb.buffer) return;
-    xSemaphoreTake(s_rb.mutex, portMAX_DELAY);
-    for (size_t i = 0; i < len; i++) {
-        s_rb.buffer[s_rb.head] = data[i];
-        s_rb.head = (s_rb.head + 1) % s_rb.size;
-        
-        if (s_rb.count < s_rb.size) {
-            s_rb.count++;
+    while (1) {
+        size_t avail = rb_available(&s_rb, &c->reader);
+        if (avail == 0) {
+            c->cs.hold_start_us = 0;
+            break;
+        }
+#if BRIDGE_TX_ZEROCOPY
+        // 积压过多时提前丢弃最旧数据，保证确认前被钉住的区间离写位置足够远
+        if (c->zc_conn && avail > ZC_BACKLOG_MAX) {
+            c->reader.tail += avail - ZC_BACKLOG_MAX;
+            c->reader.lost += avail - ZC_BACKLOG_MAX;
+            avail = ZC_BACKLOG_MAX;
+        }
+#endif
+
+        int64_t wait_us;
+        size_t len = coalesce_ready(c, avail, &wait_us);
+        if (len == 0) {
+            if (*next_wait_us == 0 || wait_us < *next_wait_us) {
+                *next_wait_us = wait_us;
+            }
+            break;
+        }
+
+        int sent;
+        if (client_framed(c)) {
+            sent = send_framed(c, len);
+#if TLS_PORT > 0
+        } else if (c->tls) {
+            sent = send_tls(c, len);
+#endif
+#if BRIDGE_TX_ZEROCOPY
+        } else if (c->zc_conn) {
+            sent = zc_send(c, len);
+#endif
         } else {
-            // 缓冲区已满，覆盖旧数据，读指针被迫前移
-            s_rb.tail = (s_rb.tail + 1) % s_rb.size;
+            sent = send_from_ring(c, len);
+        }
+        if (sent < 0) return false;
+        if (sent > 0) {
+            bridge_lat_record(esp_timer_get_time() - c->cs.hold_start_us);
+#if BRIDGE_BENCH
+            s_bench_sent += sent;
+#endif
         }
+        if ((size_t)sent < len || client_tx_pending(c)) {
+            c->want_write = true;
+            break;
+        }
+        // 剩余数据沿用原到达时间，保证其滞留上限不被放宽
     }
-    xSemaphoreGive(s_rb.mutex);
-}
 
-// 读取数据
-static int rb_read(uint8_t *dst, int max_len) {
-    if (!s_rb.buffer) return 0;
-    xSemaphoreTake(s_rb.mutex, portMAX_DELAY);
-    int read_cnt = 0;
-    while (read_cnt < max_len && s_rb.count > 0) {
-        dst[read_cnt++] = s_rb.buffer[s_rb.tail];
-        s_rb.tail = (s_rb.tail + 1) % s_rb.size;
-        s_rb.count--;
+    if (c->reader.lost != c->lost_reported) {
+        ESP_LOGW(TAG, "Client %s too slow, %u bytes dropped", c->addr,
+                 (unsigned)(c->reader.lost - c->lost_reported));
+        s_stats.client_dropped += c->reader.lost - c->lost_reported;
+        c->lost_reported = c->reader.lost;
     }
-    xSemaphoreGive(s_rb.mutex);
-    return read_cnt;
+    if ((int32_t)(c->reader.tail - s_delivered_pos) > 0) {
+        s_delivered_pos = c->reader.tail;
+    }
+    return true;
 }
 
 // ====================================================
-// 守护任务: 持续从串口读取数据到环形缓冲区
-// 即使没有 TCP 连接，这个任务也在后台运行
+// 下行: Socket -> UART，按策略决定哪个客户端的数据写入串口
 // ====================================================
-static void uart_rx_daemon_task(void *arg) {
-    uint8_t *tmp_buf = (uint8_t *)malloc(BUF_SIZE);
-    if (!tmp_buf) {
-        ESP_LOGE(TAG, "Daemon malloc failed");
-        vTaskDelete(NULL);
-        return;
+static bridge_client_t *oldest_client(void) {
+    bridge_client_t *oldest = NULL;
+    for (int i = 0; i < BRIDGE_MAX_CLIENTS; i++) {
+        bridge_client_t *c = s_clients[i];
+        if (c && (!oldest || c->connected_us < oldest->connected_us)) {
+            oldest = c;
+        }
+    }
+    return oldest;
+}
+
+static bool downlink_acquire(bridge_client_t *c, int64_t now) {
+    switch (BRIDGE_DOWNLINK_POLICY) {
+        case DOWNLINK_MERGED:
+            return true;
+
+        case DOWNLINK_EXCLUSIVE:
+            return s_downlink_owner == c;
+
+        case DOWNLINK_FIRST_WRITER:
+        default:
+            // 持有者长时间未写入，允许其他客户端接管
+            if (s_downlink_owner && s_downlink_owner != c &&
+                now - s_downlink_owner->last_write_us > DOWNLINK_IDLE_RELEASE_MS * 1000LL) {
+                s_downlink_owner = NULL;
+            }
+            if (!s_downlink_owner) {
+                s_downlink_owner = c;
+                ESP_LOGI(TAG, "Client %s now owns the downlink", c->addr);
+            }
+            return s_downlink_owner == c;
     }
+}
+
+#if RFC2217_PORT > 0
+// ====================================================
+// RFC 2217: COM-PORT-OPTION 命令的执行见 bridge_rfc2217.h，以下为它对会话与发送环的操作
+// ====================================================
+static bool rfc2217_acquire(void *client) {
+    return downlink_acquire(client, esp_timer_get_time());
+}
+
+// 丢弃该客户端尚未发出的缓存
+static void rfc2217_purge_rx(void *client) {
+    bridge_client_t *c = client;
+    uart_flush_input(UART_NUM);
+    c->reader.tail = rb_head(&s_rb);
+    c->cs.hold_start_us = 0;
+}
+
+static void rfc2217_suspend(void *client, bool on) {
+    bridge_client_t *c = client;
+    c->suspended = on;
+}
+
+static const bridge_rfc2217_ops_t s_rfc2217_ops = {
+    .acquire = rfc2217_acquire,
+    .reconfigure = uart_tx_reconfigure,
+    .purge_rx = rfc2217_purge_rx,
+    .purge_tx = uart_tx_purge,
+    .suspend = rfc2217_suspend,
+};
+#endif
 
-    ESP_LOGI(TAG, "UART Capture Daemon Started (Cache: %d bytes)", UART_CACHE_SIZE);
+// 返回 false 表示连接已断开或出错
+// 按控制权策略放入下行发送环 (长度不超过读写块，读取前已确认发送环放得下)
+static void downlink_write(bridge_client_t *c, const uint8_t *buffer, int len) {
+    int64_t now = esp_timer_get_time();
+    if (downlink_acquire(c, now)) {
+        c->last_write_us = now;
+        tx_ring_push(buffer, len);
+        s_stats.dl_bytes += len;
+    } else {
+        ESP_LOGD(TAG, "Client %s is read-only, %d bytes discarded", c->addr, len);
+    }
+}
 
+#if TLS_PORT > 0
+// 解密所有已到达的记录 (mbedTLS 内部可能还缓存着 socket 上已读走的数据)
+static bool tls_downlink(bridge_client_t *c, uint8_t *buffer) {
+    if (!c->tls_ready) return tls_handshake(c);
     while (1) {
-        // 读取串口 (设置较短的超时，保证任务不完全阻塞)
-        // 注意：ESP8266 RTOS SDK 中 portTICK_RATE_MS 可能为 1 或 10
-        int len = uart_read_bytes(UART_NUM, tmp_buf, BUF_SIZE, 20 / portTICK_RATE_MS);
-        if (len > 0) {
-            rb_write(tmp_buf, len);
-        } else {
-            // 没有数据时稍微让出 CPU
-            vTaskDelay(10 / portTICK_RATE_MS);
+        // 发送环放不下一整块时暂停，已解密的数据留在 mbedTLS 中，腾出空间后继续
+        c->rx_pending = tx_ring_space() < s_cfg.chunk_size;
+        if (c->rx_pending) return true;
+        int len = mbedtls_ssl_read(c->tls, buffer, s_cfg.chunk_size);
+        if (len == MBEDTLS_ERR_SSL_WANT_READ || len == MBEDTLS_ERR_SSL_WANT_WRITE) return true;
+        if (len == 0 || len == MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY) return false;
+        if (len < 0) {
+            ESP_LOGW(TAG, "Client %s TLS read failed (-0x%04x)", c->addr, -len);
+            return false;
+        }
+        downlink_write(c, buffer, len);
+    }
+}
+#endif
+
+static bool client_downlink(bridge_client_t *c, uint8_t *buffer) {
+#if TLS_PORT > 0
+    if (c->tls) return tls_downlink(c, buffer);
+#endif
+    int len = recv(c->sock, buffer, s_cfg.chunk_size, 0);
+    if (len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return true;
+    }
+    if (len <= 0) {
+        if (len < 0) {
+            ESP_LOGW(TAG, "Client %s read failed (errno: %d)", c->addr, errno);
         }
+        return false;
+    }
+
+    if (c->proto == BRIDGE_PROTO_RFC2217) {
+        // 就地去除 Telnet 序列，命令在解析时即已生效
+        len = rfc2217_decode(&c->tn, buffer, len);
+        if (!client_flush_reply(c)) return false;
+        if (len == 0) return true;
     }
-    free(tmp_buf); // Unreachable
+
+    downlink_write(c, buffer, len);
+    return true;
 }
 
 // ====================================================
-// 任务 1: Socket -> UART (下行数据 - 保持原样)
+// 会话管理
 // ====================================================
-static void tcp_to_uart_task(void *pvParameters) {
-    bridge_context_t *ctx = (bridge_context_t *)pvParameters;
-    uint8_t *buffer = (uint8_t *)malloc(BUF_SIZE);
-    
-    if (!buffer) {
-        xSemaphoreGive(ctx->exit_sem);
-        vTaskDelete(NULL);
+// 槽位已满时挑选可被新连接替换的失效会话，返回槽位号，-1 表示都还有效
+static int client_pick_stale(const char *addr, uint8_t proto) {
+#if PREEMPT_SAME_HOST
+    // 同一主机在同一端口重新连入，旧连接几乎必然已随漫游失效
+    for (int i = 0; i < BRIDGE_MAX_CLIENTS; i++) {
+        bridge_client_t *c = s_clients[i];
+        if (c && c->proto == proto && strcmp(c->addr, addr) == 0) {
+            return i;
+        }
+    }
+#endif
+
+    // 发送阻塞最久的会话: 对端已不再确认数据
+    int victim = -1;
+    int64_t oldest = esp_timer_get_time() - PREEMPT_STALLED_MS * 1000LL;
+    for (int i = 0; i < BRIDGE_MAX_CLIENTS; i++) {
+        bridge_client_t *c = s_clients[i];
+        if (c && c->blocked_since_us != 0 && c->blocked_since_us < oldest) {
+            oldest = c->blocked_since_us;
+            victim = i;
+        }
+    }
+    return victim;
+}
+
+static void client_accept(int listen_sock, uint8_t proto) {
+    struct sockaddr_in source_addr;
+    socklen_t addr_len = sizeof(source_addr);
+    char addr[16];
+
+    int sock = accept(listen_sock, (struct sockaddr *)&source_addr, &addr_len);
+    if (sock < 0) {
+        ESP_LOGE(TAG, "Accept failed (errno: %d)", errno);
+        return;
+    }
+    inet_ntoa_r(source_addr.sin_addr, addr, sizeof(addr) - 1);
+
+#if TLS_PORT > 0
+    if (proto == BRIDGE_PROTO_TLS && !tls_claim(addr)) {
+        ESP_LOGW(TAG, "TLS connection from %s rejected (no PSK set or session busy)", addr);
+        close(sock);
         return;
     }
+#endif
 
-    ESP_LOGI(TAG, "Task [Net->UART] started");
+    int slot = -1;
+    for (int i = 0; i < BRIDGE_MAX_CLIENTS; i++) {
+        if (!s_clients[i]) {
+            slot = i;
+            break;
+        }
+    }
 
-    while (ctx->running) {
-        int len = recv(ctx->sock, buffer, BUF_SIZE, 0);
-        if (len > 0) {
-            uart_write_bytes(UART_NUM, (const char *)buffer, len);
-        } else {
-            if (ctx->running) {
-                ESP_LOGW(TAG, "Socket read failed or disconnected");
-            }
-            break; 
+    if (slot < 0) {
+        slot = client_pick_stale(addr, proto);
+        if (slot < 0) {
+            ESP_LOGW(TAG, "No free client slot, connection from %s rejected", addr);
+            close(sock);
+            return;
+        }
+        ESP_LOGW(TAG, "Client %s preempted by new connection from %s", s_clients[slot]->addr, addr);
+        client_close(slot);
+    }
+
+    // 复用预分配的槽位，会话切换无需任何内存分配
+    bridge_client_t *c = &s_client_pool[slot];
+    memset(c, 0, sizeof(*c));
+
+    // 合包已由桥接层完成，关闭 Nagle 避免二次等待
+    int nodelay = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    fcntl(sock, F_SETFL, O_NONBLOCK);
+
+#if KEEPALIVE_IDLE_S > 0
+    // 保活探测失败后 socket 报错，select 报告可读，recv 返回 ETIMEDOUT 后按断线处理
+    int keepalive = 1;
+    int keep_idle = KEEPALIVE_IDLE_S;
+    int keep_intvl = KEEPALIVE_INTVL_S;
+    int keep_count = KEEPALIVE_COUNT;
+    setsockopt(sock, SOL_SOCKET, SO_KEEPALIVE, &keepalive, sizeof(keepalive));
+    setsockopt(sock, IPPROTO_TCP, TCP_KEEPIDLE, &keep_idle, sizeof(keep_idle));
+    setsockopt(sock, IPPROTO_TCP, TCP_KEEPINTVL, &keep_intvl, sizeof(keep_intvl));
+    setsockopt(sock, IPPROTO_TCP, TCP_KEEPCNT, &keep_count, sizeof(keep_count));
+#endif
+
+    c->sock = sock;
+    c->proto = proto;
+    strcpy(c->addr, addr);
+    c->connected_us = esp_timer_get_time();
+    rb_reader_init(&c->reader, s_delivered_pos);
+    bridge_framer_init(&c->fr, slot);
+#if AUX_UART_NUM > 0
+    bridge_aux_reader_init(&c->aux);
+#endif
+#if BRIDGE_SPOOL
+    if (s_spool_ok && proto == BRIDGE_PROTO_RAW && s_client_count == 0) {
+        spool_replay_start(c);
+    }
+#endif
+    c->cs.idle_seen = s_line_idle_cnt;
+    c->cs.scan_pos = c->reader.tail;
+    c->cs.delim_end = c->reader.tail;
+
+#if BRIDGE_TX_ZEROCOPY
+    if (proto == BRIDGE_PROTO_RAW) {
+        c->zc_conn = bridge_zc_conn(sock);
+    }
+#endif
+
+#if TLS_PORT > 0
+    if (proto == BRIDGE_PROTO_TLS) {
+        c->tls = bridge_tls_acquire(c, tls_bio_send, tls_bio_recv);
+        if (!c->tls) {
+            close(sock);
+            c->sock = -1;
+            return;
+        }
+    }
+#endif
+
+#if RFC2217_PORT > 0
+    if (proto == BRIDGE_PROTO_RFC2217) {
+        // 主动声明二进制传输与抑制 GA，发送缓冲区满时随后续应答补发
+        bridge_rfc2217_start(&c->tn, c);
+        client_flush_reply(c);
+    }
+#endif
+
+    s_clients[slot] = c;
+    s_client_count++;
+    s_stats.sessions_total++;
+
+    if (BRIDGE_DOWNLINK_POLICY == DOWNLINK_EXCLUSIVE && !s_downlink_owner) {
+        s_downlink_owner = c;
+    }
+
+    ESP_LOGI(TAG, "Client %s connected (%s, slot %d, %d/%d active)",
+             c->addr, proto == BRIDGE_PROTO_RFC2217 ? "rfc2217" :
+                      proto == BRIDGE_PROTO_FRAMED ? "framed" :
+                      proto == BRIDGE_PROTO_FRAMED_LZ ? "framed+lz" :
+                      proto == BRIDGE_PROTO_TLS ? "tls" : "raw",
+             slot, s_client_count, BRIDGE_MAX_CLIENTS);
+}
+
+static void client_close(int slot) {
+    bridge_client_t *c = s_clients[slot];
+    uint32_t duration_s = (uint32_t)((esp_timer_get_time() - c->connected_us) / 1000000);
+
+    ESP_LOGW(TAG, "Client %s disconnected after %u s", c->addr, (unsigned)duration_s);
+    s_stats.session_s_total += duration_s;
+    if (duration_s > s_stats.session_s_max) s_stats.session_s_max = duration_s;
+
+#if BRIDGE_TX_ZEROCOPY
+    // 正常关闭会保留发送队列直到确认，其中的数据引用着缓存，只能直接复位
+    if (c->zc_pinned) {
+        zc_abort(c);
+    }
+#endif
+#if TLS_PORT > 0
+    if (c->tls) {
+        bridge_tls_release(c->tls_ready);
+        c->tls = NULL;
+    }
+#endif
+    shutdown(c->sock, 0);
+    close(c->sock);
+
+    s_clients[slot] = NULL;
+    s_client_count--;
+
+    if (s_downlink_owner == c) {
+        s_downlink_owner = NULL;
+        if (BRIDGE_DOWNLINK_POLICY == DOWNLINK_EXCLUSIVE) {
+            s_downlink_owner = oldest_client();
         }
     }
 
-    free(buffer);
-    ctx->running = false;
-    xSemaphoreGive(ctx->exit_sem);
-    vTaskDelete(NULL);
+    c->sock = -1;
+    bridge_lat_dump();
+}
+
+static int bridge_listen(uint16_t port) {
+    struct sockaddr_in dest_addr;
+    dest_addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    dest_addr.sin_family = AF_INET;
+    dest_addr.sin_port = htons(port);
+
+    int listen_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
+    if (listen_sock < 0) {
+        return -1;
+    }
+
+    int reuse = 1;
+    setsockopt(listen_sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    if (bind(listen_sock, (struct sockaddr *)&dest_addr, sizeof(dest_addr)) != 0 ||
+        listen(listen_sock, BRIDGE_MAX_CLIENTS) != 0) {
+        close(listen_sock);
+        return -1;
+    }
+    return listen_sock;
 }
 
 // ====================================================
-// 任务 2: Buffer -> Socket (上行数据 - 已修改)
-// 现在改为从 RingBuffer 读取，而不是直接读串口
+// 运行时参数: 端口与波特率立即生效；缓存与读写块大小需要重新分配，
+// 只在没有客户端时进行 (有客户端时推迟到最后一个断开)
 // ====================================================
-static void buffer_to_tcp_task(void *pvParameters) {
-    bridge_context_t *ctx = (bridge_context_t *)pvParameters;
-    uint8_t *buffer = (uint8_t *)malloc(BUF_SIZE);
-    
-    if (!buffer) {
-        xSemaphoreGive(ctx->exit_sem);
-        vTaskDelete(NULL);
-        return;
+static bool s_resize_deferred = false;
+
+// 暂停守护任务与 spool 任务，重新分配缓存与读写缓冲区
+static bool bridge_resize(uint32_t cache_size, uint16_t chunk_size) {
+#if BRIDGE_BENCH
+    // 性能测试任务是第二个生产者，不参与暂停协议
+    ESP_LOGW(TAG, "Buffer resize not supported in benchmark mode, reboot to apply");
+    return false;
+#endif
+    int parties = 1;
+#if BRIDGE_SPOOL
+    if (s_spool_ok) parties++;
+#endif
+
+    // 守护任务可能正阻塞在事件队列上，投递一个空事件让它到达安全点
+    s_rb_resize_req = true;
+    uart_event_t wake = { .type = UART_EVENT_MAX };
+    xQueueSendToFront(s_uart_queue, &wake, 0);
+
+    int parked = 0;
+    while (parked < parties &&
+           xSemaphoreTake(s_rb_parked, (SPOOL_FLUSH_MS * 2) / portTICK_RATE_MS) == pdTRUE) {
+        parked++;
     }
 
-    ESP_LOGI(TAG, "Task [Cache->Net] started. Flushing buffer...");
+    bool ok = parked == parties;
+    if (ok && cache_size != s_rb.size) {
+        ok = rb_resize(&s_rb, cache_size);
+    }
+    if (ok && chunk_size != s_cfg.chunk_size) {
+        // 各块缓冲区全部分配成功才替换，任何一块失败都保持原大小
+        uint8_t *uart_buf = malloc(chunk_size);
+        uint8_t *net_buf = malloc(chunk_size);
+        ok = uart_buf && net_buf;
+#if BRIDGE_SPOOL
+        uint8_t *spool_buf = malloc(chunk_size);
+        ok = ok && spool_buf;
+#endif
+        if (ok) {
+            free(s_uart_buf);
+            free(s_net_buf);
+            s_uart_buf = uart_buf;
+            s_net_buf = net_buf;
+#if BRIDGE_SPOOL
+            free(s_spool_buf);
+            s_spool_buf = spool_buf;
+            spool_buf = NULL;
+#endif
+            s_cfg.chunk_size = chunk_size;
+            uart_buf = net_buf = NULL;
+        }
+        free(uart_buf);
+        free(net_buf);
+#if BRIDGE_SPOOL
+        free(spool_buf);
+#endif
+    }
 
-    while (ctx->running) {
-        // 从环形缓冲区取数据
-        int len = rb_read(buffer, BUF_SIZE);
+    s_rb_resize_req = false;
+    if (s_daemon_task) {
+        xTaskNotifyGive(s_daemon_task);
+    }
+    // 未到达安全点的任务稍后仍会归还一次，清掉以免影响下一次调整
+    while (xSemaphoreTake(s_rb_parked, 0) == pdTRUE) {
+    }
 
-        if (len > 0) {
-            // 发送数据
-            int sent = send(ctx->sock, buffer, len, 0);
-            if (sent < 0) {
-                ESP_LOGE(TAG, "Socket send failed (errno: %d)", errno);
-                break;
+    if (!ok) {
+        ESP_LOGE(TAG, "Buffer resize failed (%d/%d tasks parked), keeping %u / %u bytes",
+                 parked, parties, (unsigned)s_rb.size, (unsigned)s_cfg.chunk_size);
+        return false;
+    }
+    s_cfg.cache_size = s_rb.size;
+    ESP_LOGI(TAG, "Buffers resized: cache %u bytes, chunk %u bytes",
+             (unsigned)s_rb.size, (unsigned)s_cfg.chunk_size);
+    return true;
+}
+
+#if TLS_PORT > 0 && TLS_ONLY
+static bool cleartext_allowed(void) {
+    return s_cfg.tls_psk[0] == '\0';
+}
+#else
+static inline bool cleartext_allowed(void) {
+    return true;
+}
+#endif
+
+// 按当前策略打开 / 关闭各监听端口; 明文端口关闭时一并断开明文客户端
+static void bridge_listeners_update(void) {
+    bool cleartext = cleartext_allowed();
+    for (int i = 0; i < BRIDGE_LISTENER_NUM; i++) {
+        bridge_listener_t *l = &s_listeners[i];
+        bool want = cleartext || l->proto == BRIDGE_PROTO_TLS;
+        if (want && l->sock < 0) {
+            l->sock = bridge_listen(l->port);
+            if (l->sock < 0) {
+                ESP_LOGE(TAG, "Unable to listen on port %d", l->port);
+            } else if (l->proto != BRIDGE_PROTO_RAW) {
+                ESP_LOGI(TAG, "%s Server listening on port %d",
+                         l->proto == BRIDGE_PROTO_RFC2217 ? "RFC 2217" :
+                         l->proto == BRIDGE_PROTO_FRAMED_LZ ? "Compressed framed" :
+                         l->proto == BRIDGE_PROTO_TLS ? "TLS" : "Framed", l->port);
             }
+        } else if (!want && l->sock >= 0) {
+            close(l->sock);
+            l->sock = -1;
+            ESP_LOGI(TAG, "Port %d closed (TLS only)", l->port);
+        }
+    }
+    if (!cleartext) {
+        for (int i = 0; i < BRIDGE_MAX_CLIENTS; i++) {
+            if (s_clients[i] && s_clients[i]->proto != BRIDGE_PROTO_TLS) client_close(i);
+        }
+    }
+}
+
+// 在 I/O 任务中应用待生效的参数
+static void bridge_reconfigure(void) {
+    bridge_config_t next;
+    xSemaphoreTake(s_cfg_lock, portMAX_DELAY);
+    next = s_cfg_target;
+    s_cfg_pending = false;
+    xSemaphoreGive(s_cfg_lock);
+
+    // 1. 端口: 新端口监听成功后再关闭旧端口，已连接的客户端不受影响
+    bridge_listener_t *raw = &s_listeners[0];
+    if (next.tcp_port != raw->port && !cleartext_allowed()) {
+        // 明文端口已关闭: 只记下新端口，重新打开时使用
+        raw->port = next.tcp_port;
+        s_cfg.tcp_port = next.tcp_port;
+    } else if (next.tcp_port != raw->port) {
+        int sock = bridge_listen(next.tcp_port);
+        if (sock < 0) {
+            ESP_LOGE(TAG, "Unable to listen on port %d, keeping port %d", next.tcp_port, raw->port);
+        } else {
+            if (raw->sock >= 0) close(raw->sock);
+            raw->sock = sock;
+            raw->port = next.tcp_port;
+            s_cfg.tcp_port = next.tcp_port;
+            ESP_LOGI(TAG, "Bridge Server moved to port %d", raw->port);
+        }
+    }
+
+    // 2. 波特率已由 tcp_bridge_apply_config 直接下发
+    s_cfg.baudrate = next.baudrate;
+
+    // 3. 过滤器: 由守护任务重建，投递一个空事件让它尽快处理
+    if (next.filter_mode != s_cfg.filter_mode || next.filter_context != s_cfg.filter_context ||
+        strcmp(next.filter_patterns, s_cfg.filter_patterns) != 0) {
+        s_cfg.filter_mode = next.filter_mode;
+        s_cfg.filter_context = next.filter_context;
+        strcpy(s_cfg.filter_patterns, next.filter_patterns);
+        s_filter_pending = true;
+        uart_event_t wake = { .type = UART_EVENT_MAX };
+        xQueueSendToFront(s_uart_queue, &wake, 0);
+    }
+
+    // 4. 缓冲区
+    s_resize_deferred = false;
+    if (next.cache_size != s_rb.size || next.chunk_size != s_cfg.chunk_size) {
+        if (s_client_count > 0) {
+            ESP_LOGI(TAG, "Buffer resize deferred until all clients disconnect");
+            s_resize_deferred = true;
         } else {
-            // 缓冲区空，等待新数据
-            // 50ms 轮询一次，兼顾响应速度和 CPU 占用
-            vTaskDelay(50 / portTICK_RATE_MS);
+            bridge_resize(next.cache_size, next.chunk_size);
         }
     }
 
-    free(buffer);
-    ctx->running = false;
-    xSemaphoreGive(ctx->exit_sem);
-    vTaskDelete(NULL);
+    // 5. TLS 密钥: 更换时断开现有 TLS 会话，旧密钥下签发的会话票据随之作废
+    if (strcmp(next.tls_psk, s_cfg.tls_psk) != 0) {
+        strcpy(s_cfg.tls_psk, next.tls_psk);
+#if TLS_PORT > 0
+        for (int i = 0; i < BRIDGE_MAX_CLIENTS; i++) {
+            if (s_clients[i] && s_clients[i]->tls) client_close(i);
+        }
+        ESP_LOGI(TAG, "TLS %s", bridge_tls_set_psk(s_cfg.tls_psk) ? "key updated" : "disabled");
+#endif
+        bridge_listeners_update();
+    }
+}
+
+void tcp_bridge_get_config(bridge_config_t *cfg) {
+    xSemaphoreTake(s_cfg_lock, portMAX_DELAY);
+    *cfg = s_cfg_target;
+    xSemaphoreGive(s_cfg_lock);
+}
+
+bool tcp_bridge_resize_pending(void) {
+    return s_resize_deferred;
+}
+
+esp_err_t tcp_bridge_apply_config(const bridge_config_t *cfg) {
+    esp_err_t err = bridge_config_save(cfg);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (cfg->baudrate != s_baudrate) {
+        tcp_bridge_set_baudrate(cfg->baudrate);
+    }
+
+    xSemaphoreTake(s_cfg_lock, portMAX_DELAY);
+    s_cfg_target = *cfg;
+    s_cfg_pending = true;
+    xSemaphoreGive(s_cfg_lock);
+    doorbell_wake();
+    return ESP_OK;
 }
 
+
 // ====================================================
-// 主 Server 任务
+// 统计
 // ====================================================
-static void tcp_server_task(void *pvParameters) {
-    struct sockaddr_in dest_addr;
-    dest_addr.sin_addr.s_addr = htonl(INADDR_ANY);
-    dest_addr.sin_family = AF_INET;
-    dest_addr.sin_port = htons(TCP_PORT);
+void tcp_bridge_get_stats(bridge_stats_t *st) {
+    *st = s_stats;
+    st->uptime_s = (uint32_t)(esp_timer_get_time() / 1000000);
+    st->sessions_active = s_client_count;
+    st->lat_p50_us = bridge_lat_percentile(500);
+    st->lat_p99_us = bridge_lat_percentile(990);
+}
 
-    int listen_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
-    if (listen_sock < 0) {
-        ESP_LOGE(TAG, "Unable to create socket");
-        vTaskDelete(NULL);
+#if STATS_PORT > 0
+static int s_stats_sock = -1;
+
+static bool stats_port_init(void) {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(STATS_PORT);
+
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        return false;
+    }
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(sock);
+        return false;
+    }
+    fcntl(sock, F_SETFL, O_NONBLOCK);
+    s_stats_sock = sock;
+    return true;
+}
+
+// 请求内容不限，每个请求数据报回复一份当前快照
+static void stats_serve(void) {
+    uint8_t req[16];
+    struct sockaddr_in from;
+    socklen_t from_len = sizeof(from);
+    if (recvfrom(s_stats_sock, req, sizeof(req), 0, (struct sockaddr *)&from, &from_len) < 0) {
         return;
     }
 
-    bind(listen_sock, (struct sockaddr *)&dest_addr, sizeof(dest_addr));
-    listen(listen_sock, 1);
+    bridge_stats_t st;
+    uint8_t buf[BRIDGE_STATS_BIN_MAX];
+    tcp_bridge_get_stats(&st);
+    size_t len = bridge_stats_encode(&st, buf, sizeof(buf));
+    sendto(s_stats_sock, buf, len, 0, (struct sockaddr *)&from, from_len);
+}
+#endif
 
-    ESP_LOGI(TAG, "Bridge Server listening on port %d...", TCP_PORT);
+// ====================================================
+// I/O 任务: 单任务 select() 服务所有客户端
+// 取代原来每个会话两个任务 (2 x 2048 字节栈) 的设计
+// ====================================================
+static void bridge_io_task(void *pvParameters) {
+    (void)pvParameters;
+    ESP_LOGI(TAG, "Bridge Server listening on port %d (max %d clients)...",
+             s_cfg.tcp_port, BRIDGE_MAX_CLIENTS);
 
     while (1) {
-        struct sockaddr_in source_addr;
-        socklen_t addr_len = sizeof(source_addr);
-        
-        ESP_LOGI(TAG, "Waiting for client...");
-        int sock = accept(listen_sock, (struct sockaddr *)&source_addr, &addr_len);
-        if (sock < 0) {
-            ESP_LOGE(TAG, "Accept failed");
-            vTaskDelay(1000 / portTICK_RATE_MS);
+        fd_set rfds, wfds;
+        FD_ZERO(&rfds);
+        FD_ZERO(&wfds);
+        FD_SET(s_wake_rx_sock, &rfds);
+        int maxfd = s_wake_rx_sock;
+
+        for (int i = 0; i < BRIDGE_LISTENER_NUM; i++) {
+            int sock = s_listeners[i].sock;
+            if (sock < 0) continue;
+            FD_SET(sock, &rfds);
+            if (sock > maxfd) maxfd = sock;
+        }
+#if CONTROL_PORT > 0
+        maxfd = bridge_ctl_fdset(&rfds, maxfd);
+#endif
+#if STATS_PORT > 0
+        if (s_stats_sock >= 0) {
+            FD_SET(s_stats_sock, &rfds);
+            if (s_stats_sock > maxfd) maxfd = s_stats_sock;
+        }
+#endif
+
+        // 下行发送环将满时不再关注可读，对端由 TCP 窗口反压 (连接错误延后到恢复读取时处理)
+        bool dl_paused = tx_ring_paused();
+        for (int i = 0; i < BRIDGE_MAX_CLIENTS; i++) {
+            bridge_client_t *c = s_clients[i];
+            if (!c) continue;
+            if (!dl_paused) FD_SET(c->sock, &rfds);
+            if (c->want_write) FD_SET(c->sock, &wfds);
+            if (c->sock > maxfd) maxfd = c->sock;
+        }
+
+        // 超时仅用于兜底，正常情况下由门铃或 socket 事件唤醒
+        struct timeval tv = { .tv_sec = 1, .tv_usec = 0 };
+        int n = select(maxfd + 1, &rfds, &wfds, NULL, &tv);
+        if (n < 0) {
+            ESP_LOGE(TAG, "select failed (errno: %d)", errno);
+            vTaskDelay(100 / portTICK_RATE_MS);
             continue;
         }
-        
-        ESP_LOGI(TAG, "Client connected! Starting tasks.");
 
-        bridge_context_t ctx;
-        ctx.sock = sock;
-        ctx.running = true;
-        ctx.exit_sem = xSemaphoreCreateCounting(2, 0);
+#if BRIDGE_BENCH
+        int64_t busy_start = esp_timer_get_time();
+#endif
 
-        // 创建透传任务
-        // 注意：原 uart_to_tcp 改为 buffer_to_tcp
-        xTaskCreate(tcp_to_uart_task, "tcp2uart", 2048, &ctx, 5, NULL);
-        xTaskCreate(buffer_to_tcp_task, "buf2tcp", 2048, &ctx, 5, NULL);
+        if (FD_ISSET(s_wake_rx_sock, &rfds)) {
+            doorbell_drain();
+        }
+#if CONTROL_PORT > 0
+        bridge_ctl_service(&rfds);
+#endif
+#if STATS_PORT > 0
+        if (s_stats_sock >= 0 && FD_ISSET(s_stats_sock, &rfds)) {
+            stats_serve();
+        }
+#endif
+        if (s_cfg_pending || (s_resize_deferred && s_client_count == 0)) {
+            bridge_reconfigure();
+        }
+        for (int i = 0; i < BRIDGE_LISTENER_NUM; i++) {
+            bridge_listener_t *l = &s_listeners[i];
+            if (l->sock >= 0 && FD_ISSET(l->sock, &rfds)) {
+                client_accept(l->sock, l->proto);
+            }
+        }
 
-        xSemaphoreTake(ctx.exit_sem, portMAX_DELAY);
+        for (int i = 0; i < BRIDGE_MAX_CLIENTS; i++) {
+            bridge_client_t *c = s_clients[i];
+            if (!c) continue;
+            if (FD_ISSET(c->sock, &wfds)) {
+                c->want_write = false;
+                c->blocked_since_us = 0;
+            }
+            bool readable = FD_ISSET(c->sock, &rfds) || (c->rx_pending && !tx_ring_paused());
+            if (readable && !client_downlink(c, s_net_buf)) {
+                client_close(i);
+            }
+        }
 
-        ESP_LOGW(TAG, "Session ending. Cleaning up...");
+        // 上行: 所有客户端各自按游标从共享缓存发送
+        int64_t next_wait_us = 0;
+        for (int i = 0; i < BRIDGE_MAX_CLIENTS; i++) {
+            bridge_client_t *c = s_clients[i];
+            if (c && !client_uplink(c, &next_wait_us)) {
+                client_close(i);
+            }
+        }
 
-        ctx.running = false; 
-        shutdown(sock, 0);
-        close(sock);
+        // 发送长期无进展: 对端已失联但保活尚未超时 (对端窗口满时保活不会启动)
+        int64_t now = esp_timer_get_time();
+        for (int i = 0; i < BRIDGE_MAX_CLIENTS; i++) {
+            bridge_client_t *c = s_clients[i];
+            if (!c) continue;
+            if (!c->want_write) {
+                c->blocked_since_us = 0;
+            } else if (c->blocked_since_us == 0) {
+                c->blocked_since_us = now;
+            } else if (now - c->blocked_since_us > STALL_TIMEOUT_MS * 1000LL) {
+                ESP_LOGW(TAG, "Client %s stalled for %d ms, dropping", c->addr, STALL_TIMEOUT_MS);
+                client_close(i);
+            }
+        }
+#if UDP_UPLINK_PORT > 0
+        if (s_udp_active && cleartext_allowed()) {
+            udp_uplink(&next_wait_us);
+        }
+#endif
+
+#if BRIDGE_TX_ZEROCOPY
+        zc_service();
+#endif
+
+        if (next_wait_us > 0) {
+            esp_timer_stop(s_hold_timer);
+            esp_timer_start_once(s_hold_timer, next_wait_us);
+        }
+
+        // 发布最慢客户端的读位置，背压期间唤醒守护任务重新评估
+        uint32_t slowest = rb_head(&s_rb);
+        for (int i = 0; i < BRIDGE_MAX_CLIENTS; i++) {
+            bridge_client_t *c = s_clients[i];
+            if (c && (int32_t)(c->reader.tail - slowest) < 0) {
+                slowest = c->reader.tail;
+            }
+        }
+        s_backlog_tail = slowest;
+        if (s_flow_paused && s_daemon_task) {
+            xTaskNotifyGive(s_daemon_task);
+        }
+#if BRIDGE_TX_ZEROCOPY
+        if (s_zc_waiting && s_daemon_task) {
+            xTaskNotifyGive(s_daemon_task);
+        }
+#endif
+
+#if BRIDGE_BENCH
+        s_bench_busy_us += esp_timer_get_time() - busy_start;
+#endif
+    }
+}
 
-        vTaskDelay(500 / portTICK_RATE_MS);
-        vSemaphoreDelete(ctx.exit_sem);
-        ESP_LOGI(TAG, "Cleaned up. Ready for next.");
+#if BRIDGE_BENCH
+// ====================================================
+// 性能测试 (见 bridge_bench.h)
+// ====================================================
+static void bench_publish(const uint8_t *data, size_t len, int64_t t_us, bool line_idle) {
+    capture_publish(data, len, t_us);
+    s_last_rx_us = t_us;
+    if (line_idle) {
+        s_line_idle_cnt++;
     }
+    doorbell_ring();
+    flow_update();
+}
 
-    vTaskDelete(NULL);
+static bool bench_paused(void) {
+    return s_flow_paused;
 }
 
+static void bench_snapshot(bridge_bench_snapshot_t *snap) {
+    snap->sent = s_bench_sent;
+    snap->busy_us = s_bench_busy_us;
+    snap->lost = 0;
+    for (int i = 0; i < BRIDGE_MAX_CLIENTS; i++) {
+        if (s_client_pool[i].sock >= 0) snap->lost += s_client_pool[i].reader.lost;
+    }
+    bridge_lat_copy(snap->hist);
+}
+
+static const bridge_bench_ops_t s_bench_ops = {
+    .publish = bench_publish,
+    .paused = bench_paused,
+    .snapshot = bench_snapshot,
+};
+#endif
+
 void tcp_bridge_init(void) {
+    // 0. 载入运行时参数
+    esp_err_t cfg_err = bridge_config_load(&s_cfg);
+    if (cfg_err != ESP_OK) {
+        ESP_LOGW(TAG, "Using default bridge config (%s)", esp_err_to_name(cfg_err));
+    }
+    s_cfg_target = s_cfg;
+    s_cfg_lock = xSemaphoreCreateMutex();
+    s_rb_parked = xSemaphoreCreateCounting(2, 0);
+    s_listeners[0].port = s_cfg.tcp_port;
+    s_baudrate = s_cfg.baudrate;
+    char cfg_str[192];
+    bridge_config_format(&s_cfg, cfg_str, sizeof(cfg_str));
+    ESP_LOGI(TAG, "Bridge config: %s", cfg_str);
+
+    if (!uart_filter_init(&s_filter, s_cfg.filter_mode, s_cfg.filter_patterns, s_cfg.filter_context)) {
+        ESP_LOGE(TAG, "Unable to build UART filter, filtering disabled");
+    }
+
     // 1. 初始化环形缓冲区
-    if (!rb_init(UART_CACHE_SIZE)) {
+    if (!s_cfg_lock || !s_rb_parked || !rb_init(&s_rb, s_cfg.cache_size)) {
         ESP_LOGE(TAG, "Failed to allocate UART cache buffer!");
         return;
     }
 
+    // 会话槽位与收发缓冲区一次性分配，内存占用在启动时即确定
+    s_client_pool = calloc(BRIDGE_MAX_CLIENTS, sizeof(bridge_client_t));
+    s_uart_buf = malloc(s_cfg.chunk_size);
+    s_net_buf = malloc(s_cfg.chunk_size);
+    s_tx_ring = malloc(UART_TX_RING_SIZE);
+    s_tx_cmd_queue = xQueueCreate(UART_TX_CMD_NUM, sizeof(uart_tx_cmd_t));
+    if (!s_client_pool || !s_uart_buf || !s_net_buf || !s_tx_ring || !s_tx_cmd_queue) {
+        ESP_LOGE(TAG, "Failed to allocate bridge buffers!");
+        return;
+    }
+    for (int i = 0; i < BRIDGE_MAX_CLIENTS; i++) {
+        s_client_pool[i].sock = -1;
+    }
+
+#if TLS_PORT > 0
+    s_tls_plain = malloc(BRIDGE_TLS_RECORD_MAX);
+    if (!s_tls_plain || !bridge_tls_init()) {
+        ESP_LOGE(TAG, "Failed to set up TLS!");
+        return;
+    }
+    if (!bridge_tls_set_psk(s_cfg.tls_psk)) {
+        ESP_LOGW(TAG, "No TLS key configured, TLS connections will be rejected");
+    }
+#endif
+
+#if FRAMED_LZ_PORT > 0
+    if (!bridge_framer_lz_init(LZ_CHUNK_MAX, BRIDGE_MAX_CLIENTS)) {
+        ESP_LOGE(TAG, "Failed to allocate compression buffers!");
+        return;
+    }
+#endif
+
     // 2. 配置 UART
-    uart_config_t uart_config = {
-        .baud_rate = BRIDGE_BAUDRATE,
+    s_uart_config = (uart_config_t){
+        .baud_rate = s_cfg.baudrate,
         .data_bits = UART_DATA_8_BITS,
         .parity    = UART_PARITY_DISABLE,
         .stop_bits = UART_STOP_BITS_1,
-        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE
+#if BRIDGE_FLOW_CTRL == FLOW_CTRL_RTSCTS
+        .flow_ctrl = UART_HW_FLOWCTRL_CTS_RTS,
+        .rx_flow_ctrl_thresh = UART_HW_RTS_THRESH,
+#else
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+#endif
     };
     
-    // 安装驱动 (Rx buffer 1024, Tx buffer 0)
-    uart_driver_install(UART_NUM, 1024, 0, 0, NULL, 0);
-    uart_param_config(UART_NUM, &uart_config);
+    // 安装驱动 (发送缓冲区由 TX FIFO 空中断续填)，并获取事件队列
+    uart_driver_install(UART_NUM, UART_RX_BUF_SIZE, UART_TX_BUF_SIZE, UART_EVENT_QUEUE_LEN, &s_uart_queue, 0);
+    uart_param_config(UART_NUM, &s_uart_config);
+
+    // 缩短 RX 超时，端到端时延由线路空闲检测决定，而不是 tick 轮询
+    uart_intr_config_t uart_intr = {
+        .intr_enable_mask = UART_RXFIFO_FULL_INT_ENA_M | UART_RXFIFO_TOUT_INT_ENA_M |
+                            UART_FRM_ERR_INT_ENA_M | UART_RXFIFO_OVF_INT_ENA_M,
+        .rx_timeout_thresh = UART_RX_TOUT_THRESH,
+        .txfifo_empty_intr_thresh = 10,
+        .rxfifo_full_thresh = UART_RXFIFO_FULL_THRESH,
+    };
+    uart_intr_config(UART_NUM, &uart_intr);
 
     // 3. 交换引脚
     uart_enable_swap();
     ESP_LOGI(TAG, "UART Swapped: TX->D8(GPIO15), RX->D7(GPIO13)");
 
+    // 合包滞留定时器
+    const esp_timer_create_args_t hold_timer_args = {
+        .callback = hold_timer_cb,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "bridge_hold",
+    };
+    esp_timer_create(&hold_timer_args, &s_hold_timer);
+
+#if BRIDGE_SPOOL
+    // Flash 离线缓存，分区表中没有 spool 分区时仅使用 RAM 缓存
+    esp_err_t spool_err = bridge_spool_init();
+    s_spool_buf = malloc(s_cfg.chunk_size);
+    if (spool_err == ESP_OK && s_spool_buf) {
+        s_spool_ok = true;
+        s_spool_base = bridge_spool_end();
+        xTaskCreate(spool_task, "bridge_spool", 2048, NULL, 3, NULL);
+    } else {
+        ESP_LOGW(TAG, "Flash spool disabled (%s)", esp_err_to_name(spool_err));
+    }
+#endif
+
     // 4. 启动永久运行的串口接收守护任务
     // 优先级略高于普通任务，防止数据丢失
-    xTaskCreate(uart_rx_daemon_task, "uart_daemon", 2048, NULL, 10, NULL);
+    xTaskCreate(uart_rx_daemon_task, "uart_daemon", 2048, NULL, 10, &s_daemon_task);
+    // 下行发送任务，优先级高于 I/O 任务，及时续填驱动发送缓冲区
+    xTaskCreate(uart_tx_task, "uart_tx", 1536, NULL, 6, &s_tx_task);
+
+    // 5. 启动 TCP Server (单个 I/O 任务服务所有客户端)
+    if (!doorbell_init()) {
+        ESP_LOGE(TAG, "Unable to create bridge sockets");
+        return;
+    }
+#if RFC2217_PORT > 0
+    bridge_rfc2217_init(&s_rfc2217_ops, &s_uart_config, BRIDGE_DTR_GPIO, BRIDGE_RTS_GPIO,
+                        BRIDGE_FLOW_CTRL == FLOW_CTRL_RTSCTS ? 3 :
+                        BRIDGE_FLOW_CTRL == FLOW_CTRL_XONXOFF ? 2 : 1);
+#endif
+#if AUX_UART_NUM > 0
+    if (!bridge_aux_init(doorbell_ring)) {
+        ESP_LOGE(TAG, "Unable to start aux UART channels");
+    }
+#endif
+#if CONTROL_PORT > 0
+    if (!bridge_ctl_init(CONTROL_PORT)) {
+        ESP_LOGE(TAG, "Unable to listen on control port %d", CONTROL_PORT);
+    }
+#endif
+#if STATS_PORT > 0
+    if (!stats_port_init()) {
+        ESP_LOGE(TAG, "Unable to open stats port %d", STATS_PORT);
+    }
+#endif
+#if UDP_UPLINK_PORT > 0
+    if (!udp_uplink_init()) {
+        ESP_LOGE(TAG, "Unable to start UDP uplink");
+    }
+#endif
+    bridge_listeners_update();
+    xTaskCreate(bridge_io_task, "bridge_io", 3072, NULL, 5, NULL);
 
-    // 5. 启动 TCP Server
-    xTaskCreate(tcp_server_task, "bridge_server", 3072, NULL, 5, NULL);
+#if BRIDGE_BENCH
+    bridge_bench_start(&s_bench_ops);
+#endif
 }
\ No newline at end of file
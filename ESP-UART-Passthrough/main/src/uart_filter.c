@@ -0,0 +1,272 @@
+#include "uart_filter.h"
+#include <stdlib.h>
+#include <string.h>
+
+// 注意：转移表项的最高位是命中标记，状态号只用低 7 位
+// - 构建阶段以 0xFF 表示字典树中尚无该转移
+// - 命中标记在补全转移之后统一写入，构建过程中读到的表项都不带标记
+
+#define UF_HIT        0x80
+#define UF_STATE_MASK 0x7F
+#define UF_NONE       0xFF
+#define UF_MAX_STATES (UART_FILTER_PATTERNS_MAX + 1)
+
+// 行判定
+#define VERDICT_NONE 0
+#define VERDICT_PASS 1
+#define VERDICT_DROP 2
+
+bool uart_filter_check(const char *patterns) {
+    size_t total = strlen(patterns);
+    if (total == 0 || total > UART_FILTER_PATTERNS_MAX) {
+        return false;
+    }
+
+    int count = 1;
+    size_t cur = 0;
+    for (const char *p = patterns; ; p++) {
+        if (*p == '|' || *p == '\0') {
+            if (cur == 0) return false;  // 空模式会在每个字节命中
+            if (*p == '\0') break;
+            count++;
+            cur = 0;
+        } else {
+            cur++;
+        }
+    }
+    return count <= UART_FILTER_MAX_PATTERNS;
+}
+
+// 构建 Aho-Corasick 自动机，并沿失败链接把缺失的转移补全为 DFA
+static bool uf_compile(uart_filter_t *f, const char *patterns) {
+    // 1. 等价类: 类 0 为模式中未出现的所有字节
+    memset(f->byte_class, 0, sizeof(f->byte_class));
+    f->num_classes = 1;
+    size_t max_states = 1;
+    for (const char *p = patterns; *p; p++) {
+        uint8_t b = (uint8_t)*p;
+        if (b == '|') continue;
+        if (f->byte_class[b] == 0) f->byte_class[b] = f->num_classes++;
+        max_states++;
+    }
+
+    size_t nc = f->num_classes;
+    f->delta = malloc(max_states * nc);
+    if (!f->delta) return false;
+    memset(f->delta, UF_NONE, max_states * nc);
+
+    bool out[UF_MAX_STATES] = { false };
+    uint8_t fail[UF_MAX_STATES];
+    uint8_t queue[UF_MAX_STATES];
+
+    // 2. 字典树
+    f->num_states = 1;
+    uint8_t s = 0;
+    for (const char *p = patterns; ; p++) {
+        if (*p == '|' || *p == '\0') {
+            out[s] = true;
+            s = 0;
+            if (*p == '\0') break;
+            continue;
+        }
+        uint8_t *t = &f->delta[s * nc + f->byte_class[(uint8_t)*p]];
+        if (*t == UF_NONE) *t = f->num_states++;
+        s = *t;
+    }
+
+    // 3. 按深度逐层计算失败链接，失败状态更浅，其转移行此时已补全
+    int head = 0;
+    int tail = 0;
+    for (size_t c = 0; c < nc; c++) {
+        uint8_t *t = &f->delta[c];
+        if (*t == UF_NONE) {
+            *t = 0;
+        } else {
+            fail[*t] = 0;
+            queue[tail++] = *t;
+        }
+    }
+    while (head < tail) {
+        s = queue[head++];
+        out[s] |= out[fail[s]];  // 后缀上的模式同样算命中
+        for (size_t c = 0; c < nc; c++) {
+            uint8_t *t = &f->delta[s * nc + c];
+            uint8_t via_fail = f->delta[fail[s] * nc + c];
+            if (*t == UF_NONE) {
+                *t = via_fail;
+            } else {
+                fail[*t] = via_fail;
+                queue[tail++] = *t;
+            }
+        }
+    }
+
+    // 4. 标记进入命中状态的转移
+    for (size_t i = 0; i < (size_t)f->num_states * nc; i++) {
+        if (out[f->delta[i]]) f->delta[i] |= UF_HIT;
+    }
+    return true;
+}
+
+bool uart_filter_init(uart_filter_t *f, uint8_t mode, const char *patterns, uint32_t context) {
+    memset(f, 0, sizeof(*f));
+    if (mode == UART_FILTER_OFF) {
+        return true;
+    }
+    if (mode > UART_FILTER_CAPTURE || !patterns || !uart_filter_check(patterns)) {
+        return false;
+    }
+    if (mode == UART_FILTER_CAPTURE && (context == 0 || context > UART_FILTER_CONTEXT_MAX)) {
+        return false;
+    }
+
+    if (!uf_compile(f, patterns)) {
+        goto fail;
+    }
+    if (mode == UART_FILTER_CAPTURE) {
+        f->hist = malloc(context);
+        f->context = context;
+        if (!f->hist) goto fail;
+    } else {
+        f->line = malloc(UART_FILTER_LINE_MAX);
+        if (!f->line) goto fail;
+    }
+    f->mode = mode;
+    return true;
+
+fail:
+    uart_filter_deinit(f);
+    return false;
+}
+
+void uart_filter_deinit(uart_filter_t *f) {
+    free(f->delta);
+    free(f->line);
+    free(f->hist);
+    memset(f, 0, sizeof(*f));
+}
+
+// 推进一个字节，返回是否刚好有模式在此结束
+static inline bool uf_step(uart_filter_t *f, uint8_t b) {
+    uint8_t n = f->delta[f->state * f->num_classes + f->byte_class[b]];
+    f->state = n & UF_STATE_MASK;
+    return (n & UF_HIT) != 0;
+}
+
+// 行模式: 未判定的行先暂存，命中或行结束时整体转发 / 丢弃；已判定的行其余部分直接处理到换行符
+static size_t uf_feed_lines(uart_filter_t *f, const uint8_t *data, size_t len,
+                            uart_filter_emit_t emit, void *ctx) {
+    size_t out = 0;
+    size_t i = 0;
+    while (i < len) {
+        if (f->line_verdict != VERDICT_NONE) {
+            const uint8_t *nl = memchr(data + i, '\n', len - i);
+            size_t end = nl ? (size_t)(nl - data) + 1 : len;
+            if (f->line_verdict == VERDICT_PASS) {
+                emit(ctx, data + i, end - i);
+                out += end - i;
+            }
+            i = end;
+            if (nl) {
+                f->line_verdict = VERDICT_NONE;
+                f->state = 0;
+            }
+            continue;
+        }
+
+        uint8_t b = data[i++];
+        f->line[f->line_len++] = b;
+        if (uf_step(f, b)) {
+            f->matches++;
+            f->line_verdict = f->mode == UART_FILTER_PASS ? VERDICT_PASS : VERDICT_DROP;
+        } else if (b == '\n' || f->line_len == UART_FILTER_LINE_MAX) {
+            // 整行 (或超长行的前 LINE_MAX 字节) 未命中
+            f->line_verdict = f->mode == UART_FILTER_PASS ? VERDICT_DROP : VERDICT_PASS;
+        } else {
+            continue;
+        }
+
+        if (f->line_verdict == VERDICT_PASS) {
+            emit(ctx, f->line, f->line_len);
+            out += f->line_len;
+        }
+        f->line_len = 0;
+        if (b == '\n') {
+            f->line_verdict = VERDICT_NONE;
+            f->state = 0;
+        }
+    }
+    return out;
+}
+
+// 按时间顺序输出触发前的历史
+static size_t uf_emit_hist(uart_filter_t *f, uart_filter_emit_t emit, void *ctx) {
+    if (f->hist_fill == f->context && f->hist_pos < f->context) {
+        emit(ctx, f->hist + f->hist_pos, f->context - f->hist_pos);
+    }
+    if (f->hist_pos > 0) {
+        emit(ctx, f->hist, f->hist_pos);
+    }
+    size_t n = f->hist_fill;
+    f->hist_pos = 0;
+    f->hist_fill = 0;
+    return n;
+}
+
+// 捕获模式: 窗口外的数据只进历史，触发时连同历史一起输出，之后 context 字节直通
+static size_t uf_feed_capture(uart_filter_t *f, const uint8_t *data, size_t len,
+                              uart_filter_emit_t emit, void *ctx) {
+    size_t out = 0;
+    size_t i = 0;
+    while (i < len) {
+        size_t start = i;
+        while (i < len && f->post_remain > 0) {
+            if (uf_step(f, data[i])) {
+                f->matches++;
+                f->post_remain = f->context + 1;  // 窗口从命中字节之后重新计算
+            }
+            f->post_remain--;
+            i++;
+        }
+        if (i > start) {
+            emit(ctx, data + start, i - start);
+            out += i - start;
+        }
+
+        while (i < len && f->post_remain == 0) {
+            uint8_t b = data[i++];
+            f->hist[f->hist_pos++] = b;
+            if (f->hist_pos == f->context) f->hist_pos = 0;
+            if (f->hist_fill < f->context) f->hist_fill++;
+            if (uf_step(f, b)) {
+                f->matches++;
+                out += uf_emit_hist(f, emit, ctx);
+                f->post_remain = f->context;
+            }
+        }
+    }
+    return out;
+}
+
+size_t uart_filter_feed(uart_filter_t *f, const uint8_t *data, size_t len,
+                        uart_filter_emit_t emit, void *ctx) {
+    if (len == 0) return 0;
+
+    size_t out;
+    switch (f->mode) {
+        case UART_FILTER_PASS:
+        case UART_FILTER_DROP:
+            out = uf_feed_lines(f, data, len, emit, ctx);
+            break;
+        case UART_FILTER_CAPTURE:
+            out = uf_feed_capture(f, data, len, emit, ctx);
+            break;
+        default:
+            emit(ctx, data, len);
+            out = len;
+            break;
+    }
+    f->bytes_in += len;
+    f->bytes_out += out;
+    return out;
+}
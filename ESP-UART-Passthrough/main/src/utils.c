@@ -50,4 +50,30 @@ bool parse_mac_address(const char *str, uint8_t mac[6])
         return true;
     }
     return false;
-}
\ No newline at end of file
+}
+
+static int hex_nibble(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+int hex_decode(uint8_t *dst, const char *src, size_t dst_len)
+{
+    size_t n = 0;
+    while (src[0] != '\0') {
+        int hi = hex_nibble(src[0]);
+        int lo = hi < 0 ? -1 : hex_nibble(src[1]);
+        if (lo < 0 || n >= dst_len) {
+            return -1;
+        }
+        if (dst) {
+            dst[n] = (uint8_t)(hi << 4 | lo);
+        }
+        n++;
+        src += 2;
+    }
+    return (int)n;
+}
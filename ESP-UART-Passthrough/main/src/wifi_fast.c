@@ -0,0 +1,67 @@
+#include "wifi_fast.h"
+#include <string.h>
+#include "nvs.h"
+#include "esp_log.h"
+
+static const char *TAG = "WiFi_Fast";
+
+#define FAST_NAMESPACE "wifi_fast"
+#define FAST_KEY "ap"
+#define FAST_VERSION 1
+
+static bool fast_read(wifi_fast_t *fast) {
+    nvs_handle handle;
+    size_t len = sizeof(*fast);
+    bool ok = false;
+
+    if (nvs_open(FAST_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return false;  // 还没有保存过
+    }
+    if (nvs_get_blob(handle, FAST_KEY, fast, &len) == ESP_OK) {
+        ok = len == sizeof(*fast) && fast->version == FAST_VERSION;
+    }
+    nvs_close(handle);
+    return ok;
+}
+
+bool wifi_fast_load(const uint8_t ssid[32], wifi_fast_t *fast) {
+    if (!fast_read(fast)) {
+        return false;
+    }
+    return memcmp(fast->ssid, ssid, sizeof(fast->ssid)) == 0 &&
+           fast->channel >= 1 && fast->channel <= 14;
+}
+
+void wifi_fast_save(const wifi_fast_t *fast) {
+    wifi_fast_t old;
+    wifi_fast_t rec = *fast;
+    nvs_handle handle;
+
+    rec.version = FAST_VERSION;
+    if (fast_read(&old) && memcmp(&old, &rec, sizeof(rec)) == 0) {
+        return;
+    }
+
+    esp_err_t err = nvs_open(FAST_NAMESPACE, NVS_READWRITE, &handle);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(handle, FAST_KEY, &rec, sizeof(rec));
+        if (err == ESP_OK) err = nvs_commit(handle);
+        nvs_close(handle);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Unable to save fast-connect cache (0x%x)", err);
+    } else {
+        ESP_LOGI(TAG, "Fast-connect cache updated (channel %u)", rec.channel);
+    }
+}
+
+void wifi_fast_invalidate(void) {
+    nvs_handle handle;
+    if (nvs_open(FAST_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK) {
+        return;
+    }
+    if (nvs_erase_key(handle, FAST_KEY) == ESP_OK) {
+        nvs_commit(handle);
+    }
+    nvs_close(handle);
+}
@@ -1,5 +1,9 @@
 #include "wifi_prov.h"
 #include "utils.h"
+#include "tcp_bridge.h"
+#include "wifi_scan.h"
+#include "json_writer.h"
+#include "wifi_fast.h"
 
 #include <string.h>
 #include <stdlib.h> // for malloc
@@ -10,135 +14,223 @@
 #include "esp_event.h"
 #include "esp_log.h"
 #include "esp_netif.h"
+#include "esp_timer.h"
+#include "tcpip_adapter.h"
 #include "esp_http_server.h"
 #include <sys/param.h>
 
 static const char *TAG = "WiFi_Prov";
 static httpd_handle_t server = NULL;
+// 配网模式 (AP+STA)，连上路由后需要重启进入 STA 模式
+static bool s_provisioning = false;
 
-// 最大重连次数
-#define MAX_RETRY 5
-// 当前重连计数
+// 重连退避: 首次 1s，每次翻倍，叠加 ±25% 随机抖动，抖动后不超过 2 分钟
+// 不设次数上限，路由器停机一夜后恢复也能自动连回；同一路由下的多台设备不会同时重连
+#define RETRY_BASE_MS 1000
+#define RETRY_MAX_MS (2 * 60 * 1000)
+#define RETRY_JITTER_PCT 25
+// 当前重连计数 (只在默认事件循环中读写)
 static int s_retry_num = 0;
+// 重连定时器发起连接被驱动拒绝时，交回事件循环安排下一次
+ESP_EVENT_DEFINE_BASE(WIFI_PROV_EVENT);
+#define WIFI_PROV_EVENT_CONNECT_REFUSED 0
+// 重连与配网完成后的重启都由定时器延后执行，不阻塞默认事件循环
+static esp_timer_handle_t s_retry_timer;
+static esp_timer_handle_t s_restart_timer;
 
-/* * 前端页面 HTML 
- * 新增了 scanWifi() JS 函数和 scanBtn 按钮 
- * 优化: 信号强度 Emoji 显示 + BSSID 显示 + 自动填充 BSSID
+// 快速重连: 启动时按上次的信道 / BSSID 定向连接 (见 wifi_fast.h)
+#define WIFI_FAST_CONNECT 1
+// 快速重连时先直接使用上次 DHCP 获得的地址，关联后再在后台重新启动 DHCP 确认租约
+#define WIFI_FAST_STATIC_IP 1
+// 快速重连从启动到关联成功的时限，超时或失败后恢复全信道扫描 + DHCP
+#define WIFI_FAST_TIMEOUT_MS 3000
+// 确认租约的时限，超时未拿到地址则作废缓存，下次启动走完整流程
+#define WIFI_FAST_DHCP_TIMEOUT_MS 10000
+
+#if WIFI_FAST_CONNECT > 0
+static bool s_fast_trying = false;      // 快速重连进行中
+static bool s_fast_static = false;      // 本次使用了缓存的地址 (DHCP 已停止)
+static bool s_fast_pinned = false;      // RAM 中的 STA 配置锁定在缓存的信道与 BSSID
+static wifi_config_t s_sta_saved;       // NVS 中的 STA 配置，连上或回退时恢复
+static esp_timer_handle_t s_fast_timer;
+#if WIFI_FAST_STATIC_IP > 0
+static uint32_t s_fast_cached_ip;       // 本次使用的缓存地址，租约确认时比较
+static esp_timer_handle_t s_fast_dhcp_timer;
+#endif
+#endif
+
+/* * 前端页面 (源文件 main/web/index.html)
+ * 构建时由 tools/web_pack.py 精简并 gzip，以二进制数据嵌入固件，原样发给浏览器
  */
-const char* index_html = 
-    "<!DOCTYPE html>"
-    "<html>"
-    "<head>"
-    "<meta name=\"viewport\" content=\"width=device-width, initial-scale=1.0\">"
-    "<meta charset=\"UTF-8\">"
-    "<title>ESP8266 Config</title>"
-    "<style>"
-    "  body { font-family: sans-serif; padding: 20px; max-width: 400px; margin: 0 auto; }"
-    "  input, select, button { padding: 10px; margin: 5px 0; width: 100%; box-sizing: border-box; }"
-    "  button { background-color: #007bff; color: white; border: none; cursor: pointer; }"
-    "  button:disabled { background-color: #ccc; }"
-    "  .advanced { margin-top: 15px; padding: 10px; border: 1px solid #ccc; background: #f9f9f9; }"
-    "  #scan_res { display: none; margin-top: 5px; }"
-    "</style>"
-    "<script>"
-    "  function validateForm() {"
-    "    var ssid = document.getElementById('ssid').value;"
-    "    var pass = document.getElementById('password').value;"
-    "    var bssidCheck = document.getElementById('bssid_enable').checked;"
-    "    var bssid = document.getElementById('bssid').value;"
-    "    if (ssid.length == 0) { alert('SSID cannot be empty'); return false; }"
-    "    if (ssid.length > 32) { alert('SSID too long'); return false; }"
-    "    if (pass.length > 63) { alert('Password too long'); return false; }"
-    "    if (bssidCheck) {"
-    "      var macRegex = /^([0-9A-Fa-f]{2}[:-]){5}([0-9A-Fa-f]{2})$/;"
-    "      if (!macRegex.test(bssid)) { alert('Invalid BSSID'); return false; }"
-    "    }"
-    "    return true;"
-    "  }"
-    "  function toggleAdvanced() {"
-    "    var div = document.getElementById('bssid_div');"
-    "    var check = document.getElementById('bssid_enable');"
-    "    div.style.display = check.checked ? 'block' : 'none';"
-    "  }"
-    "  function getSignalEmoji(rssi) {"
-    "    if (rssi >= -55) return '🟢';" // Excellent
-    "    if (rssi >= -75) return '🟡';" // Good
-    "    if (rssi >= -85) return '🟠';" // Fair
-    "    return '🔴';"                 // Weak
-    "  }"
-    "  function scanWifi() {"
-    "    var btn = document.getElementById('scanBtn');"
-    "    var sel = document.getElementById('scan_res');"
-    "    btn.disabled = true;"
-    "    btn.innerText = 'Scanning...';"
-    "    fetch('/scan').then(res => res.json()).then(data => {"
-    "       sel.innerHTML = '<option value=\"\">-- Select Network --</option>';"
-    "       data.forEach(ap => {"
-    "         var opt = document.createElement('option');"
-    "         opt.value = ap.ssid;"
-    "         /* 将 BSSID 存入 dataset 以便选择时读取 */"
-    "         opt.dataset.bssid = ap.bssid;" 
-    "         var lock = ap.auth == 0 ? '' : '🔒';"
-    "         var emoji = getSignalEmoji(ap.rssi);"
-    "         /* 显示格式: 🟢 SSID (-50dBm) [MAC] 🔒 */"
-    "         opt.innerText = emoji + ' ' + ap.ssid + ' (' + ap.rssi + 'dBm) [' + ap.bssid + '] ' + lock;"
-    "         sel.appendChild(opt);"
-    "       });"
-    "       sel.style.display = 'block';"
-    "       btn.disabled = false;"
-    "       btn.innerText = 'Rescan';"
-    "    }).catch(e => {"
-    "       alert('Scan failed: ' + e);"
-    "       btn.disabled = false;"
-    "       btn.innerText = 'Scan WiFi';"
-    "    });"
-    "  }"
-    "  function selectWifi() {"
-    "     var sel = document.getElementById('scan_res');"
-    "     var selectedOpt = sel.options[sel.selectedIndex];"
-    "     if(sel.value) {"
-    "       document.getElementById('ssid').value = sel.value;"
-    "       /* 如果存在 BSSID 且用户开启了锁定功能(或为了方便用户查看)，尝试填充 */"
-    "       if (selectedOpt.dataset.bssid) {"
-    "          document.getElementById('bssid').value = selectedOpt.dataset.bssid;"
-    "       }"
-    "     }"
-    "  }"
-    "</script>"
-    "</head>"
-    "<body>"
-    "<h2>WiFi Configuration</h2>"
-    "<form action=\"/config\" method=\"post\" onsubmit=\"return validateForm()\">"
-    
-    "SSID:<br>"
-    "<input type=\"text\" id=\"ssid\" name=\"ssid\" maxlength=\"32\" placeholder=\"Enter SSID\">"
-    "<button type=\"button\" id=\"scanBtn\" onclick=\"scanWifi()\">Scan Networks</button>"
-    "<select id=\"scan_res\" onchange=\"selectWifi()\"></select>"
-    "<br>"
-    
-    "Password:<br><input type=\"text\" id=\"password\" name=\"password\" maxlength=\"63\" placeholder=\"Enter Password\"><br>"
-    
-    "<div class=\"advanced\">"
-    "  <strong>Advanced Settings</strong><br>"
-    "  <label><input type=\"checkbox\" id=\"bssid_enable\" name=\"bssid_enable\" onclick=\"toggleAdvanced()\"> Lock BSSID</label>"
-    "  <div id=\"bssid_div\" style=\"display:none\">"
-    "    BSSID (Auto-filled from scan):<br>"
-    "    <input type=\"text\" id=\"bssid\" name=\"bssid\" maxlength=\"17\" placeholder=\"AA:BB:CC:DD:EE:FF\">"
-    "  </div>"
-    "</div>"
-    
-    "<br><input type=\"submit\" value=\"Connect\">"
-    "</form>"
-    "</body>"
-    "</html>";
+extern const uint8_t index_html_gz_start[] asm("_binary_index_html_gz_start");
+extern const uint8_t index_html_gz_end[]   asm("_binary_index_html_gz_end");
 
 /* --- 内部函数声明 --- */
 static void start_webserver();
 
+#if WIFI_FAST_CONNECT > 0
+/* 快速重连超时: 主动断开，由 STA_DISCONNECTED 走回退流程 */
+static void fast_timeout_cb(void *arg)
+{
+    (void)arg;
+    if (s_fast_trying) {
+        ESP_LOGW(TAG, "Fast connect timed out");
+        esp_wifi_disconnect();
+    }
+}
+
+/* 按缓存修改本次启动的 STA 配置 (只在 RAM 中生效)，在 esp_wifi_start 之前调用 */
+static void fast_connect_prepare(const wifi_config_t *saved)
+{
+    wifi_fast_t fast;
+    if (!wifi_fast_load(saved->sta.ssid, &fast)) {
+        return;
+    }
+
+    s_sta_saved = *saved;
+    wifi_config_t cfg = *saved;
+    cfg.sta.channel = fast.channel;
+    cfg.sta.scan_method = WIFI_FAST_SCAN;
+    cfg.sta.bssid_set = true;
+    memcpy(cfg.sta.bssid, fast.bssid, sizeof(cfg.sta.bssid));
+    // 临时配置不写入 NVS，用户保存的配置 (例如未锁定 BSSID) 保持不变
+    ESP_ERROR_CHECK(esp_wifi_set_storage(WIFI_STORAGE_RAM));
+    ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &cfg));
+    s_fast_pinned = true;
+
+#if WIFI_FAST_STATIC_IP > 0
+    if (fast.ip != 0) {
+        tcpip_adapter_ip_info_t ip_info = {0};
+        ip_info.ip.addr = fast.ip;
+        ip_info.netmask.addr = fast.netmask;
+        ip_info.gw.addr = fast.gw;
+        tcpip_adapter_dhcpc_stop(TCPIP_ADAPTER_IF_STA);
+        if (tcpip_adapter_set_ip_info(TCPIP_ADAPTER_IF_STA, &ip_info) == ESP_OK) {
+            s_fast_static = true;
+            s_fast_cached_ip = fast.ip;
+            if (fast.dns != 0) {
+                tcpip_adapter_dns_info_t dns = {0};
+                ip_addr_set_ip4_u32(&dns.ip, fast.dns);
+                tcpip_adapter_set_dns_info(TCPIP_ADAPTER_IF_STA, TCPIP_ADAPTER_DNS_MAIN, &dns);
+            }
+        } else {
+            tcpip_adapter_dhcpc_start(TCPIP_ADAPTER_IF_STA);
+        }
+    }
+#endif
+
+    ESP_LOGI(TAG, "Fast connect: channel %u, BSSID "MACSTR"%s", fast.channel, MAC2STR(fast.bssid),
+             s_fast_static ? ", cached IP" : "");
+    s_fast_trying = true;
+    esp_timer_start_once(s_fast_timer, WIFI_FAST_TIMEOUT_MS * 1000);
+}
+
+/* 恢复保存的 STA 配置: 否则之后的每次重连都只找缓存的 BSSID，
+ * AP 更换或漫游到其他 BSSID 后直到重启都连不上 */
+static void fast_connect_unpin(void)
+{
+    if (s_fast_pinned) {
+        s_fast_pinned = false;
+        esp_wifi_set_config(WIFI_IF_STA, &s_sta_saved);
+    }
+}
+
+/* 快速重连失败: 恢复保存的配置 (全信道扫描) 与 DHCP，立即重连 */
+static void fast_connect_fallback(void)
+{
+    s_fast_trying = false;
+    esp_timer_stop(s_fast_timer);
+    ESP_LOGW(TAG, "Fast connect failed, falling back to full scan%s", s_fast_static ? " + DHCP" : "");
+    fast_connect_unpin();
+    if (s_fast_static) {
+        s_fast_static = false;
+        tcpip_adapter_dhcpc_start(TCPIP_ADAPTER_IF_STA);
+    }
+    esp_wifi_connect();
+}
+
+#if WIFI_FAST_STATIC_IP > 0
+/* 关联后缓存的地址已可用，但租约可能已过期或地址已分给别人:
+ * 重新启动 DHCP (期间地址短暂清零)，拿到租约后由 GOT_IP 按租约更新缓存 */
+static void fast_dhcp_verify(void)
+{
+    ESP_LOGI(TAG, "Confirming cached IP with DHCP");
+    tcpip_adapter_dhcpc_start(TCPIP_ADAPTER_IF_STA);
+    esp_timer_start_once(s_fast_dhcp_timer, WIFI_FAST_DHCP_TIMEOUT_MS * 1000);
+}
+
+/* 确认超时: 作废缓存而不是留着过期的地址 */
+static void fast_dhcp_timeout_cb(void *arg)
+{
+    (void)arg;
+    ESP_LOGW(TAG, "No DHCP lease within %d ms, fast-connect cache invalidated", WIFI_FAST_DHCP_TIMEOUT_MS);
+    wifi_fast_invalidate();
+}
+#endif
+
+/* 连上后记录本次的信道、BSSID 与地址 */
+static void fast_connect_save(const tcpip_adapter_ip_info_t *ip_info)
+{
+    wifi_ap_record_t ap;
+    wifi_config_t cfg;
+    if (esp_wifi_sta_get_ap_info(&ap) != ESP_OK || esp_wifi_get_config(WIFI_IF_STA, &cfg) != ESP_OK) {
+        return;
+    }
+
+    wifi_fast_t fast = {0};
+    memcpy(fast.ssid, cfg.sta.ssid, sizeof(fast.ssid));
+    memcpy(fast.bssid, ap.bssid, sizeof(fast.bssid));
+    fast.channel = ap.primary;
+#if WIFI_FAST_STATIC_IP > 0
+    tcpip_adapter_dns_info_t dns;
+    fast.ip = ip_info->ip.addr;
+    fast.netmask = ip_info->netmask.addr;
+    fast.gw = ip_info->gw.addr;
+    if (tcpip_adapter_get_dns_info(TCPIP_ADAPTER_IF_STA, TCPIP_ADAPTER_DNS_MAIN, &dns) == ESP_OK) {
+        fast.dns = ip4_addr_get_u32(ip_2_ip4(&dns.ip));
+    }
+#endif
+    wifi_fast_save(&fast);
+}
+#endif
+
+/* 第 attempt 次重连前的等待时间 */
+static uint32_t retry_delay_ms(int attempt)
+{
+    uint32_t delay = RETRY_MAX_MS;
+    if (attempt - 1 < 16 && (RETRY_BASE_MS << (attempt - 1)) < RETRY_MAX_MS) {
+        delay = RETRY_BASE_MS << (attempt - 1);
+    }
+    uint32_t span = delay * RETRY_JITTER_PCT / 100;
+    delay = delay - span + esp_random() % (2 * span + 1);
+    return delay > RETRY_MAX_MS ? RETRY_MAX_MS : delay;
+}
+
+/* 在 esp_timer 任务中执行，不读写重连计数 */
+static void retry_timer_cb(void *arg)
+{
+    (void)arg;
+    // 例如正在扫描时驱动拒绝连接，不会产生 STA_DISCONNECTED，由事件循环安排下一次
+    esp_err_t err = esp_wifi_connect();
+    if (err != ESP_OK &&
+        esp_event_post(WIFI_PROV_EVENT, WIFI_PROV_EVENT_CONNECT_REFUSED, &err, sizeof(err),
+                       100 / portTICK_RATE_MS) != ESP_OK) {
+        // 事件队列满: 按基础间隔再试，不计入重连次数
+        esp_timer_start_once(s_retry_timer, RETRY_BASE_MS * 1000ULL);
+    }
+}
+
+static void restart_timer_cb(void *arg)
+{
+    (void)arg;
+    esp_restart();
+}
+
 /* WiFi 事件处理 */
 static void wifi_event_handler(void* arg, esp_event_base_t event_base,
                                int32_t event_id, void* event_data)
 {
+    (void)arg;
     if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_AP_STACONNECTED) {
         wifi_event_ap_staconnected_t* event = (wifi_event_ap_staconnected_t*) event_data;
         ESP_LOGI(TAG, "Station "MACSTR" joined, AID=%d", MAC2STR(event->mac), event->aid);
@@ -147,129 +239,189 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base,
         wifi_event_ap_stadisconnected_t* event = (wifi_event_ap_stadisconnected_t*) event_data;
         ESP_LOGI(TAG, "Station "MACSTR" left, AID=%d", MAC2STR(event->mac), event->aid);
     }
+#if WIFI_FAST_CONNECT > 0
+    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED) {
+        // 已关联到缓存的 AP，时限只针对扫描与关联，之后的 DHCP 不受其限制
+        if (s_fast_trying) {
+            esp_timer_stop(s_fast_timer);
+        }
+    }
+#endif
     else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
         ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
-        ESP_LOGI(TAG, "Got IP: " IPSTR, IP2STR(&event->ip_info.ip));
+        // 上电到拿到地址的时间，即桥接可达之前的主要耗时
+        ESP_LOGI(TAG, "Got IP: " IPSTR " (%d ms after boot)", IP2STR(&event->ip_info.ip),
+                 (int)(esp_timer_get_time() / 1000));
         s_retry_num = 0; // 成功连接，重置重试计数
-        if (server) {
+        esp_timer_stop(s_retry_timer);
+#if WIFI_FAST_CONNECT > 0
+        s_fast_trying = false;
+        fast_connect_unpin();
+#if WIFI_FAST_STATIC_IP > 0
+        if (s_fast_static) {
+            // 缓存的地址尚未经 DHCP 确认，不写回缓存
+            s_fast_static = false;
+            fast_dhcp_verify();
+        } else {
+            if (s_fast_cached_ip != 0) {
+                esp_timer_stop(s_fast_dhcp_timer);
+                if (s_fast_cached_ip != event->ip_info.ip.addr) {
+                    ESP_LOGW(TAG, "DHCP lease differs from cached IP, cache updated");
+                }
+                s_fast_cached_ip = 0;
+            }
+            fast_connect_save(&event->ip_info);
+        }
+#else
+        fast_connect_save(&event->ip_info);
+#endif
+#endif
+        if (s_provisioning) {
             ESP_LOGI(TAG, "Provisioning Successful! Restarting...");
-            vTaskDelay(pdMS_TO_TICKS(1000));
-            esp_restart();
+            // 留出时间让页面收到响应
+            esp_timer_start_once(s_restart_timer, 1000 * 1000);
         }
     }
+    else if (event_base == WIFI_PROV_EVENT && event_id == WIFI_PROV_EVENT_CONNECT_REFUSED) {
+        esp_err_t err = *(esp_err_t *)event_data;
+        s_retry_num++;
+        uint32_t delay_ms = retry_delay_ms(s_retry_num);
+        ESP_LOGW(TAG, "Connect refused (0x%x), retry #%d after %u ms", err, s_retry_num, (unsigned)delay_ms);
+        esp_timer_stop(s_retry_timer);
+        esp_timer_start_once(s_retry_timer, delay_ms * 1000ULL);
+    }
     else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
-        // 自动重连逻辑
-        if (s_retry_num < MAX_RETRY) {
-            s_retry_num++;
-            
-            // 采用线性退避策略 (Linear Backoff)
-            // 每次重试增加 1500ms 延迟
-            // Retry 1: 1500ms
-            // Retry 2: 3000ms
-            // Retry 3: 4500ms ...
-            int delay_ms = s_retry_num * 1500;
-            ESP_LOGI(TAG, "Retry connect (%d/%d) after %d ms", s_retry_num, MAX_RETRY, delay_ms);
-            vTaskDelay(pdMS_TO_TICKS(delay_ms));
-            
-            esp_wifi_connect();
-        } else {
-            ESP_LOGE(TAG, "Connect failed. Max retries reached.");
+#if WIFI_FAST_CONNECT > 0
+        // 快速重连失败不计入重试次数
+        if (s_fast_trying) {
+            fast_connect_fallback();
+            return;
         }
+#endif
+#if WIFI_FAST_CONNECT > 0
+        // 重连一律按保存的配置进行
+        fast_connect_unpin();
+#endif
+        // 自动重连: 由定时器在退避时间后发起，事件循环不等待
+        wifi_event_sta_disconnected_t* event = (wifi_event_sta_disconnected_t*) event_data;
+        s_retry_num++;
+        uint32_t delay_ms = retry_delay_ms(s_retry_num);
+        ESP_LOGI(TAG, "Disconnected (reason %d), retry #%d after %u ms",
+                 event->reason, s_retry_num, (unsigned)delay_ms);
+        esp_timer_stop(s_retry_timer);
+        esp_timer_start_once(s_retry_timer, delay_ms * 1000ULL);
     }
 }
 
 /* HTTP GET Handler - 返回配网页面 */
-static esp_err_t root_get_handler(httpd_req_t *req)
+/* * 页面的强 ETag: 压缩数据的 FNV-1a 64 位哈希，内容不变则不变，首次请求时计算 */
+static const char *index_etag(void)
 {
-    httpd_resp_send(req, index_html, strlen(index_html));
-    return ESP_OK;
+    static char etag[19];   // 引号 + 16 位十六进制 + 引号
+    if (etag[0] == '\0') {
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for (const uint8_t *p = index_html_gz_start; p < index_html_gz_end; p++) {
+            h = (h ^ *p) * 0x100000001b3ULL;
+        }
+        snprintf(etag, sizeof(etag), "\"%08x%08x\"", (unsigned)(h >> 32), (unsigned)h);
+    }
+    return etag;
 }
 
-/* * HTTP GET Handler - 执行 WiFi 扫描并返回 JSON 
- * 响应格式: [{"ssid":"ABC","rssi":-50,"auth":3,"bssid":"xx:xx..."}, ...]
+/* * HTTP GET Handler - 配网页面
+ * 浏览器带着相同的 ETag 再次访问时只回 304，页面本体不再经过 SoftAP 传输
  */
-static esp_err_t scan_get_handler(httpd_req_t *req)
+static esp_err_t root_get_handler(httpd_req_t *req)
 {
-    // 配置扫描参数 (block=true 表示阻塞直到扫描完成)
-    wifi_scan_config_t scan_config = {
-        .ssid = NULL,
-        .bssid = NULL,
-        .channel = 0,
-        .show_hidden = true
-    };
-    
-    // 开始扫描 (阻塞模式)
-    ESP_LOGI(TAG, "Starting WiFi Scan...");
-    esp_err_t err = esp_wifi_scan_start(&scan_config, true);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Scan failed (0x%x)", err);
-        httpd_resp_send_500(req);
-        return ESP_FAIL;
-    }
+    const char *etag = index_etag();
+    char inm[64];
 
-    uint16_t ap_count = 0;
-    esp_wifi_scan_get_ap_num(&ap_count);
-    ESP_LOGI(TAG, "Found %d APs", ap_count);
+    httpd_resp_set_hdr(req, "ETag", etag);
+    // 允许缓存，但每次使用前向设备确认 (固件更新后页面立即生效)
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
 
-    if (ap_count == 0) {
-        httpd_resp_send(req, "[]", 2);
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", inm, sizeof(inm)) == ESP_OK &&
+        strstr(inm, etag) != NULL) {
+        httpd_resp_set_status(req, "304 Not Modified");
+        httpd_resp_send(req, NULL, 0);
         return ESP_OK;
     }
 
-    // 限制最大处理数量以防止内存溢出
-    if (ap_count > 20) ap_count = 20;
+    // 只有压缩版本: 所有浏览器都支持 gzip，不再按 Accept-Encoding 区分
+    httpd_resp_set_type(req, "text/html; charset=utf-8");
+    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    httpd_resp_send(req, (const char *)index_html_gz_start, index_html_gz_end - index_html_gz_start);
+    return ESP_OK;
+}
 
-    wifi_ap_record_t *ap_list = (wifi_ap_record_t *)malloc(ap_count * sizeof(wifi_ap_record_t));
-    if (!ap_list) {
-        httpd_resp_send_500(req);
-        return ESP_FAIL;
-    }
+/* JSON 编码器的输出回调: 每块直接作为一个 HTTP chunk 发出 */
+static int json_send_chunk(void *ctx, const char *data, size_t len)
+{
+    return httpd_resp_send_chunk((httpd_req_t *)ctx, data, len);
+}
 
-    ESP_ERROR_CHECK(esp_wifi_scan_get_ap_records(&ap_count, ap_list));
-
-    // 构建 JSON 字符串
-    // 估算缓冲区大小: 
-    // 每个 AP 约: 
-    // {"ssid":"...","rssi":-xx,"auth":x,"bssid":"xx:xx:xx:xx:xx:xx"}
-    // SSID(32) + RSSI(5) + Auth(3) + BSSID(19) + Keys/Quotes(40) ~= 100 bytes
-    // 安全起见给 128 bytes/AP
-    char *json_buf = malloc(ap_count * 128 + 10); 
-    if (!json_buf) {
-        free(ap_list);
-        httpd_resp_send_500(req);
+/* 结束分块响应；编码或发送出错时连接已不可用，返回 ESP_FAIL 让 httpd 关闭它 */
+static esp_err_t json_send_finish(httpd_req_t *req, json_writer_t *w)
+{
+    if (jw_finish(w) != 0) {
         return ESP_FAIL;
     }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
 
-    char *ptr = json_buf;
-    ptr += sprintf(ptr, "[");
-
-    for (int i = 0; i < ap_count; i++) {
-        // 过滤空 SSID
-        if (strlen((char *)ap_list[i].ssid) == 0) continue;
+/* * HTTP GET Handler - 返回缓存的扫描结果，不等待扫描
+ * 快照过期 (或 ?refresh=1) 时在后台启动扫描，scanning 为 true 期间页面继续轮询
+ * 响应格式: {"gen":3,"age":12,"scanning":false,"aps":[{"ssid":"ABC","rssi":-50,"auth":3,"bssid":"xx:xx..."}, ...]}
+ * 同名 SSID 只保留信号最强的一条，按 RSSI 从强到弱排序
+ * 逐条取出、逐块发送，内存占用与 AP 数量无关
+ */
+static esp_err_t scan_get_handler(httpd_req_t *req)
+{
+    char query[32];
+    char val[4];
+    bool force = httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+                 httpd_query_key_value(query, "refresh", val, sizeof(val)) == ESP_OK &&
+                 strcmp(val, "1") == 0;
+    wifi_scan_request(force);
 
-        ptr += sprintf(ptr, "{\"ssid\":\"%s\",\"rssi\":%d,\"auth\":%d,\"bssid\":\"%02x:%02x:%02x:%02x:%02x:%02x\"}", 
-                       ap_list[i].ssid, ap_list[i].rssi, ap_list[i].authmode,
-                       ap_list[i].bssid[0], ap_list[i].bssid[1], ap_list[i].bssid[2],
-                       ap_list[i].bssid[3], ap_list[i].bssid[4], ap_list[i].bssid[5]);
-        
-        if (i < ap_count - 1) {
-            ptr += sprintf(ptr, ",");
-        }
-    }
-    // 处理最后一个可能的逗号
-    if (*(ptr - 1) == ',') {
-        ptr--; 
-    }
+    wifi_scan_info_t info;
+    wifi_scan_info(&info);
 
-    ptr += sprintf(ptr, "]");
-    
-    // 发送响应
     httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, json_buf, strlen(json_buf));
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
 
-    free(json_buf);
-    free(ap_list);
-    return ESP_OK;
+    json_writer_t w;
+    jw_init(&w, json_send_chunk, req);
+    jw_object_begin(&w);
+    jw_key(&w, "gen");
+    jw_uint(&w, info.gen);
+    jw_key(&w, "age");
+    jw_uint(&w, info.age_ms / 1000);
+    jw_key(&w, "scanning");
+    jw_bool(&w, info.scanning);
+    jw_key(&w, "aps");
+    jw_array_begin(&w);
+
+    // 发送途中若有新结果替换快照则就此截止，gen 已变化，页面下次轮询会整体重绘
+    wifi_scan_ap_t ap;
+    for (int i = 0; wifi_scan_entry(info.gen, i, &ap); i++) {
+        char bssid[18];
+        snprintf(bssid, sizeof(bssid), MACSTR, MAC2STR(ap.bssid));
+        jw_object_begin(&w);
+        jw_key(&w, "ssid");
+        jw_string(&w, ap.ssid);
+        jw_key(&w, "rssi");
+        jw_int(&w, ap.rssi);
+        jw_key(&w, "auth");
+        jw_uint(&w, ap.authmode);
+        jw_key(&w, "bssid");
+        jw_string(&w, bssid);
+        jw_object_end(&w);
+    }
+
+    jw_array_end(&w);
+    jw_object_end(&w);
+    return json_send_finish(req, &w);
 }
 
 /* HTTP POST Handler - 保存配置 */
@@ -325,11 +477,21 @@ static esp_err_t wifi_config_post_handler(httpd_req_t *req)
             }
         }
         
+#if WIFI_FAST_CONNECT > 0
+        // 快速重连时改成了 RAM 存储，新配置要写回 NVS；缓存的地址属于旧网络，恢复 DHCP
+        esp_wifi_set_storage(WIFI_STORAGE_FLASH);
+        s_fast_trying = false;
+        if (s_fast_static) {
+            s_fast_static = false;
+            tcpip_adapter_dhcpc_start(TCPIP_ADAPTER_IF_STA);
+        }
+#endif
         ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
         ESP_LOGI(TAG, "Connecting to router...");
         
-        // 收到新配置时，重置重试计数器，给新密码 5 次机会
+        // 收到新配置时，重置退避并立即连接
         s_retry_num = 0;
+        esp_timer_stop(s_retry_timer);
         esp_wifi_connect();
         
         const char *resp_str = "Connecting... Please check device status.";
@@ -342,20 +504,164 @@ static esp_err_t wifi_config_post_handler(httpd_req_t *req)
     return ESP_OK;
 }
 
+/* HTTP GET Handler - 返回桥接运行参数 (JSON) */
+static esp_err_t bridge_get_handler(httpd_req_t *req)
+{
+    bridge_config_t cfg;
+    tcp_bridge_get_config(&cfg);
+
+    httpd_resp_set_type(req, "application/json");
+
+    json_writer_t w;
+    jw_init(&w, json_send_chunk, req);
+    jw_object_begin(&w);
+    jw_key(&w, "port");
+    jw_uint(&w, cfg.tcp_port);
+    jw_key(&w, "baud");
+    jw_uint(&w, cfg.baudrate);
+    jw_key(&w, "chunk");
+    jw_uint(&w, cfg.chunk_size);
+    jw_key(&w, "cache");
+    jw_uint(&w, cfg.cache_size);
+    jw_key(&w, "filter");
+    jw_string(&w, bridge_config_filter_name(cfg.filter_mode));
+    jw_key(&w, "patterns");
+    jw_string(&w, cfg.filter_patterns);
+    jw_key(&w, "context");
+    jw_uint(&w, cfg.filter_context);
+    // TLS 密钥只写不读，这里只报告是否已设置
+    jw_key(&w, "tls");
+    jw_string(&w, cfg.tls_psk[0] ? "on" : "off");
+    // 页面据此决定是否显示 WiFi 设置 (只在配网模式下提供)
+    jw_key(&w, "provisioning");
+    jw_bool(&w, s_provisioning);
+    jw_object_end(&w);
+    return json_send_finish(req, &w);
+}
+
+// 表单中最长的值 (过滤模式或 TLS 密钥)
+#define BRIDGE_VALUE_MAX (UART_FILTER_PATTERNS_MAX > BRIDGE_CFG_PSK_MAX ? \
+                          UART_FILTER_PATTERNS_MAX : BRIDGE_CFG_PSK_MAX)
+
+// TLS 密钥经明文 HTTP 提交: 已有密钥时须同时提交当前密钥 (psk_old)，
+// 首个密钥只接受配网模式 (设备自身热点) 下的设置，避免局域网内任何人抢先设置或替换
+static bool psk_change_allowed(const char *body, const bridge_config_t *cfg)
+{
+    char encoded[3 * (BRIDGE_CFG_PSK_MAX + 1) + 1];
+    char current[BRIDGE_CFG_PSK_MAX + 2];
+
+    if (cfg->tls_psk[0] == '\0') {
+        return s_provisioning;
+    }
+    if (httpd_query_key_value(body, "psk_old", encoded, sizeof(encoded)) != ESP_OK) {
+        return false;
+    }
+    url_decode(current, encoded, sizeof(current));
+    return bridge_config_psk_equal(cfg, current);
+}
+
+/* HTTP POST Handler - 修改桥接运行参数，表单中未出现的项保持不变 */
+static esp_err_t bridge_post_handler(httpd_req_t *req)
+{
+    static const char *keys[] = { "port", "baud", "chunk", "cache", "filter", "patterns", "context", "psk" };
+    char buf[448];
+    int total_len = req->content_len;
+    int cur_len = 0;
+
+    if (total_len >= (int)sizeof(buf)) {
+        const char *msg = "Request too long";
+        httpd_resp_set_status(req, "400 Bad Request");
+        httpd_resp_send(req, msg, strlen(msg));
+        return ESP_FAIL;
+    }
+    while (cur_len < total_len) {
+        int received = httpd_req_recv(req, buf + cur_len, total_len - cur_len);
+        if (received <= 0) {
+            if (received == HTTPD_SOCK_ERR_TIMEOUT) httpd_resp_send_408(req);
+            return ESP_FAIL;
+        }
+        cur_len += received;
+    }
+    buf[total_len] = '\0';
+
+    bridge_config_t cfg;
+    tcp_bridge_get_config(&cfg);
+
+    for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+        // 多留一个字节，超长的值解码后仍超长，由 bridge_config_set 拒绝而不是被截断
+        char encoded[3 * (BRIDGE_VALUE_MAX + 1) + 1];
+        char value[BRIDGE_VALUE_MAX + 2];
+        esp_err_t err = httpd_query_key_value(buf, keys[i], encoded, sizeof(encoded));
+        if ((err != ESP_OK && err != ESP_ERR_HTTPD_RESULT_TRUNC) || encoded[0] == '\0') {
+            continue;
+        }
+        if (strcmp(keys[i], "psk") == 0 && !psk_change_allowed(buf, &cfg)) {
+            const char *msg = cfg.tls_psk[0] ? "Current TLS key required" :
+                              "The first TLS key can only be set during provisioning";
+            httpd_resp_set_status(req, "403 Forbidden");
+            httpd_resp_send(req, msg, strlen(msg));
+            return ESP_OK;
+        }
+        url_decode(value, encoded, sizeof(value));
+        if (err != ESP_OK || bridge_config_set(&cfg, keys[i], value) != ESP_OK) {
+            char msg[32];
+            snprintf(msg, sizeof(msg), "Invalid %s", keys[i]);
+            httpd_resp_set_status(req, "400 Bad Request");
+            httpd_resp_send(req, msg, strlen(msg));
+            return ESP_OK;
+        }
+    }
+
+    if (tcp_bridge_apply_config(&cfg) != ESP_OK) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    const char *resp_str = "Saved. Buffer size changes apply once all bridge clients disconnect.";
+    httpd_resp_send(req, resp_str, strlen(resp_str));
+    return ESP_OK;
+}
+
+/* HTTP GET Handler - 返回桥接统计 (JSON) */
+static esp_err_t stats_get_handler(httpd_req_t *req)
+{
+    bridge_stats_t st;
+    tcp_bridge_get_stats(&st);
+
+    char json[768];
+    bridge_stats_format_json(&st, json, sizeof(json));
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    httpd_resp_send(req, json, strlen(json));
+    return ESP_OK;
+}
+
 /* 注册 URI */
 static const httpd_uri_t root_uri = { .uri = "/", .method = HTTP_GET, .handler = root_get_handler, .user_ctx = NULL };
 static const httpd_uri_t scan_uri = { .uri = "/scan", .method = HTTP_GET, .handler = scan_get_handler, .user_ctx = NULL };
 static const httpd_uri_t config_uri = { .uri = "/config", .method = HTTP_POST, .handler = wifi_config_post_handler, .user_ctx = NULL };
+static const httpd_uri_t bridge_get_uri = { .uri = "/bridge", .method = HTTP_GET, .handler = bridge_get_handler, .user_ctx = NULL };
+static const httpd_uri_t bridge_post_uri = { .uri = "/bridge", .method = HTTP_POST, .handler = bridge_post_handler, .user_ctx = NULL };
+static const httpd_uri_t stats_uri = { .uri = "/stats", .method = HTTP_GET, .handler = stats_get_handler, .user_ctx = NULL };
 
 static void start_webserver()
 {
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    // 与桥接服务共用 CONFIG_LWIP_MAX_SOCKETS，限制并发连接数
+    config.max_open_sockets = WEB_MAX_OPEN_SOCKETS;
+    config.lru_purge_enable = true;
     
     ESP_LOGI(TAG, "Starting webserver on port: '%d'", config.server_port);
     if (httpd_start(&server, &config) == ESP_OK) {
         httpd_register_uri_handler(server, &root_uri);
-        httpd_register_uri_handler(server, &scan_uri); // 注册扫描接口
-        httpd_register_uri_handler(server, &config_uri);
+        // 修改 WiFi 凭据 (随后重启) 与扫描 (STA 离开信道，打断桥接会话) 只在配网模式下提供，
+        // STA 模式下服务整个局域网，只保留桥接参数与统计
+        if (s_provisioning) {
+            httpd_register_uri_handler(server, &scan_uri); // 注册扫描接口
+            httpd_register_uri_handler(server, &config_uri);
+        }
+        httpd_register_uri_handler(server, &bridge_get_uri);
+        httpd_register_uri_handler(server, &bridge_post_uri);
+        httpd_register_uri_handler(server, &stats_uri);
     }
 }
 
@@ -368,8 +674,25 @@ void wifi_init_softap_sta(void)
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
     ESP_ERROR_CHECK(esp_wifi_init(&cfg));
 
+    const esp_timer_create_args_t retry_timer_args = {
+        .callback = retry_timer_cb,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "wifi_retry",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&retry_timer_args, &s_retry_timer));
+    const esp_timer_create_args_t restart_timer_args = {
+        .callback = restart_timer_cb,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "wifi_restart",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&restart_timer_args, &s_restart_timer));
+
     ESP_ERROR_CHECK(esp_event_handler_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &wifi_event_handler, NULL));
     ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &wifi_event_handler, NULL));
+    ESP_ERROR_CHECK(esp_event_handler_register(WIFI_PROV_EVENT, WIFI_PROV_EVENT_CONNECT_REFUSED, &wifi_event_handler, NULL));
+    wifi_scan_init();
 
     wifi_config_t wifi_config;
     ESP_ERROR_CHECK(esp_wifi_get_config(WIFI_IF_STA, &wifi_config));
@@ -377,8 +700,29 @@ void wifi_init_softap_sta(void)
     if (wifi_config.sta.ssid[0] != 0) {
         ESP_LOGI(TAG, "NVS config found (SSID: %s). Starting in STA Mode.", wifi_config.sta.ssid);
         ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
+#if WIFI_FAST_CONNECT > 0
+        const esp_timer_create_args_t fast_timer_args = {
+            .callback = fast_timeout_cb,
+            .arg = NULL,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "wifi_fast",
+        };
+        esp_timer_create(&fast_timer_args, &s_fast_timer);
+#if WIFI_FAST_STATIC_IP > 0
+        const esp_timer_create_args_t fast_dhcp_timer_args = {
+            .callback = fast_dhcp_timeout_cb,
+            .arg = NULL,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "wifi_fast_dhcp",
+        };
+        esp_timer_create(&fast_dhcp_timer_args, &s_fast_dhcp_timer);
+#endif
+        fast_connect_prepare(&wifi_config);
+#endif
         ESP_ERROR_CHECK(esp_wifi_start());
         ESP_ERROR_CHECK(esp_wifi_connect());
+        // 保留 WebServer 用于修改桥接参数
+        start_webserver();
     } else {
          ESP_LOGI(TAG, "No NVS config. Starting AP+STA for Provisioning.");
          wifi_config_t ap_config = {
@@ -394,6 +738,9 @@ void wifi_init_softap_sta(void)
          ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_APSTA));
          ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_AP, &ap_config));
          ESP_ERROR_CHECK(esp_wifi_start());
+         s_provisioning = true;   // 须在 start_webserver 之前设置
+         // 提前扫描一次，手机打开页面时列表已经就绪
+         wifi_scan_request(false);
          start_webserver();
     }
 }
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include "wifi_scan.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_wifi.h"
+#include "esp_event.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+static const char *TAG = "WiFi_Scan";
+
+static SemaphoreHandle_t s_lock;
+static wifi_scan_ap_t s_aps[WIFI_SCAN_MAX_AP];
+static int s_count = 0;
+static uint32_t s_gen = 0;
+static int64_t s_done_us = 0;       // 最近一次成功扫描的完成时间
+static int64_t s_started_us = 0;
+static bool s_scanning = false;
+
+// 把一条原始记录并入表中: 同名取信号更强者，表满时替换最弱的一条
+static void scan_merge(const wifi_ap_record_t *rec) {
+    int weakest = -1;
+
+    if (rec->ssid[0] == 0) {
+        return;
+    }
+    for (int i = 0; i < s_count; i++) {
+        if (strcmp(s_aps[i].ssid, (const char *)rec->ssid) == 0) {
+            if (rec->rssi > s_aps[i].rssi) {
+                memcpy(s_aps[i].bssid, rec->bssid, 6);
+                s_aps[i].rssi = rec->rssi;
+                s_aps[i].authmode = rec->authmode;
+            }
+            return;
+        }
+        if (weakest < 0 || s_aps[i].rssi < s_aps[weakest].rssi) {
+            weakest = i;
+        }
+    }
+
+    int slot = s_count;
+    if (s_count == WIFI_SCAN_MAX_AP) {
+        if (rec->rssi <= s_aps[weakest].rssi) {
+            return;
+        }
+        slot = weakest;
+    } else {
+        s_count++;
+    }
+    strncpy(s_aps[slot].ssid, (const char *)rec->ssid, sizeof(s_aps[slot].ssid) - 1);
+    s_aps[slot].ssid[sizeof(s_aps[slot].ssid) - 1] = '\0';
+    memcpy(s_aps[slot].bssid, rec->bssid, 6);
+    s_aps[slot].rssi = rec->rssi;
+    s_aps[slot].authmode = rec->authmode;
+}
+
+// 按 RSSI 从强到弱插入排序 (条目很少)
+static void scan_sort(void) {
+    for (int i = 1; i < s_count; i++) {
+        wifi_scan_ap_t ap = s_aps[i];
+        int j = i;
+        while (j > 0 && s_aps[j - 1].rssi < ap.rssi) {
+            s_aps[j] = s_aps[j - 1];
+            j--;
+        }
+        s_aps[j] = ap;
+    }
+}
+
+static void scan_done_handler(void *arg, esp_event_base_t event_base,
+                              int32_t event_id, void *event_data) {
+    (void)arg;
+    (void)event_base;
+    (void)event_id;
+    wifi_event_sta_scan_done_t *done = (wifi_event_sta_scan_done_t *)event_data;
+    uint16_t n = 0;
+    wifi_ap_record_t *recs = NULL;
+
+    if (done->status == 0) {
+        esp_wifi_scan_get_ap_num(&n);
+        if (n > WIFI_SCAN_RAW_MAX) n = WIFI_SCAN_RAW_MAX;
+        // 至少分配一条，驱动内部的结果列表只在取记录时释放
+        recs = malloc((n ? n : 1) * sizeof(wifi_ap_record_t));
+    }
+    // 取回记录同时释放驱动内部的结果列表
+    if (recs == NULL || esp_wifi_scan_get_ap_records(&n, recs) != ESP_OK) {
+        ESP_LOGW(TAG, "Scan failed (status %u)", done->status);
+        free(recs);
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        s_scanning = false;
+        xSemaphoreGive(s_lock);
+        return;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_count = 0;
+    for (int i = 0; i < n; i++) {
+        scan_merge(&recs[i]);
+    }
+    scan_sort();
+    s_gen++;
+    s_done_us = esp_timer_get_time();
+    s_scanning = false;
+    xSemaphoreGive(s_lock);
+
+    ESP_LOGI(TAG, "Scan done in %d ms: %u APs, %d networks",
+             (int)((s_done_us - s_started_us) / 1000), done->number, s_count);
+    free(recs);
+}
+
+void wifi_scan_init(void) {
+    s_lock = xSemaphoreCreateMutex();
+    ESP_ERROR_CHECK(esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_SCAN_DONE, &scan_done_handler, NULL));
+}
+
+bool wifi_scan_request(bool force) {
+    int64_t now = esp_timer_get_time();
+    bool start;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (s_scanning && now - s_started_us > WIFI_SCAN_TIMEOUT_MS * 1000LL) {
+        ESP_LOGW(TAG, "Scan timed out");
+        s_scanning = false;
+    }
+    if (s_scanning) {
+        start = false;
+    } else if (s_gen == 0) {
+        start = true;
+    } else {
+        int64_t age = now - s_done_us;
+        start = age > WIFI_SCAN_TTL_MS * 1000LL ||
+                (force && age > WIFI_SCAN_MIN_INTERVAL_MS * 1000LL);
+    }
+    if (start) {
+        s_scanning = true;
+        s_started_us = now;
+    }
+    bool busy = s_scanning;
+    xSemaphoreGive(s_lock);
+
+    if (!start) {
+        return busy;
+    }
+
+    wifi_scan_config_t scan_config = {
+        .ssid = NULL,
+        .bssid = NULL,
+        .channel = 0,
+        .show_hidden = false    // 隐藏网络不收录，无需上报
+    };
+    esp_err_t err = esp_wifi_scan_start(&scan_config, false);
+    if (err != ESP_OK) {
+        // 例如 STA 正在连接: 放弃本次，下一次查询再试
+        ESP_LOGW(TAG, "Unable to start scan (0x%x)", err);
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        s_scanning = false;
+        xSemaphoreGive(s_lock);
+        return false;
+    }
+    return true;
+}
+
+void wifi_scan_info(wifi_scan_info_t *info) {
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    info->gen = s_gen;
+    info->age_ms = s_gen ? (uint32_t)((esp_timer_get_time() - s_done_us) / 1000) : 0;
+    info->scanning = s_scanning;
+    xSemaphoreGive(s_lock);
+}
+
+bool wifi_scan_entry(uint32_t gen, int index, wifi_scan_ap_t *ap) {
+    bool ok;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    ok = gen == s_gen && index >= 0 && index < s_count;
+    if (ok) {
+        *ap = s_aps[index];
+    }
+    xSemaphoreGive(s_lock);
+    return ok;
+}
@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+#
+# 分帧上行协议的主机端客户端 (Port 8889 / 8890 / UDP 上行)
+# 解析 DATA / GAP / DATA_LZ 记录，还原串口数据流写到 stdout，丢失与时间戳信息写到 stderr
+#
+# 用法:
+#   python3 bridge_client.py 192.168.4.1                # 分帧 (8889)
+#   python3 bridge_client.py 192.168.4.1 -p 8890        # 分帧 + 压缩 (固件中启用 FRAMED_LZ_PORT)
+#   python3 bridge_client.py 192.168.4.1 -t > uart.log  # 每条记录打印采集时间
+#   python3 bridge_client.py 192.168.4.1 -c 1           # 只输出附加串口通道 1 的数据
+#   python3 bridge_client.py 239.255.88.88 -u -p 8891   # 订阅 UDP 组播上行 (单播时填本机地址或 0.0.0.0)
+#
+# 记录格式见 main/include/bridge_frame.h
+
+import argparse
+import socket
+import struct
+import sys
+
+FRAME_HDR = struct.Struct('>BBHIQ')
+UDP_SEQ = struct.Struct('>I')
+
+FRAME_DATA = 0x01
+FRAME_GAP = 0x02
+FRAME_DATA_LZ = 0x03
+
+FRAME_F_TS_APPROX = 0x01
+FRAME_CHANNEL_SHIFT = 4  # flags 高 4 位为串口通道号，0 为 UART0
+
+
+def lz4_block_decompress(src, raw_len):
+    """解压一个 LZ4 block (纯 Python，无第三方依赖)"""
+    dst = bytearray()
+    i = 0
+    n = len(src)
+    while i < n:
+        token = src[i]
+        i += 1
+
+        lit = token >> 4
+        if lit == 15:
+            while True:
+                b = src[i]
+                i += 1
+                lit += b
+                if b != 255:
+                    break
+        dst += src[i:i + lit]
+        i += lit
+        if i >= n:
+            break  # 最后一个序列只有字面量
+
+        offset = src[i] | (src[i + 1] << 8)
+        i += 2
+        if offset == 0 or offset > len(dst):
+            raise ValueError('bad match offset %d' % offset)
+
+        mlen = token & 0x0F
+        if mlen == 15:
+            while True:
+                b = src[i]
+                i += 1
+                mlen += b
+                if b != 255:
+                    break
+        mlen += 4
+
+        # 匹配区域可能与输出重叠，逐字节复制
+        start = len(dst) - offset
+        for k in range(mlen):
+            dst.append(dst[start + k])
+
+    if len(dst) != raw_len:
+        raise ValueError('decoded %d bytes, expected %d' % (len(dst), raw_len))
+    return bytes(dst)
+
+
+def recv_exact(sock, n):
+    buf = bytearray()
+    while len(buf) < n:
+        chunk = sock.recv(n - len(buf))
+        if not chunk:
+            raise EOFError
+        buf += chunk
+    return bytes(buf)
+
+
+def handle_record(header, payload, timestamps, channel):
+    """处理一条记录，返回还原出的串口数据 (只返回指定通道的数据，各通道的 offset 独立编号)"""
+    rtype, flags, length, offset, ts_us = header
+    if flags >> FRAME_CHANNEL_SHIFT != channel:
+        return b''
+
+    if rtype == FRAME_GAP:
+        lost, = struct.unpack('>I', payload)
+        sys.stderr.write('[gap] %d bytes lost at offset %d (t=%.6f s)\n'
+                         % (lost, offset, ts_us / 1e6))
+        return b''
+
+    if rtype == FRAME_DATA_LZ:
+        raw_len, = struct.unpack('>H', payload[:2])
+        data = lz4_block_decompress(payload[2:], raw_len)
+    elif rtype == FRAME_DATA:
+        data = payload
+    else:
+        sys.stderr.write('[warn] unknown record type %d skipped\n' % rtype)
+        return b''
+
+    if timestamps:
+        sys.stderr.write('[data] offset %d, %d bytes, t=%.6f s%s\n'
+                         % (offset, len(data), ts_us / 1e6,
+                            ' (approx)' if flags & FRAME_F_TS_APPROX else ''))
+    return data
+
+
+def udp_socket(group, port):
+    """绑定 UDP 端口，group 为组播地址时加入该组"""
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM, socket.IPPROTO_UDP)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    sock.bind(('', port))
+    if socket.inet_aton(group)[0] & 0xF0 == 0xE0:
+        mreq = struct.pack('4s4s', socket.inet_aton(group), socket.inet_aton('0.0.0.0'))
+        sock.setsockopt(socket.IPPROTO_IP, socket.IP_ADD_MEMBERSHIP, mreq)
+    return sock
+
+
+def main():
+    parser = argparse.ArgumentParser(description='ESP UART bridge framed uplink client')
+    parser.add_argument('host')
+    parser.add_argument('-p', '--port', type=int, default=8889)
+    parser.add_argument('-u', '--udp', action='store_true',
+                        help='receive UDP uplink datagrams (host is the multicast group)')
+    parser.add_argument('-t', '--timestamps', action='store_true',
+                        help='print offset and capture time of every record to stderr')
+    parser.add_argument('-c', '--channel', type=int, default=0,
+                        help='UART channel written to stdout (0 = UART0, 1.. = aux soft UARTs)')
+    args = parser.parse_args()
+
+    out = sys.stdout.buffer
+    raw_bytes = 0
+    wire_bytes = 0
+    dgram_lost = 0
+
+    if args.udp:
+        sock = udp_socket(args.host, args.port)
+    else:
+        sock = socket.create_connection((args.host, args.port))
+
+    try:
+        expect_seq = None
+        while True:
+            if args.udp:
+                dgram = sock.recv(2048)
+                if len(dgram) < UDP_SEQ.size + FRAME_HDR.size:
+                    continue
+                seq, = UDP_SEQ.unpack_from(dgram)
+                # 序号不连续说明网络丢包 (设备重启后序号从 0 开始)
+                if expect_seq is not None and seq != expect_seq:
+                    missed = (seq - expect_seq) & 0xFFFFFFFF
+                    if missed < 0x80000000:
+                        sys.stderr.write('[loss] %d datagrams missing before #%d\n' % (missed, seq))
+                        dgram_lost += missed
+                expect_seq = (seq + 1) & 0xFFFFFFFF
+                header = FRAME_HDR.unpack_from(dgram, UDP_SEQ.size)
+                payload = dgram[UDP_SEQ.size + FRAME_HDR.size:]
+                wire_bytes += len(dgram)
+            else:
+                header = FRAME_HDR.unpack(recv_exact(sock, FRAME_HDR.size))
+                payload = recv_exact(sock, header[2])
+                wire_bytes += FRAME_HDR.size + len(payload)
+
+            data = handle_record(header, payload, args.timestamps, args.channel)
+            if data:
+                raw_bytes += len(data)
+                out.write(data)
+                out.flush()
+    except (EOFError, KeyboardInterrupt):
+        pass
+    finally:
+        sock.close()
+        if dgram_lost:
+            sys.stderr.write('[done] %d datagrams lost in transit\n' % dgram_lost)
+        if wire_bytes:
+            sys.stderr.write('[done] %d bytes of UART data, %d bytes on the wire (%.1f%%)\n'
+                             % (raw_bytes, wire_bytes, 100.0 * wire_bytes / max(raw_bytes, 1)))
+
+
+if __name__ == '__main__':
+    main()
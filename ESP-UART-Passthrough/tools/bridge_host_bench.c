@@ -0,0 +1,471 @@
+/*
+ * 桥接 (main/src/tcp_bridge.c) 的主机端吞吐与时延测试
+ *
+ * tcp_bridge.c 连同拆分出的模块原样编译，SDK 接口由 tools/host_shim 提供 (FreeRTOS -> pthread，
+ * 串口 -> socketpair，见 host_shim/driver/uart.h)，数据走与设备上相同的
+ * 驱动事件 -> 守护任务 -> 环形缓冲区 -> I/O 任务 -> TCP 路径
+ *
+ * 编译运行:
+ *   gcc -O2 -pthread -Itools/host_shim -Imain/include tools/bridge_host_bench.c tools/host_shim/host_shim.c \
+ *       main/src/tcp_bridge.c main/src/bridge_config.c main/src/bridge_stats.c main/src/bridge_ctl.c \
+ *       main/src/bridge_udp.c main/src/bridge_lat.c main/src/bridge_framer.c main/src/ringbuf.c \
+ *       main/src/rfc2217.c main/src/bridge_rfc2217.c main/src/uart_filter.c main/src/lz_codec.c \
+ *       main/src/utils.c -o bridge_host_bench && ./bridge_host_bench
+ *   ./bridge_host_bench -r 0 -c 3 -t 10      # 不限速，3 个客户端，运行 10 秒
+ *   ./bridge_host_bench -s baud=921600 -s cache=32768 -s port=9888   # 运行参数同控制端口
+ *
+ * 参数:
+ *   -r 速率   目标设备输出速率 (字节/秒)，默认为所配波特率 8N1 的线速 (115200 波特即 11520)；
+ *             0 表示不限速，超出任何串口的线速，用于检验溢出与丢失统计
+ *   -b 字节   每次写入串口的字节数 (16 的倍数，相当于目标设备一次连续输出)，默认 64
+ *   -c 个数   原始协议客户端数 (1..3)，默认 1
+ *   -t 秒     运行时长，默认 5
+ *   -i 秒     报告周期，默认 1
+ *   -s 键=值  运行参数，同控制端口的 set 命令 (bridge_config_set)，可重复
+ *   -v        输出桥接日志 (默认只输出错误)
+ *
+ * 串口数据是 16 字节记录: 魔数、序号、写入时刻。客户端按记录统计:
+ * - MB/s: 所有客户端合计收到的字节数
+ * - 时延: 写入串口到客户端收到的时间，p50 / p99 / p999 为所在桶的上界 (桶宽约 12%)
+ * - 丢失: 按序号缺口折算的字节数；另列驱动缓冲区满与桥接统计的丢弃数 (bridge_stats.h)
+ * - CPU: 桥接各任务 (含 esp_timer) 消耗的 CPU 时间除以客户端收到的字节数，不含串口泵线程
+ * 序号倒退或客户端意外断开视为失败
+ * 开始前先向控制端口发送残缺与非法的命令，每条都须得到应答
+ *
+ * 须使用 tcp_bridge.c 的默认开关编译: TLS_PORT / BRIDGE_SPOOL / BRIDGE_BENCH 为 0，
+ * 附加通道 (bridge_aux.h) 不启用；原始协议客户端走零拷贝发送 (BRIDGE_TX_ZEROCOPY)，由 host_shim 模拟；
+ * 监听的端口与设备相同，被占用时用 -s port=... 修改原始端口
+ */
+#define _GNU_SOURCE
+#include "tcp_bridge.h"
+#include "bridge_config.h"
+#include "host_shim.h"
+#include "esp_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define REC_LEN 16
+#define REC_MAGIC 0x42524447u      // "BRDG"
+#define MAX_CLIENTS 3          // 同 tcp_bridge.c 的 BRIDGE_MAX_CLIENTS
+#define CTL_PORT 8880              // 同 tcp_bridge.c 的 CONTROL_PORT
+#define MAX_BURST 4096
+#define MAX_LAG_NS 10000000ULL     // 生成落后超过 10ms 时不再追赶，避免突发
+
+// 时延直方图: 每个 2 的幂区间再分 8 个子桶
+#define LAT_SUB_BITS 3
+#define LAT_SUB (1 << LAT_SUB_BITS)
+#define LAT_BUCKETS (48 * LAT_SUB)
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    memcpy(p, &v, 4);
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+// ==========================================
+// 时延直方图
+// ==========================================
+static int lat_bucket(uint64_t ns) {
+    if (ns < LAT_SUB) return (int)ns;
+    int e = 63 - __builtin_clzll(ns);
+    int i = (e - LAT_SUB_BITS + 1) * LAT_SUB + (int)((ns >> (e - LAT_SUB_BITS)) & (LAT_SUB - 1));
+    return i < LAT_BUCKETS ? i : LAT_BUCKETS - 1;
+}
+
+// 桶的上界 (纳秒)
+static uint64_t lat_bucket_upper(int i) {
+    if (i < LAT_SUB) return i + 1;
+    int e = i / LAT_SUB + LAT_SUB_BITS - 1;
+    uint64_t sub = i % LAT_SUB;
+    return (LAT_SUB + sub + 1) << (e - LAT_SUB_BITS);
+}
+
+static uint64_t lat_percentile(const uint64_t *hist, uint64_t total, uint32_t permille) {
+    if (total == 0) return 0;
+    uint64_t rank = (total * permille + 999) / 1000;
+    uint64_t acc = 0;
+    for (int i = 0; i < LAT_BUCKETS; i++) {
+        acc += hist[i];
+        if (acc >= rank) return lat_bucket_upper(i);
+    }
+    return lat_bucket_upper(LAT_BUCKETS - 1);
+}
+
+// ==========================================
+// 客户端
+// ==========================================
+typedef struct {
+    int sock;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    // 以下由 lock 保护
+    uint64_t bytes;
+    uint64_t records;
+    uint64_t lost_records;      // 序号缺口
+    uint64_t resyncs;           // 缓存覆盖后按魔数重新对齐的次数
+    uint64_t errors;            // 序号倒退
+    bool closed;
+    uint64_t hist[LAT_BUCKETS];
+} client_t;
+
+static client_t s_clients[MAX_CLIENTS];
+static int s_num_clients = 1;
+static volatile bool s_stop = false;
+
+static void *client_thread(void *arg) {
+    client_t *c = arg;
+    uint8_t buf[16384 + REC_LEN];
+    size_t have = 0;
+    bool synced = false;
+    uint32_t expect = 0;
+
+    while (!s_stop) {
+        ssize_t n = recv(c->sock, buf + have, sizeof(buf) - have, 0);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) continue;
+            break;
+        }
+        uint64_t t = now_ns();
+        have += n;
+
+        pthread_mutex_lock(&c->lock);
+        c->bytes += n;
+        size_t off = 0;
+        while (have - off >= REC_LEN) {
+            const uint8_t *r = buf + off;
+            if (get_u32(r) != REC_MAGIC) {
+                // 缓存被覆盖后数据流从任意位置继续，逐字节寻找下一条记录
+                if (synced) c->resyncs++;
+                synced = false;
+                off++;
+                continue;
+            }
+            uint32_t seq = get_u32(r + 4);
+            uint64_t sent;
+            memcpy(&sent, r + 8, 8);
+            if (synced && seq != expect) {
+                if ((int32_t)(seq - expect) > 0) {
+                    c->lost_records += seq - expect;
+                } else {
+                    c->errors++;
+                }
+            }
+            synced = true;
+            expect = seq + 1;
+            c->records++;
+            c->hist[lat_bucket(t > sent ? t - sent : 0)]++;
+            off += REC_LEN;
+        }
+        pthread_mutex_unlock(&c->lock);
+        memmove(buf, buf + off, have - off);
+        have -= off;
+    }
+
+    pthread_mutex_lock(&c->lock);
+    c->closed = !s_stop;
+    pthread_mutex_unlock(&c->lock);
+    return NULL;
+}
+
+static int client_connect(uint16_t port) {
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(port) };
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    // 监听由桥接的 I/O 任务建立，启动后稍等片刻
+    for (int tries = 0; tries < 50; tries++) {
+        int sock = socket(AF_INET, SOCK_STREAM, 0);
+        if (sock < 0) return -1;
+        if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) == 0) return sock;
+        close(sock);
+        usleep(20000);
+    }
+    return -1;
+}
+
+// ==========================================
+// 控制端口: 残缺与非法的命令都应得到一行应答，不能让桥接崩溃
+// ==========================================
+static bool ctl_check(void) {
+    static const char *const lines[] = {
+        "set", "set psk", "set psk new", "set psk new old extra", "set baud", "set nokey 1",
+        "set baud 1", "bogus", "get",
+    };
+    int sock = client_connect(CTL_PORT);
+    if (sock < 0) {
+        printf("FAIL: cannot connect to control port %u\n", CTL_PORT);
+        return false;
+    }
+    struct timeval tv = { .tv_sec = 1 };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(lines) / sizeof(lines[0]) && ok; i++) {
+        char cmd[64], reply[512];
+        int len = snprintf(cmd, sizeof(cmd), "%s\n", lines[i]);
+        size_t got = 0;
+        ok = send(sock, cmd, len, 0) == len;
+        // 读到行尾为止；超时或断开即失败
+        while (ok && (got == 0 || reply[got - 1] != '\n')) {
+            ssize_t n = recv(sock, reply + got, sizeof(reply) - 1 - got, 0);
+            ok = n > 0 && got + n < sizeof(reply) - 1;
+            if (ok) got += n;
+        }
+        if (!ok) printf("FAIL: no control reply to \"%s\"\n", lines[i]);
+    }
+    close(sock);
+    return ok;
+}
+
+// ==========================================
+// 目标设备: 按速率向串口写入记录
+// ==========================================
+static int64_t s_rate = -1;
+static size_t s_burst = 64;
+static volatile uint64_t s_generated = 0;
+
+static void *generator_thread(void *arg) {
+    (void)arg;
+    int fd = host_uart_line_fd();
+    uint8_t burst[MAX_BURST];
+    uint32_t seq = 0;
+    uint64_t next = now_ns();
+    uint64_t interval = s_rate > 0 ? s_burst * 1000000000ULL / s_rate : 0;
+
+    while (!s_stop) {
+        if (interval > 0) {
+            uint64_t t = now_ns();
+            if (next > t) {
+                struct timespec ts = { .tv_sec = next / 1000000000ULL, .tv_nsec = next % 1000000000ULL };
+                clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+            } else if (t - next > MAX_LAG_NS) {
+                next = t;
+            }
+            next += interval;
+        }
+
+        uint64_t t = now_ns();
+        for (size_t off = 0; off < s_burst; off += REC_LEN) {
+            put_u32(burst + off, REC_MAGIC);
+            put_u32(burst + off + 4, seq++);
+            memcpy(burst + off + 8, &t, 8);
+        }
+        size_t done = 0;
+        while (done < s_burst) {
+            ssize_t n = write(fd, burst + done, s_burst - done);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return NULL;
+            }
+            done += n;
+        }
+        s_generated += s_burst;
+    }
+    return NULL;
+}
+
+// 桥接写往串口的下行数据 (本测试不发送下行，正常情况下不会有数据) 读出丢弃，避免线路写满阻塞
+static void *line_drain_thread(void *arg) {
+    (void)arg;
+    int fd = host_uart_line_fd();
+    uint8_t buf[1024];
+    while (recv(fd, buf, sizeof(buf), 0) > 0) {
+    }
+    return NULL;
+}
+
+// ==========================================
+// 报告
+// ==========================================
+typedef struct {
+    uint64_t t_ns;
+    uint64_t generated;
+    uint64_t bytes;
+    uint64_t records;
+    uint64_t lost_records;
+    uint64_t resyncs;
+    uint64_t errors;
+    uint64_t uart_dropped;
+    uint64_t cpu_ns;
+    uint32_t client_dropped;
+    uint32_t rb_overwritten;
+    int closed;
+    uint64_t hist[LAT_BUCKETS];
+} snapshot_t;
+
+static void snapshot(snapshot_t *s) {
+    memset(s, 0, sizeof(*s));
+    s->t_ns = now_ns();
+    s->generated = s_generated;
+    s->uart_dropped = host_uart_rx_dropped();
+    s->cpu_ns = host_task_cpu_ns();
+    for (int i = 0; i < s_num_clients; i++) {
+        client_t *c = &s_clients[i];
+        pthread_mutex_lock(&c->lock);
+        s->bytes += c->bytes;
+        s->records += c->records;
+        s->lost_records += c->lost_records;
+        s->resyncs += c->resyncs;
+        s->errors += c->errors;
+        s->closed += c->closed;
+        for (int b = 0; b < LAT_BUCKETS; b++) {
+            s->hist[b] += c->hist[b];
+        }
+        pthread_mutex_unlock(&c->lock);
+    }
+    bridge_stats_t st;
+    tcp_bridge_get_stats(&st);
+    s->client_dropped = st.client_dropped;
+    s->rb_overwritten = st.rb_overwritten;
+}
+
+static void report(const char *label, const snapshot_t *a, const snapshot_t *b) {
+    static uint64_t hist[LAT_BUCKETS];
+    uint64_t samples = 0;
+    for (int i = 0; i < LAT_BUCKETS; i++) {
+        hist[i] = b->hist[i] - a->hist[i];
+        samples += hist[i];
+    }
+    double secs = (b->t_ns - a->t_ns) / 1e9;
+    uint64_t bytes = b->bytes - a->bytes;
+
+    printf("%-6s gen %7.3f MB/s  recv %7.3f MB/s  latency p50 <%.0fus p99 <%.0fus p999 <%.0fus  "
+           "lost %llu B (uart %llu, ring %u, client %u)  cpu %.1f ns/B\n",
+           label, (b->generated - a->generated) / secs / 1e6, bytes / secs / 1e6,
+           lat_percentile(hist, samples, 500) / 1e3,
+           lat_percentile(hist, samples, 990) / 1e3,
+           lat_percentile(hist, samples, 999) / 1e3,
+           (unsigned long long)((b->lost_records - a->lost_records) * REC_LEN),
+           (unsigned long long)(b->uart_dropped - a->uart_dropped),
+           (unsigned)(b->rb_overwritten - a->rb_overwritten),
+           (unsigned)(b->client_dropped - a->client_dropped),
+           bytes > 0 ? (double)(b->cpu_ns - a->cpu_ns) / bytes : 0.0);
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "usage: %s [-r bytes_per_s] [-b burst] [-c clients] [-t seconds] [-i seconds] "
+            "[-s key=value]... [-v]\n", prog);
+}
+
+int main(int argc, char **argv) {
+    bridge_config_t cfg;
+    bridge_config_defaults(&cfg);
+    int seconds = 5, interval = 1;
+    host_log_level = ESP_LOG_ERROR;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "r:b:c:t:i:s:v")) != -1) {
+        switch (opt) {
+            case 'r': s_rate = strtoll(optarg, NULL, 10); break;
+            case 'b': s_burst = strtoul(optarg, NULL, 10); break;
+            case 'c': s_num_clients = atoi(optarg); break;
+            case 't': seconds = atoi(optarg); break;
+            case 'i': interval = atoi(optarg); break;
+            case 'v': host_log_level = ESP_LOG_INFO; break;
+            case 's': {
+                char *eq = strchr(optarg, '=');
+                if (!eq) {
+                    usage(argv[0]);
+                    return 2;
+                }
+                *eq = '\0';
+                if (bridge_config_set(&cfg, optarg, eq + 1) != ESP_OK) {
+                    fprintf(stderr, "invalid setting %s=%s\n", optarg, eq + 1);
+                    return 2;
+                }
+                break;
+            }
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+    if (s_rate < 0) s_rate = cfg.baudrate / 10;
+    if (s_burst < REC_LEN || s_burst > MAX_BURST || s_burst % REC_LEN != 0) {
+        fprintf(stderr, "burst must be a multiple of %d up to %d\n", REC_LEN, MAX_BURST);
+        return 2;
+    }
+    if (s_num_clients < 1 || s_num_clients > MAX_CLIENTS || seconds < 1 || interval < 1) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    // 运行参数经 NVS 替身交给桥接，与设备上重启后载入的路径相同
+    if (bridge_config_save(&cfg) != ESP_OK) return 1;
+    tcp_bridge_init();
+
+    if (!ctl_check()) {
+        fflush(stdout);
+        _exit(1);
+    }
+
+    pthread_t gen, drain;
+    pthread_create(&drain, NULL, line_drain_thread, NULL);
+    for (int i = 0; i < s_num_clients; i++) {
+        client_t *c = &s_clients[i];
+        pthread_mutex_init(&c->lock, NULL);
+        c->sock = client_connect(cfg.tcp_port);
+        if (c->sock < 0) {
+            fprintf(stderr, "cannot connect to bridge port %u\n", cfg.tcp_port);
+            return 1;
+        }
+        pthread_create(&c->thread, NULL, client_thread, c);
+    }
+    // 等桥接接受全部连接再开始生成，否则早到的数据只发给部分客户端
+    usleep(100000);
+    pthread_create(&gen, NULL, generator_thread, NULL);
+
+    printf("bridge host bench: %s, burst %zu B, %d client(s), cache %u B, chunk %u B\n",
+           s_rate > 0 ? "rate-limited" : "unthrottled", s_burst, s_num_clients,
+           (unsigned)cfg.cache_size, (unsigned)cfg.chunk_size);
+    if (s_rate > 0) printf("target rate %.3f MB/s\n", s_rate / 1e6);
+
+    static snapshot_t start, prev, cur;
+    snapshot(&start);
+    prev = start;
+    for (int t = interval; t <= seconds; t += interval) {
+        sleep(interval);
+        snapshot(&cur);
+        char label[16];
+        snprintf(label, sizeof(label), "%ds", t);
+        report(label, &prev, &cur);
+        prev = cur;
+    }
+    s_stop = true;
+    report("total", &start, &cur);
+
+    int failed = 0;
+    if (cur.errors > 0) {
+        printf("FAIL: %llu sequence regressions\n", (unsigned long long)cur.errors);
+        failed = 1;
+    }
+    if (cur.closed > 0) {
+        printf("FAIL: %d client(s) disconnected\n", cur.closed);
+        failed = 1;
+    }
+    if (cur.records == 0) {
+        printf("FAIL: no data received\n");
+        failed = 1;
+    }
+    printf("%s (%llu records, %llu resyncs)\n", failed ? "FAILED" : "PASSED",
+           (unsigned long long)cur.records, (unsigned long long)cur.resyncs);
+    // 桥接任务不会退出，直接结束进程
+    fflush(stdout);
+    _exit(failed);
+}
@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+#
+# 轮询桥接统计端口 (UDP 8881)，打印各环节计数及与上一次的差值
+#
+# 用法:
+#   python3 bridge_stats.py 192.168.4.1            # 每秒一次
+#   python3 bridge_stats.py 192.168.4.1 --once     # 只查询一次
+#
+# 快照格式见 main/include/bridge_stats.h
+
+import argparse
+import socket
+import struct
+import sys
+import time
+
+STATS_MAGIC = 0x4253
+
+# 与 bridge_stats_t 成员顺序一致，设备端新增的字段按序号显示
+FIELDS = [
+    'uptime_s',
+    'uart_rx_bytes', 'uart_fifo_ovf', 'uart_buffer_full', 'uart_frame_err', 'uart_parity_err',
+    'rb_high_water', 'rb_overwritten',
+    'tx_bytes', 'tx_segments', 'tx_eagain', 'tx_partial', 'client_dropped',
+    'lat_p50_us', 'lat_p99_us',
+    'sessions_total', 'sessions_active', 'session_s_total', 'session_s_max',
+    'filter_out', 'filter_matches',
+    'dl_bytes', 'dl_stalls',
+]
+
+# 快照值而非累计值，不显示差值
+GAUGES = {'uptime_s', 'rb_high_water', 'lat_p50_us', 'lat_p99_us', 'sessions_active', 'session_s_max'}
+
+
+def query(sock, addr, timeout):
+    sock.settimeout(timeout)
+    sock.sendto(b'?', addr)
+    data, _ = sock.recvfrom(512)
+    magic, version, count = struct.unpack_from('>HBB', data)
+    if magic != STATS_MAGIC or len(data) < 4 + 4 * count:
+        raise ValueError('bad stats snapshot')
+    values = struct.unpack_from('>%dI' % count, data, 4)
+    names = FIELDS + ['field_%d' % i for i in range(len(FIELDS), count)]
+    return dict(zip(names, values))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='ESP UART bridge statistics')
+    parser.add_argument('host')
+    parser.add_argument('-p', '--port', type=int, default=8881)
+    parser.add_argument('-i', '--interval', type=float, default=1.0)
+    parser.add_argument('--once', action='store_true', help='query once and exit')
+    args = parser.parse_args()
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    addr = (args.host, args.port)
+    prev = None
+    try:
+        while True:
+            try:
+                cur = query(sock, addr, 1.0)
+            except socket.timeout:
+                sys.stderr.write('[warn] no reply from %s:%d\n' % addr)
+            else:
+                for name, value in cur.items():
+                    delta = ''
+                    if prev is not None and name not in GAUGES and name in prev:
+                        delta = ' (+%d)' % ((value - prev[name]) & 0xFFFFFFFF)
+                    print('%-18s %10d%s' % (name, value, delta))
+                print()
+                prev = cur
+            if args.once:
+                break
+            time.sleep(args.interval)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        sock.close()
+
+
+if __name__ == '__main__':
+    main()
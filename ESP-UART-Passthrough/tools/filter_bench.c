@@ -0,0 +1,183 @@
+/*
+ * 串口过滤器 (main/src/uart_filter.c) 的主机端性能测试
+ *
+ * 编译运行:
+ *   gcc -O2 -Imain/include tools/filter_bench.c main/src/uart_filter.c -o filter_bench && ./filter_bench
+ *
+ * 每种输入 x 每种模式按守护任务的读取块大小 (512 字节) 逐块喂入，输出:
+ * - 平均每字节耗时与吞吐
+ * - 单块耗时的 99.9 分位: 过滤器对每个字节的处理步数有上界，最坏输入 (大量部分匹配)
+ *   与普通日志的耗时应在同一量级，而不是随模式数量或匹配深度增长
+ *   (不取最大值，主机上的调度与缺页会带来毫秒级的偶发抖动)
+ * 同时以朴素的逐行 strstr 实现校验行模式的输出
+ */
+#define _GNU_SOURCE
+#include "uart_filter.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define INPUT_SIZE (4 * 1024 * 1024)
+#define CHUNK 512
+#define LINE_RATE_BPS (4000000 / 10)  // 4 Mbaud 下的字节速率
+
+static const char *PATTERNS = "ERROR|panic|assert failed|Guru Meditation|WDT";
+
+typedef struct {
+    uint8_t *buf;
+    size_t len;
+} sink_t;
+
+static void sink_emit(void *ctx, const uint8_t *data, size_t len) {
+    sink_t *s = ctx;
+    memcpy(s->buf + s->len, data, len);
+    s->len += len;
+}
+
+static void null_emit(void *ctx, const uint8_t *data, size_t len) {
+    (void)ctx;
+    (void)data;
+    (void)len;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// 普通日志: 80 字符左右的行，约 1% 含错误关键字
+static void gen_log(uint8_t *buf, size_t len) {
+    size_t i = 0;
+    unsigned n = 0;
+    while (i < len) {
+        char line[128];
+        int l = snprintf(line, sizeof(line), "I (%u) app: sensor=%u value=%u status=%s\n",
+                         n, n % 7, (n * 2654435761u) >> 20, n % 97 == 0 ? "ERROR timeout" : "ok");
+        n++;
+        for (int k = 0; k < l && i < len; k++) buf[i++] = (uint8_t)line[k];
+    }
+}
+
+// 随机二进制
+static void gen_random(uint8_t *buf, size_t len) {
+    uint32_t x = 12345;
+    for (size_t i = 0; i < len; i++) {
+        x = x * 1103515245 + 12345;
+        buf[i] = (uint8_t)(x >> 16);
+    }
+}
+
+// 最坏情况: 反复出现长的部分匹配且从不命中，行长接近 LINE_MAX，每行都要逐字节匹配到结尾
+static void gen_adversarial(uint8_t *buf, size_t len) {
+    static const char frag[] = "Guru MeditatioGuru MeditERROpaniassert faileWD";
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = i % (UART_FILTER_LINE_MAX - 1) == UART_FILTER_LINE_MAX - 2 ?
+                 '\n' : (uint8_t)frag[i % (sizeof(frag) - 1)];
+    }
+}
+
+// 朴素实现: 逐行 strstr (仅用于校验，要求行长小于 UART_FILTER_LINE_MAX)
+static size_t reference_lines(const uint8_t *in, size_t len, uint8_t mode, uint8_t *out) {
+    char pats[128];
+    strcpy(pats, PATTERNS);
+    char *list[UART_FILTER_MAX_PATTERNS];
+    int np = 0;
+    char *save;
+    for (char *p = strtok_r(pats, "|", &save); p; p = strtok_r(NULL, "|", &save)) list[np++] = p;
+
+    size_t o = 0;
+    size_t start = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (in[i] != '\n') continue;
+        size_t l = i + 1 - start;
+        bool hit = false;
+        for (int k = 0; k < np && !hit; k++) {
+            hit = memmem(in + start, l, list[k], strlen(list[k])) != NULL;
+        }
+        if (hit == (mode == UART_FILTER_PASS)) {
+            memcpy(out + o, in + start, l);
+            o += l;
+        }
+        start = i + 1;
+    }
+    return o;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void run(const char *name, const uint8_t *in, size_t len, uint8_t mode, uint32_t context) {
+    static const char *mode_names[] = { "off", "pass", "drop", "capture" };
+    uart_filter_t f;
+    if (!uart_filter_init(&f, mode, PATTERNS, context)) {
+        printf("init failed\n");
+        exit(1);
+    }
+
+    size_t chunks = (len + CHUNK - 1) / CHUNK;
+    uint64_t *dt = malloc(chunks * sizeof(uint64_t));
+    uint64_t start = now_ns();
+    for (size_t i = 0; i < len; i += CHUNK) {
+        size_t n = len - i < CHUNK ? len - i : CHUNK;
+        uint64_t t0 = now_ns();
+        uart_filter_feed(&f, in + i, n, null_emit, NULL);
+        dt[i / CHUNK] = now_ns() - t0;
+    }
+    uint64_t total = now_ns() - start;
+    qsort(dt, chunks, sizeof(uint64_t), cmp_u64);
+    uint64_t p999 = dt[chunks * 999 / 1000];
+    free(dt);
+
+    double ns_per_byte = (double)total / len;
+    printf("%-12s %-8s %7.2f ns/B %8.1f MB/s  chunk p99.9 %6.1f us  (%5.0fx line rate)  out %5.1f%%  matches %u\n",
+           name, mode_names[mode], ns_per_byte, 1e3 / ns_per_byte, p999 / 1e3,
+           1e9 / ns_per_byte / LINE_RATE_BPS, 100.0 * f.bytes_out / f.bytes_in, (unsigned)f.matches);
+    uart_filter_deinit(&f);
+}
+
+static void verify(const uint8_t *in, size_t len, uint8_t mode) {
+    uart_filter_t f;
+    uart_filter_init(&f, mode, PATTERNS, 0);
+    uint8_t *got = malloc(len);
+    uint8_t *want = malloc(len);
+    sink_t s = { got, 0 };
+    for (size_t i = 0; i < len; i += 61) {  // 奇数块长，覆盖跨块的匹配与换行
+        uart_filter_feed(&f, in + i, len - i < 61 ? len - i : 61, sink_emit, &s);
+    }
+    size_t wlen = reference_lines(in, len, mode, want);
+    if (s.len != wlen || memcmp(got, want, wlen) != 0) {
+        printf("MISMATCH in mode %u: got %zu bytes, expected %zu\n", mode, s.len, wlen);
+        exit(1);
+    }
+    free(got);
+    free(want);
+    uart_filter_deinit(&f);
+}
+
+int main(void) {
+    uint8_t *log = malloc(INPUT_SIZE);
+    uint8_t *rnd = malloc(INPUT_SIZE);
+    uint8_t *adv = malloc(INPUT_SIZE);
+    gen_log(log, INPUT_SIZE);
+    gen_random(rnd, INPUT_SIZE);
+    gen_adversarial(adv, INPUT_SIZE);
+
+    verify(log, INPUT_SIZE, UART_FILTER_PASS);
+    verify(log, INPUT_SIZE, UART_FILTER_DROP);
+    printf("line modes match reference implementation\n\n");
+
+    const struct { const char *name; const uint8_t *buf; } inputs[] = {
+        { "log", log }, { "random", rnd }, { "adversarial", adv },
+    };
+    for (int i = 0; i < 3; i++) {
+        for (uint8_t mode = UART_FILTER_OFF; mode <= UART_FILTER_CAPTURE; mode++) {
+            run(inputs[i].name, inputs[i].buf, INPUT_SIZE, mode, 2048);
+        }
+    }
+    return 0;
+}
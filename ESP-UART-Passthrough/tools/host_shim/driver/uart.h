@@ -0,0 +1,75 @@
+#ifndef HOST_UART_H
+#define HOST_UART_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+// UART 驱动的主机端替身: 串口线路是一对 socket，另一端见 host_shim.h 的 host_uart_line_fd()
+// - 接收: 泵线程从线路读取数据写入驱动接收缓冲区，按 FIFO 阈值投递 UART_DATA 事件，
+//   线路上暂时没有更多数据时投递不足阈值的事件 (相当于 RX 超时)
+// - 接收缓冲区满时丢弃新到的数据并投递 UART_BUFFER_FULL，与没有流控的硬件一样
+// - 发送: uart_write_bytes 直接写入线路 (阻塞)，波特率等参数只记录不生效
+
+typedef enum { UART_NUM_0, UART_NUM_1, UART_NUM_MAX } uart_port_t;
+typedef enum { UART_DATA_5_BITS, UART_DATA_6_BITS, UART_DATA_7_BITS, UART_DATA_8_BITS } uart_word_length_t;
+typedef enum { UART_STOP_BITS_1 = 1, UART_STOP_BITS_1_5 = 2, UART_STOP_BITS_2 = 3 } uart_stop_bits_t;
+typedef enum { UART_PARITY_DISABLE = 0, UART_PARITY_EVEN = 2, UART_PARITY_ODD = 3 } uart_parity_t;
+typedef enum {
+    UART_HW_FLOWCTRL_DISABLE,
+    UART_HW_FLOWCTRL_RTS,
+    UART_HW_FLOWCTRL_CTS,
+    UART_HW_FLOWCTRL_CTS_RTS,
+} uart_hw_flowcontrol_t;
+
+typedef struct {
+    int baud_rate;
+    uart_word_length_t data_bits;
+    uart_parity_t parity;
+    uart_stop_bits_t stop_bits;
+    uart_hw_flowcontrol_t flow_ctrl;
+    uint8_t rx_flow_ctrl_thresh;
+} uart_config_t;
+
+#define UART_RXFIFO_FULL_INT_ENA_M (1 << 0)
+#define UART_PARITY_ERR_INT_ENA_M (1 << 2)
+#define UART_FRM_ERR_INT_ENA_M (1 << 3)
+#define UART_RXFIFO_OVF_INT_ENA_M (1 << 4)
+#define UART_RXFIFO_TOUT_INT_ENA_M (1 << 8)
+
+typedef struct {
+    uint32_t intr_enable_mask;
+    uint8_t rx_timeout_thresh;
+    uint8_t txfifo_empty_intr_thresh;
+    uint8_t rxfifo_full_thresh;
+} uart_intr_config_t;
+
+typedef enum {
+    UART_DATA,
+    UART_BUFFER_FULL,
+    UART_FIFO_OVF,
+    UART_FRAME_ERR,
+    UART_PARITY_ERR,
+    UART_EVENT_MAX,
+} uart_event_type_t;
+
+typedef struct {
+    uart_event_type_t type;
+    size_t size;
+} uart_event_t;
+
+esp_err_t uart_driver_install(uart_port_t uart_num, int rx_buffer_size, int tx_buffer_size,
+                              int queue_size, QueueHandle_t *uart_queue, int no_use);
+esp_err_t uart_param_config(uart_port_t uart_num, uart_config_t *cfg);
+esp_err_t uart_intr_config(uart_port_t uart_num, uart_intr_config_t *cfg);
+esp_err_t uart_set_baudrate(uart_port_t uart_num, uint32_t baud_rate);
+esp_err_t uart_enable_swap(void);
+int uart_read_bytes(uart_port_t uart_num, uint8_t *buf, uint32_t length, TickType_t ticks_to_wait);
+int uart_write_bytes(uart_port_t uart_num, const char *src, size_t size);
+esp_err_t uart_wait_tx_done(uart_port_t uart_num, TickType_t ticks_to_wait);
+esp_err_t uart_flush_input(uart_port_t uart_num);
+esp_err_t uart_get_buffered_data_len(uart_port_t uart_num, size_t *size);
+
+#endif // HOST_UART_H
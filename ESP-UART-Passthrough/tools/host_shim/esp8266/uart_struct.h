@@ -0,0 +1,26 @@
+#ifndef HOST_UART_STRUCT_H
+#define HOST_UART_STRUCT_H
+
+#include <stdint.h>
+
+// 只保留桥接用到的寄存器位，写入没有效果
+typedef struct {
+    union {
+        struct {
+            uint32_t parity: 1;
+            uint32_t parity_en: 1;
+            uint32_t bit_num: 2;
+            uint32_t stop_bit_num: 2;
+            uint32_t reserved6: 11;
+            uint32_t rxfifo_rst: 1;
+            uint32_t txfifo_rst: 1;
+            uint32_t reserved19: 13;
+        };
+        uint32_t val;
+    } conf0;
+} uart_dev_t;
+
+extern volatile uart_dev_t uart0;
+extern volatile uart_dev_t uart1;
+
+#endif // HOST_UART_STRUCT_H
@@ -0,0 +1,32 @@
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+// FreeRTOS 的主机端替身: 任务即 pthread，优先级与栈大小被忽略 (实现见 host_shim.c)
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define configTICK_RATE_HZ 100
+#define portTICK_RATE_MS (1000 / configTICK_RATE_HZ)
+#define portTICK_PERIOD_MS portTICK_RATE_MS
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms) / portTICK_RATE_MS)
+#define portMAX_DELAY 0xffffffffu
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+
+// 临界区用一把全局递归锁代替关中断
+void host_enter_critical(void);
+void host_exit_critical(void);
+#define portENTER_CRITICAL() host_enter_critical()
+#define portEXIT_CRITICAL() host_exit_critical()
+
+#endif // HOST_FREERTOS_H
@@ -0,0 +1,15 @@
+#ifndef HOST_SEMPHR_H
+#define HOST_SEMPHR_H
+
+#include "queue.h"
+
+// 信号量即元素大小为 0 的队列，与 FreeRTOS 的实现方式相同
+typedef QueueHandle_t SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count);
+#define xSemaphoreCreateBinary() xSemaphoreCreateCounting(1, 0)
+#define xSemaphoreCreateMutex() xSemaphoreCreateCounting(1, 1)
+#define xSemaphoreTake(sem, ticks) xQueueReceive((sem), NULL, (ticks))
+#define xSemaphoreGive(sem) xQueueSend((sem), NULL, 0)
+
+#endif // HOST_SEMPHR_H
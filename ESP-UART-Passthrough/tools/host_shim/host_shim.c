@@ -0,0 +1,833 @@
+/*
+ * SDK 接口的主机端实现，用于在 Linux 上编译运行 tcp_bridge.c (见 tools/bridge_host_bench.c)
+ *
+ * - FreeRTOS 任务 / 队列 / 信号量 / 任务通知: pthread + 互斥锁与条件变量
+ * - esp_timer: 单个定时器线程按到期时间依次执行回调
+ * - UART 驱动: socketpair 作为串口线路，泵线程模拟接收中断 (见 driver/uart.h)
+ * - NVS: 内存中的字符串表
+ * - 零拷贝发送 (bridge_zerocopy.h): 非阻塞 send()，未确认字节数取自 SIOCOUTQ
+ */
+#define _GNU_SOURCE
+#include "host_shim.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "driver/uart.h"
+#include "driver/gpio.h"
+#include "esp8266/uart_struct.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "nvs.h"
+#include "lwip/sockets.h"
+#include "bridge_zerocopy.h"
+#include <pthread.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <linux/sockios.h>
+
+// 接口签名与 SDK 一致，串口号、栈大小、优先级等参数在主机上没有意义
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+static uint64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// 启动后的第一次调用作为 tick 与 esp_timer 的零点
+static uint64_t s_boot_ns;
+
+static void boot_init(void) {
+    s_boot_ns = mono_ns();
+}
+
+static uint64_t boot_ns(void) {
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    pthread_once(&once, boot_init);
+    return s_boot_ns;
+}
+
+// 先取零点再读时钟，第一次调用时两者的先后不能颠倒
+static uint64_t uptime_ns(void) {
+    uint64_t boot = boot_ns();
+    return mono_ns() - boot;
+}
+
+static void cond_init(pthread_cond_t *cond) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+static struct timespec deadline_after_ns(uint64_t ns) {
+    uint64_t t = mono_ns() + ns;
+    struct timespec ts = { .tv_sec = t / 1000000000ULL, .tv_nsec = t % 1000000000ULL };
+    return ts;
+}
+
+// 在已持有 lock 的情况下等待 cond，deadline 为 NULL 表示不超时；超时返回 false
+static bool cond_wait_until(pthread_cond_t *cond, pthread_mutex_t *lock, const struct timespec *deadline) {
+    if (!deadline) {
+        pthread_cond_wait(cond, lock);
+        return true;
+    }
+    return pthread_cond_timedwait(cond, lock, deadline) == 0;
+}
+
+static struct timespec *ticks_deadline(TickType_t ticks, struct timespec *ts) {
+    if (ticks == portMAX_DELAY) return NULL;
+    *ts = deadline_after_ns((uint64_t)ticks * portTICK_RATE_MS * 1000000ULL);
+    return ts;
+}
+
+// ==========================================
+// 临界区
+// ==========================================
+static pthread_mutex_t s_critical = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+
+void host_enter_critical(void) {
+    pthread_mutex_lock(&s_critical);
+}
+
+void host_exit_critical(void) {
+    pthread_mutex_unlock(&s_critical);
+}
+
+// ==========================================
+// 任务
+// ==========================================
+struct host_task {
+    TaskFunction_t fn;
+    void *arg;
+    char name[16];
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t notify;
+    clockid_t cpu_clock;
+    bool counted;               // 计入 host_task_cpu_ns
+    struct host_task *next;
+};
+
+static pthread_mutex_t s_tasks_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct host_task *s_tasks;
+static __thread struct host_task *t_self;
+
+static struct host_task *task_alloc(TaskFunction_t fn, void *arg, const char *name) {
+    struct host_task *t = calloc(1, sizeof(*t));
+    if (!t) return NULL;
+    t->fn = fn;
+    t->arg = arg;
+    snprintf(t->name, sizeof(t->name), "%s", name ? name : "");
+    pthread_mutex_init(&t->lock, NULL);
+    cond_init(&t->cond);
+    return t;
+}
+
+static void *task_entry(void *p) {
+    struct host_task *t = p;
+    t_self = t;
+    pthread_setname_np(pthread_self(), t->name);
+    if (pthread_getcpuclockid(pthread_self(), &t->cpu_clock) == 0) {
+        pthread_mutex_lock(&s_tasks_lock);
+        t->counted = true;
+        t->next = s_tasks;
+        s_tasks = t;
+        pthread_mutex_unlock(&s_tasks_lock);
+    }
+    t->fn(t->arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                       UBaseType_t priority, TaskHandle_t *handle) {
+    struct host_task *t = task_alloc(fn, arg, name);
+    if (!t) return pdFAIL;
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, task_entry, t) != 0) {
+        free(t);
+        return pdFAIL;
+    }
+    pthread_detach(thread);
+    if (handle) *handle = t;
+    return pdPASS;
+}
+
+// 非 xTaskCreate 创建的线程 (如 main) 首次使用任务接口时分配一个不计时的任务对象
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    if (!t_self) t_self = task_alloc(NULL, NULL, "foreign");
+    return t_self;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    uint64_t ns = (uint64_t)ticks * portTICK_RATE_MS * 1000000ULL;
+    struct timespec ts = { .tv_sec = ns / 1000000000ULL, .tv_nsec = ns % 1000000000ULL };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(uptime_ns() / (portTICK_RATE_MS * 1000000ULL));
+}
+
+void vTaskDelayUntil(TickType_t *prev_wake, TickType_t increment) {
+    *prev_wake += increment;
+    TickType_t now = xTaskGetTickCount();
+    if ((int32_t)(*prev_wake - now) > 0) {
+        vTaskDelay(*prev_wake - now);
+    }
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    pthread_mutex_lock(&task->lock);
+    task->notify++;
+    pthread_cond_signal(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks) {
+    struct host_task *t = xTaskGetCurrentTaskHandle();
+    struct timespec ts, *deadline = ticks_deadline(ticks, &ts);
+
+    pthread_mutex_lock(&t->lock);
+    while (t->notify == 0 && ticks > 0) {
+        if (!cond_wait_until(&t->cond, &t->lock, deadline)) break;
+    }
+    uint32_t value = t->notify;
+    if (value > 0) {
+        t->notify = clear_on_exit ? 0 : value - 1;
+    }
+    pthread_mutex_unlock(&t->lock);
+    return value;
+}
+
+uint64_t host_task_cpu_ns(void) {
+    uint64_t total = 0;
+    pthread_mutex_lock(&s_tasks_lock);
+    for (struct host_task *t = s_tasks; t; t = t->next) {
+        struct timespec ts;
+        if (t->counted && clock_gettime(t->cpu_clock, &ts) == 0) {
+            total += (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+        }
+    }
+    pthread_mutex_unlock(&s_tasks_lock);
+    return total;
+}
+
+// ==========================================
+// 队列 / 信号量
+// ==========================================
+struct host_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    UBaseType_t length;
+    UBaseType_t item_size;      // 0 即信号量，只计数
+    UBaseType_t count;
+    UBaseType_t head;
+    uint8_t *items;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    struct host_queue *q = calloc(1, sizeof(*q));
+    if (!q) return NULL;
+    q->items = malloc(length * item_size + 1);
+    if (!q->items) {
+        free(q);
+        return NULL;
+    }
+    q->length = length;
+    q->item_size = item_size;
+    pthread_mutex_init(&q->lock, NULL);
+    cond_init(&q->not_empty);
+    cond_init(&q->not_full);
+    return q;
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count) {
+    QueueHandle_t q = xQueueCreate(max_count, 0);
+    if (q) q->count = initial_count;
+    return q;
+}
+
+static BaseType_t queue_send(QueueHandle_t q, const void *item, TickType_t ticks, bool front) {
+    struct timespec ts, *deadline = ticks_deadline(ticks, &ts);
+
+    pthread_mutex_lock(&q->lock);
+    while (q->count == q->length) {
+        if (ticks == 0 || !cond_wait_until(&q->not_full, &q->lock, deadline)) {
+            pthread_mutex_unlock(&q->lock);
+            return pdFAIL;
+        }
+    }
+    UBaseType_t slot;
+    if (front) {
+        q->head = (q->head + q->length - 1) % q->length;
+        slot = q->head;
+    } else {
+        slot = (q->head + q->count) % q->length;
+    }
+    if (q->item_size > 0) {
+        memcpy(q->items + slot * q->item_size, item, q->item_size);
+    }
+    q->count++;
+    pthread_cond_signal(&q->not_empty);
+    pthread_mutex_unlock(&q->lock);
+    return pdPASS;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticks) {
+    return queue_send(q, item, ticks, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t q, const void *item, TickType_t ticks) {
+    return queue_send(q, item, ticks, true);
+}
+
+static BaseType_t queue_receive(QueueHandle_t q, void *item, TickType_t ticks, bool remove) {
+    struct timespec ts, *deadline = ticks_deadline(ticks, &ts);
+
+    pthread_mutex_lock(&q->lock);
+    while (q->count == 0) {
+        if (ticks == 0 || !cond_wait_until(&q->not_empty, &q->lock, deadline)) {
+            pthread_mutex_unlock(&q->lock);
+            return pdFAIL;
+        }
+    }
+    if (q->item_size > 0 && item) {
+        memcpy(item, q->items + q->head * q->item_size, q->item_size);
+    }
+    if (remove) {
+        q->head = (q->head + 1) % q->length;
+        q->count--;
+        pthread_cond_signal(&q->not_full);
+    }
+    pthread_mutex_unlock(&q->lock);
+    return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticks) {
+    return queue_receive(q, item, ticks, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t q, void *item, TickType_t ticks) {
+    return queue_receive(q, item, ticks, false);
+}
+
+BaseType_t xQueueReset(QueueHandle_t q) {
+    pthread_mutex_lock(&q->lock);
+    q->count = 0;
+    q->head = 0;
+    pthread_cond_broadcast(&q->not_full);
+    pthread_mutex_unlock(&q->lock);
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+    pthread_mutex_lock(&q->lock);
+    UBaseType_t n = q->count;
+    pthread_mutex_unlock(&q->lock);
+    return n;
+}
+
+// ==========================================
+// esp_timer
+// ==========================================
+struct host_timer {
+    esp_timer_cb_t callback;
+    void *arg;
+    bool armed;
+    uint64_t due_us;
+    uint64_t period_us;         // 0 表示单次
+    struct host_timer *next;
+};
+
+static pthread_mutex_t s_timer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_timer_cond;
+static struct host_timer *s_timers;
+
+int64_t esp_timer_get_time(void) {
+    return (int64_t)(uptime_ns() / 1000);
+}
+
+static void timer_task(void *arg) {
+    pthread_mutex_lock(&s_timer_lock);
+    while (1) {
+        struct host_timer *first = NULL;
+        for (struct host_timer *t = s_timers; t; t = t->next) {
+            if (t->armed && (!first || t->due_us < first->due_us)) first = t;
+        }
+        if (!first) {
+            pthread_cond_wait(&s_timer_cond, &s_timer_lock);
+            continue;
+        }
+        uint64_t now = esp_timer_get_time();
+        if (first->due_us > now) {
+            struct timespec ts = deadline_after_ns((first->due_us - now) * 1000);
+            pthread_cond_timedwait(&s_timer_cond, &s_timer_lock, &ts);
+            continue;
+        }
+        if (first->period_us > 0) {
+            first->due_us += first->period_us;
+        } else {
+            first->armed = false;
+        }
+        esp_timer_cb_t cb = first->callback;
+        void *cb_arg = first->arg;
+        pthread_mutex_unlock(&s_timer_lock);
+        cb(cb_arg);
+        pthread_mutex_lock(&s_timer_lock);
+    }
+}
+
+static void timer_start_task(void) {
+    cond_init(&s_timer_cond);
+    xTaskCreate(timer_task, "esp_timer", 0, NULL, 22, NULL);
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out) {
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    pthread_once(&once, timer_start_task);
+
+    struct host_timer *t = calloc(1, sizeof(*t));
+    if (!t) return ESP_ERR_NO_MEM;
+    t->callback = args->callback;
+    t->arg = args->arg;
+    pthread_mutex_lock(&s_timer_lock);
+    t->next = s_timers;
+    s_timers = t;
+    pthread_mutex_unlock(&s_timer_lock);
+    *out = t;
+    return ESP_OK;
+}
+
+static esp_err_t timer_arm(esp_timer_handle_t timer, uint64_t delay_us, uint64_t period_us) {
+    pthread_mutex_lock(&s_timer_lock);
+    if (timer->armed) {
+        pthread_mutex_unlock(&s_timer_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->armed = true;
+    timer->due_us = esp_timer_get_time() + delay_us;
+    timer->period_us = period_us;
+    pthread_cond_signal(&s_timer_cond);
+    pthread_mutex_unlock(&s_timer_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    return timer_arm(timer, timeout_us, 0);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period_us) {
+    return timer_arm(timer, period_us, period_us);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    pthread_mutex_lock(&s_timer_lock);
+    bool was_armed = timer->armed;
+    timer->armed = false;
+    pthread_mutex_unlock(&s_timer_lock);
+    return was_armed ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    pthread_mutex_lock(&s_timer_lock);
+    for (struct host_timer **p = &s_timers; *p; p = &(*p)->next) {
+        if (*p == timer) {
+            *p = timer->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&s_timer_lock);
+    free(timer);
+    return ESP_OK;
+}
+
+// ==========================================
+// 日志与错误码
+// ==========================================
+esp_log_level_t host_log_level = ESP_LOG_INFO;
+
+void host_log(esp_log_level_t level, const char *tag, const char *fmt, ...) {
+    static const char letters[] = "NEWID";
+    if (level > host_log_level) return;
+    va_list ap;
+    va_start(ap, fmt);
+    flockfile(stderr);
+    fprintf(stderr, "%c (%lld) %s: ", letters[level], (long long)(esp_timer_get_time() / 1000), tag);
+    vfprintf(stderr, fmt, ap);
+    fputc('\n', stderr);
+    funlockfile(stderr);
+    va_end(ap);
+}
+
+const char *esp_err_to_name(esp_err_t err) {
+    switch (err) {
+        case ESP_OK: return "ESP_OK";
+        case ESP_FAIL: return "ESP_FAIL";
+        case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+        case ESP_ERR_NVS_NOT_FOUND: return "ESP_ERR_NVS_NOT_FOUND";
+        default: return "UNKNOWN ERROR";
+    }
+}
+
+// ==========================================
+// NVS
+// ==========================================
+typedef struct nvs_entry {
+    char *key;
+    char *value;
+    struct nvs_entry *next;
+} nvs_entry_t;
+
+static pthread_mutex_t s_nvs_lock = PTHREAD_MUTEX_INITIALIZER;
+static nvs_entry_t *s_nvs;
+
+static nvs_entry_t *nvs_find(const char *key) {
+    for (nvs_entry_t *e = s_nvs; e; e = e->next) {
+        if (strcmp(e->key, key) == 0) return e;
+    }
+    return NULL;
+}
+
+esp_err_t nvs_open(const char *name, nvs_open_mode open_mode, nvs_handle *out_handle) {
+    *out_handle = 1;
+    return ESP_OK;
+}
+
+esp_err_t nvs_get_str(nvs_handle handle, const char *key, char *out, size_t *length) {
+    pthread_mutex_lock(&s_nvs_lock);
+    nvs_entry_t *e = nvs_find(key);
+    esp_err_t err = ESP_OK;
+    if (!e) {
+        err = ESP_ERR_NVS_NOT_FOUND;
+    } else if (!out) {
+        *length = strlen(e->value) + 1;
+    } else if (*length < strlen(e->value) + 1) {
+        err = ESP_ERR_INVALID_SIZE;
+    } else {
+        strcpy(out, e->value);
+        *length = strlen(e->value) + 1;
+    }
+    pthread_mutex_unlock(&s_nvs_lock);
+    return err;
+}
+
+esp_err_t nvs_set_str(nvs_handle handle, const char *key, const char *value) {
+    char *copy = strdup(value);
+    if (!copy) return ESP_ERR_NO_MEM;
+    pthread_mutex_lock(&s_nvs_lock);
+    nvs_entry_t *e = nvs_find(key);
+    if (!e && (e = calloc(1, sizeof(*e))) != NULL) {
+        e->key = strdup(key);
+        e->next = s_nvs;
+        s_nvs = e;
+    }
+    if (e) {
+        free(e->value);
+        e->value = copy;
+    }
+    pthread_mutex_unlock(&s_nvs_lock);
+    return e ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+// 整数键值按十进制字符串保存
+#define NVS_INT_ACCESSORS(suffix, type)                                              \
+    esp_err_t nvs_get_##suffix(nvs_handle handle, const char *key, type *out) {      \
+        char buf[16];                                                                \
+        size_t len = sizeof(buf);                                                    \
+        esp_err_t err = nvs_get_str(handle, key, buf, &len);                         \
+        if (err == ESP_OK) *out = (type)strtoul(buf, NULL, 10);                      \
+        return err;                                                                  \
+    }                                                                                \
+    esp_err_t nvs_set_##suffix(nvs_handle handle, const char *key, type value) {     \
+        char buf[16];                                                                \
+        snprintf(buf, sizeof(buf), "%lu", (unsigned long)value);                     \
+        return nvs_set_str(handle, key, buf);                                        \
+    }
+
+NVS_INT_ACCESSORS(u8, uint8_t)
+NVS_INT_ACCESSORS(u16, uint16_t)
+NVS_INT_ACCESSORS(u32, uint32_t)
+
+esp_err_t nvs_erase_key(nvs_handle handle, const char *key) {
+    pthread_mutex_lock(&s_nvs_lock);
+    for (nvs_entry_t **p = &s_nvs; *p; p = &(*p)->next) {
+        if (strcmp((*p)->key, key) == 0) {
+            nvs_entry_t *e = *p;
+            *p = e->next;
+            free(e->key);
+            free(e->value);
+            free(e);
+            pthread_mutex_unlock(&s_nvs_lock);
+            return ESP_OK;
+        }
+    }
+    pthread_mutex_unlock(&s_nvs_lock);
+    return ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t nvs_commit(nvs_handle handle) {
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle handle) {
+}
+
+// ==========================================
+// GPIO / 网络杂项
+// ==========================================
+volatile uart_dev_t uart0;
+volatile uart_dev_t uart1;
+
+esp_err_t gpio_config(const gpio_config_t *cfg) {
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio, uint32_t level) {
+    return ESP_OK;
+}
+
+char *inet_ntoa_r(struct in_addr addr, char *buf, int buflen) {
+    return inet_ntop(AF_INET, &addr, buf, buflen) ? buf : NULL;
+}
+
+// ==========================================
+// 零拷贝发送
+// 主机内核总会拷贝，这里只重现接口语义: 部分写入、未确认字节数与复位，
+// 使 tcp_bridge.c 的钉住 / 等待确认路径照常运行
+// ==========================================
+// 与设备的 TCP_SND_BUF (sdkconfig) 同量级，未确认的数据不会远多于设备上
+#define HOST_ZC_SNDBUF 2880
+
+struct netconn *bridge_zc_conn(int sock) {
+    if (sock < 0) return NULL;
+    int sndbuf = HOST_ZC_SNDBUF;
+    setsockopt(sock, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+    return (struct netconn *)(intptr_t)(sock + 1);
+}
+
+static int zc_sock(struct netconn *conn) {
+    return (int)(intptr_t)conn - 1;
+}
+
+int bridge_zc_write(struct netconn *conn, const uint8_t *const data[2], const size_t len[2],
+                    uint32_t *inflight) {
+    int sock = zc_sock(conn);
+    int err = 0;
+    socklen_t err_len = sizeof(err);
+    if (getsockopt(sock, SOL_SOCKET, SO_ERROR, &err, &err_len) != 0 || err != 0) {
+        return -1;
+    }
+
+    size_t written = 0;
+    for (int i = 0; i < 2 && len[i] > 0; i++) {
+        int flags = MSG_DONTWAIT | MSG_NOSIGNAL | (i == 0 && len[1] > 0 ? MSG_MORE : 0);
+        ssize_t n = send(sock, data[i], len[i], flags);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return -1;
+        }
+        written += n;
+        if ((size_t)n < len[i]) break;
+    }
+
+    int outq = 0;
+    if (ioctl(sock, SIOCOUTQ, &outq) != 0) return -1;
+    *inflight = (uint32_t)outq;
+    return (int)written;
+}
+
+void bridge_zc_abort(struct netconn *conn) {
+    // 随后的 close() 直接复位连接，丢弃发送队列
+    struct linger lg = { .l_onoff = 1, .l_linger = 0 };
+    setsockopt(zc_sock(conn), SOL_SOCKET, SO_LINGER, &lg, sizeof(lg));
+}
+
+// ==========================================
+// UART 驱动
+// ==========================================
+#define UART_PUMP_READ 1024
+
+static struct {
+    int line[2];                // [0] 桥接一端, [1] 目标设备一端
+    QueueHandle_t events;
+    pthread_mutex_t lock;
+    pthread_cond_t readable;
+    uint8_t *buf;               // 驱动接收缓冲区
+    size_t size;
+    size_t head;
+    size_t count;
+    size_t unreported;          // 已写入缓冲区、尚未投递 UART_DATA 的字节数
+    bool full_reported;         // 本轮缓冲区满已投递过 UART_BUFFER_FULL
+    uint8_t fifo_thresh;
+    uint64_t dropped;
+    uint32_t baud_rate;
+} s_uart = { .line = { -1, -1 }, .fifo_thresh = 120 };
+
+static void uart_post(uart_event_type_t type, size_t size) {
+    uart_event_t ev = { .type = type, .size = size };
+    // 事件队列满时丢弃，与驱动在中断中的行为一致；数据仍在缓冲区中
+    xQueueSend(s_uart.events, &ev, 0);
+}
+
+// 模拟接收中断: 数据按 FIFO 阈值分批投递，线路暂时没有后续数据时投递剩余部分 (RX 超时)
+static void *uart_pump(void *arg) {
+    uint8_t chunk[UART_PUMP_READ];
+
+    while (1) {
+        ssize_t n = read(s_uart.line[0], chunk, sizeof(chunk));
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) continue;
+            return NULL;
+        }
+
+        pthread_mutex_lock(&s_uart.lock);
+        size_t space = s_uart.size - s_uart.count;
+        size_t keep = (size_t)n < space ? (size_t)n : space;
+        for (size_t i = 0; i < keep; i++) {
+            s_uart.buf[(s_uart.head + s_uart.count + i) % s_uart.size] = chunk[i];
+        }
+        s_uart.count += keep;
+        s_uart.unreported += keep;
+        if (keep < (size_t)n) {
+            s_uart.dropped += n - keep;
+            if (!s_uart.full_reported) {
+                s_uart.full_reported = true;
+                uart_post(UART_BUFFER_FULL, 0);
+            }
+        }
+        while (s_uart.unreported >= s_uart.fifo_thresh) {
+            uart_post(UART_DATA, s_uart.fifo_thresh);
+            s_uart.unreported -= s_uart.fifo_thresh;
+        }
+        struct pollfd pfd = { .fd = s_uart.line[0], .events = POLLIN };
+        if (s_uart.unreported > 0 && poll(&pfd, 1, 0) == 0) {
+            uart_post(UART_DATA, s_uart.unreported);
+            s_uart.unreported = 0;
+        }
+        pthread_cond_broadcast(&s_uart.readable);
+        pthread_mutex_unlock(&s_uart.lock);
+    }
+}
+
+esp_err_t uart_driver_install(uart_port_t uart_num, int rx_buffer_size, int tx_buffer_size,
+                              int queue_size, QueueHandle_t *uart_queue, int no_use) {
+    if (s_uart.buf) return ESP_ERR_INVALID_STATE;
+    s_uart.buf = malloc(rx_buffer_size);
+    s_uart.size = rx_buffer_size;
+    s_uart.events = xQueueCreate(queue_size, sizeof(uart_event_t));
+    if (!s_uart.buf || !s_uart.events || socketpair(AF_UNIX, SOCK_STREAM, 0, s_uart.line) != 0) {
+        return ESP_FAIL;
+    }
+    pthread_mutex_init(&s_uart.lock, NULL);
+    cond_init(&s_uart.readable);
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, uart_pump, NULL) != 0) {
+        return ESP_FAIL;
+    }
+    pthread_setname_np(thread, "uart_pump");
+    pthread_detach(thread);
+    if (uart_queue) *uart_queue = s_uart.events;
+    return ESP_OK;
+}
+
+int host_uart_line_fd(void) {
+    return s_uart.line[1];
+}
+
+uint64_t host_uart_rx_dropped(void) {
+    pthread_mutex_lock(&s_uart.lock);
+    uint64_t n = s_uart.dropped;
+    pthread_mutex_unlock(&s_uart.lock);
+    return n;
+}
+
+esp_err_t uart_param_config(uart_port_t uart_num, uart_config_t *cfg) {
+    s_uart.baud_rate = cfg->baud_rate;
+    return ESP_OK;
+}
+
+esp_err_t uart_intr_config(uart_port_t uart_num, uart_intr_config_t *cfg) {
+    if (cfg->rxfifo_full_thresh > 0) {
+        s_uart.fifo_thresh = cfg->rxfifo_full_thresh;
+    }
+    return ESP_OK;
+}
+
+esp_err_t uart_set_baudrate(uart_port_t uart_num, uint32_t baud_rate) {
+    s_uart.baud_rate = baud_rate;
+    return ESP_OK;
+}
+
+esp_err_t uart_enable_swap(void) {
+    return ESP_OK;
+}
+
+int uart_read_bytes(uart_port_t uart_num, uint8_t *buf, uint32_t length, TickType_t ticks_to_wait) {
+    struct timespec ts, *deadline = ticks_deadline(ticks_to_wait, &ts);
+
+    pthread_mutex_lock(&s_uart.lock);
+    while (s_uart.count == 0 && ticks_to_wait > 0) {
+        if (!cond_wait_until(&s_uart.readable, &s_uart.lock, deadline)) break;
+    }
+    size_t n = length < s_uart.count ? length : s_uart.count;
+    for (size_t i = 0; i < n; i++) {
+        buf[i] = s_uart.buf[(s_uart.head + i) % s_uart.size];
+    }
+    s_uart.head = (s_uart.head + n) % s_uart.size;
+    s_uart.count -= n;
+    if (s_uart.count < s_uart.size) {
+        s_uart.full_reported = false;
+    }
+    pthread_mutex_unlock(&s_uart.lock);
+    return (int)n;
+}
+
+int uart_write_bytes(uart_port_t uart_num, const char *src, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = write(s_uart.line[0], src + done, size - done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        done += n;
+    }
+    return (int)size;
+}
+
+esp_err_t uart_wait_tx_done(uart_port_t uart_num, TickType_t ticks_to_wait) {
+    return ESP_OK;
+}
+
+esp_err_t uart_flush_input(uart_port_t uart_num) {
+    pthread_mutex_lock(&s_uart.lock);
+    s_uart.head = 0;
+    s_uart.count = 0;
+    s_uart.unreported = 0;
+    s_uart.full_reported = false;
+    pthread_mutex_unlock(&s_uart.lock);
+    return ESP_OK;
+}
+
+esp_err_t uart_get_buffered_data_len(uart_port_t uart_num, size_t *size) {
+    pthread_mutex_lock(&s_uart.lock);
+    *size = s_uart.count;
+    pthread_mutex_unlock(&s_uart.lock);
+    return ESP_OK;
+}
@@ -0,0 +1,23 @@
+#ifndef HOST_SHIM_H
+#define HOST_SHIM_H
+
+#include <stdint.h>
+
+/**
+ * @brief 串口线路的目标设备一端 (uart_driver_install 之后有效)
+ * 写入即目标设备发出的数据，读出即桥接写往串口的下行数据
+ */
+int host_uart_line_fd(void);
+
+/**
+ * @brief 驱动接收缓冲区满而丢弃的累计字节数
+ */
+uint64_t host_uart_rx_dropped(void);
+
+/**
+ * @brief xTaskCreate 创建的任务与定时器线程累计消耗的 CPU 时间 (纳秒)
+ * 不含串口泵线程 (相当于设备上的硬件与中断)
+ */
+uint64_t host_task_cpu_ns(void);
+
+#endif // HOST_SHIM_H
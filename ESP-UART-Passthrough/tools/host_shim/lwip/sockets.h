@@ -0,0 +1,19 @@
+#ifndef HOST_LWIP_SOCKETS_H
+#define HOST_LWIP_SOCKETS_H
+
+// lwIP 的 BSD socket 接口直接对应主机的 socket
+
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+
+#define closesocket close
+
+char *inet_ntoa_r(struct in_addr addr, char *buf, int buflen);
+
+#endif // HOST_LWIP_SOCKETS_H
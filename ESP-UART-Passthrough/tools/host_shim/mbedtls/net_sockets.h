@@ -0,0 +1,9 @@
+#ifndef HOST_MBEDTLS_NET_SOCKETS_H
+#define HOST_MBEDTLS_NET_SOCKETS_H
+
+#include "ssl.h"
+
+#define MBEDTLS_ERR_NET_SEND_FAILED -0x004E
+#define MBEDTLS_ERR_NET_RECV_FAILED -0x004C
+
+#endif // HOST_MBEDTLS_NET_SOCKETS_H
@@ -0,0 +1,16 @@
+#ifndef HOST_MBEDTLS_SSL_H
+#define HOST_MBEDTLS_SSL_H
+
+#include <stddef.h>
+
+// 主机端构建不支持 TLS (TLS_PORT 须为 0)，只提供 bridge_tls.h 声明用到的类型
+
+typedef struct mbedtls_ssl_context mbedtls_ssl_context;
+typedef int mbedtls_ssl_send_t(void *ctx, const unsigned char *buf, size_t len);
+typedef int mbedtls_ssl_recv_t(void *ctx, unsigned char *buf, size_t len);
+
+#define MBEDTLS_ERR_SSL_WANT_READ -0x6900
+#define MBEDTLS_ERR_SSL_WANT_WRITE -0x6880
+#define MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY -0x7880
+
+#endif // HOST_MBEDTLS_SSL_H
@@ -0,0 +1,30 @@
+#ifndef HOST_NVS_H
+#define HOST_NVS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+// 只保存在内存中的键值 (整数按十进制字符串保存)，每次运行从默认参数开始
+
+typedef uint32_t nvs_handle;
+
+typedef enum {
+    NVS_READONLY,
+    NVS_READWRITE,
+} nvs_open_mode;
+
+esp_err_t nvs_open(const char *name, nvs_open_mode open_mode, nvs_handle *out_handle);
+esp_err_t nvs_get_str(nvs_handle handle, const char *key, char *out, size_t *length);
+esp_err_t nvs_set_str(nvs_handle handle, const char *key, const char *value);
+esp_err_t nvs_get_u8(nvs_handle handle, const char *key, uint8_t *out);
+esp_err_t nvs_get_u16(nvs_handle handle, const char *key, uint16_t *out);
+esp_err_t nvs_get_u32(nvs_handle handle, const char *key, uint32_t *out);
+esp_err_t nvs_set_u8(nvs_handle handle, const char *key, uint8_t value);
+esp_err_t nvs_set_u16(nvs_handle handle, const char *key, uint16_t value);
+esp_err_t nvs_set_u32(nvs_handle handle, const char *key, uint32_t value);
+esp_err_t nvs_erase_key(nvs_handle handle, const char *key);
+esp_err_t nvs_commit(nvs_handle handle);
+void nvs_close(nvs_handle handle);
+
+#endif // HOST_NVS_H
@@ -0,0 +1,7 @@
+#ifndef HOST_SDKCONFIG_H
+#define HOST_SDKCONFIG_H
+
+// 只提供桥接代码用到的项，取值同工程的 sdkconfig
+#define CONFIG_LWIP_MAX_SOCKETS 16
+
+#endif // HOST_SDKCONFIG_H
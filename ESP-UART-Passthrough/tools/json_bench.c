@@ -0,0 +1,537 @@
+/*
+ * 流式 JSON 编码器 (main/src/json_writer.c) 的主机端模糊测试与性能测试
+ *
+ * 编译运行:
+ *   gcc -O2 -Imain/include tools/json_bench.c main/src/json_writer.c -o json_bench && ./json_bench
+ *   ./json_bench 200000     # 指定模糊测试轮数
+ *
+ * 模糊测试: 随机生成嵌套的对象/数组，字符串混入引号、反斜杠、控制字符、合法与非法的 UTF-8，
+ * 与朴素的参考实现逐字节比对，并用严格的解析器检查输出是合法 JSON 且为合法 UTF-8；
+ * 同时检查每次回调不超过块大小、出错后不再回调
+ * 性能测试: 按 /scan 的响应格式编码 N 个 AP，对比原先 sprintf 写入 malloc 缓冲区的做法
+ */
+#include "json_writer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define OUT_MAX (1 << 20)
+
+// ==========================================
+// 输出收集
+// ==========================================
+typedef struct {
+    char *buf;
+    size_t len;
+    unsigned calls;
+    unsigned fail_at;   // 第几次回调返回错误 (0 不注入)
+    int bad_chunk;      // 出现空块、超长块、非末尾的不满块或出错后仍被回调
+    size_t last_chunk;
+} sink_t;
+
+static int sink_flush(void *ctx, const char *data, size_t len) {
+    sink_t *s = ctx;
+    if (s->fail_at && s->calls >= s->fail_at) {
+        s->bad_chunk = 1;   // 已经返回过错误，不应再被调用
+    }
+    s->calls++;
+    if (len == 0 || len > JSON_WRITER_CHUNK || (s->last_chunk && s->last_chunk != JSON_WRITER_CHUNK)) {
+        s->bad_chunk = 1;
+    }
+    s->last_chunk = len;
+    if (s->fail_at && s->calls == s->fail_at) {
+        return 7;
+    }
+    memcpy(s->buf + s->len, data, len);
+    s->len += len;
+    return 0;
+}
+
+static int null_flush(void *ctx, const char *data, size_t len) {
+    (void)ctx;
+    (void)data;
+    (void)len;
+    return 0;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint32_t s_rng = 12345;
+static uint32_t rnd(void) {
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+// ==========================================
+// 参考实现: 按码点值判断合法性 (与编码器按首字节查范围的做法相互独立)
+// ==========================================
+typedef struct {
+    char *buf;
+    size_t len;
+} ref_t;
+
+static void ref_put(ref_t *r, const char *s, size_t n) {
+    memcpy(r->buf + r->len, s, n);
+    r->len += n;
+}
+
+static void ref_string(ref_t *r, const char *str) {
+    const unsigned char *s = (const unsigned char *)str;
+    ref_put(r, "\"", 1);
+    while (*s) {
+        unsigned c = *s;
+        char tmp[8];
+        if (c == '"' || c == '\\') {
+            tmp[0] = '\\';
+            tmp[1] = (char)c;
+            ref_put(r, tmp, 2);
+            s++;
+        } else if (c == '\n') {
+            ref_put(r, "\\n", 2), s++;
+        } else if (c == '\r') {
+            ref_put(r, "\\r", 2), s++;
+        } else if (c == '\t') {
+            ref_put(r, "\\t", 2), s++;
+        } else if (c < 0x20) {
+            snprintf(tmp, sizeof(tmp), "\\u%04x", c);
+            ref_put(r, tmp, 6);
+            s++;
+        } else if (c < 0x80) {
+            ref_put(r, (const char *)s, 1);
+            s++;
+        } else {
+            int n = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 0;
+            unsigned cp = n == 4 ? c & 0x07 : n == 3 ? c & 0x0F : c & 0x1F;
+            int ok = n > 0 && c < 0xF8;
+            for (int i = 1; ok && i < n; i++) {
+                if ((s[i] & 0xC0) != 0x80) ok = 0;
+                else cp = (cp << 6) | (s[i] & 0x3F);
+            }
+            static const unsigned min_cp[5] = { 0, 0, 0x80, 0x800, 0x10000 };
+            if (ok && (cp < min_cp[n] || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF))) ok = 0;
+            if (ok) {
+                ref_put(r, (const char *)s, n);
+                s += n;
+            } else {
+                ref_put(r, "\\ufffd", 6);
+                s++;
+            }
+        }
+    }
+    ref_put(r, "\"", 1);
+}
+
+// ==========================================
+// 严格校验: RFC 8259 语法 + 整体为合法 UTF-8
+// ==========================================
+static const char *v_p, *v_end;
+
+static int v_value(int depth);
+
+static void v_ws(void) {
+    while (v_p < v_end && (*v_p == ' ' || *v_p == '\n' || *v_p == '\r' || *v_p == '\t')) v_p++;
+}
+
+static int v_string(void) {
+    if (v_p >= v_end || *v_p != '"') return 0;
+    v_p++;
+    while (v_p < v_end && *v_p != '"') {
+        unsigned char c = (unsigned char)*v_p;
+        if (c < 0x20) return 0;
+        if (c == '\\') {
+            v_p++;
+            if (v_p >= v_end) return 0;
+            if (*v_p == 'u') {
+                for (int i = 1; i <= 4; i++) {
+                    if (v_p + i >= v_end || !strchr("0123456789abcdefABCDEF", v_p[i]) || !v_p[i]) return 0;
+                }
+                v_p += 5;
+            } else if (strchr("\"\\/bfnrt", *v_p) && *v_p) {
+                v_p++;
+            } else {
+                return 0;
+            }
+        } else {
+            v_p++;
+        }
+    }
+    if (v_p >= v_end) return 0;
+    v_p++;
+    return 1;
+}
+
+static int v_number(void) {
+    const char *start = v_p;
+    if (v_p < v_end && *v_p == '-') v_p++;
+    if (v_p >= v_end || *v_p < '0' || *v_p > '9') return 0;
+    if (*v_p == '0' && v_p + 1 < v_end && v_p[1] >= '0' && v_p[1] <= '9') return 0;
+    while (v_p < v_end && *v_p >= '0' && *v_p <= '9') v_p++;
+    return v_p > start;
+}
+
+static int v_container(int depth, char close) {
+    v_p++;
+    v_ws();
+    if (v_p < v_end && *v_p == close) {
+        v_p++;
+        return 1;
+    }
+    for (;;) {
+        if (close == '}') {
+            v_ws();
+            if (!v_string()) return 0;
+            v_ws();
+            if (v_p >= v_end || *v_p != ':') return 0;
+            v_p++;
+        }
+        if (!v_value(depth + 1)) return 0;
+        v_ws();
+        if (v_p < v_end && *v_p == ',') {
+            v_p++;
+            continue;
+        }
+        if (v_p < v_end && *v_p == close) {
+            v_p++;
+            return 1;
+        }
+        return 0;
+    }
+}
+
+static int v_value(int depth) {
+    v_ws();
+    if (v_p >= v_end || depth > 64) return 0;
+    switch (*v_p) {
+    case '{': return v_container(depth, '}');
+    case '[': return v_container(depth, ']');
+    case '"': return v_string();
+    case 't':
+        if (v_end - v_p < 4 || memcmp(v_p, "true", 4)) return 0;
+        v_p += 4;
+        return 1;
+    case 'f':
+        if (v_end - v_p < 5 || memcmp(v_p, "false", 5)) return 0;
+        v_p += 5;
+        return 1;
+    default: return v_number();
+    }
+}
+
+static int valid_utf8(const unsigned char *s, size_t len) {
+    size_t i = 0;
+    while (i < len) {
+        unsigned c = s[i];
+        int n = c < 0x80 ? 1 : (c & 0xE0) == 0xC0 ? 2 : (c & 0xF0) == 0xE0 ? 3 : (c & 0xF8) == 0xF0 ? 4 : 0;
+        if (n == 0 || i + n > len) return 0;
+        unsigned cp = n == 1 ? c : n == 2 ? c & 0x1F : n == 3 ? c & 0x0F : c & 0x07;
+        for (int k = 1; k < n; k++) {
+            if ((s[i + k] & 0xC0) != 0x80) return 0;
+            cp = (cp << 6) | (s[i + k] & 0x3F);
+        }
+        static const unsigned min_cp[5] = { 0, 0, 0x80, 0x800, 0x10000 };
+        if (n > 1 && (cp < min_cp[n] || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF))) return 0;
+        i += n;
+    }
+    return 1;
+}
+
+static int valid_json(const char *buf, size_t len) {
+    v_p = buf;
+    v_end = buf + len;
+    if (!v_value(0)) return 0;
+    v_ws();
+    return v_p == v_end && valid_utf8((const unsigned char *)buf, len);
+}
+
+// ==========================================
+// 随机文档
+// ==========================================
+static void rand_utf8(char *out, int *pos, unsigned cp) {
+    char *p = out + *pos;
+    if (cp < 0x80) {
+        p[0] = (char)cp;
+        *pos += 1;
+    } else if (cp < 0x800) {
+        p[0] = (char)(0xC0 | (cp >> 6));
+        p[1] = (char)(0x80 | (cp & 0x3F));
+        *pos += 2;
+    } else if (cp < 0x10000) {
+        p[0] = (char)(0xE0 | (cp >> 12));
+        p[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        p[2] = (char)(0x80 | (cp & 0x3F));
+        *pos += 3;
+    } else {
+        p[0] = (char)(0xF0 | (cp >> 18));
+        p[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+        p[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        p[3] = (char)(0x80 | (cp & 0x3F));
+        *pos += 4;
+    }
+}
+
+// 生成不含 '\0' 的随机字符串，长度小于 max (较长的可跨越块边界)
+static void rand_string(char *out, int max) {
+    int len = rnd() % 4 == 0 ? rnd() % max : rnd() % 40;
+    int i = 0;
+    while (i < len && i + 4 < max) {
+        unsigned k = rnd() % 10;
+        if (k < 4) {
+            out[i++] = (char)(0x20 + rnd() % 0x5F);
+        } else if (k == 4) {
+            out[i++] = "\"\\/\n\r\t\b"[rnd() % 7];
+        } else if (k == 5) {
+            out[i++] = (char)(1 + rnd() % 0x1F);
+        } else if (k == 6) {
+            out[i++] = (char)(0x80 + rnd() % 0x80);    // 任意高位字节，多为非法
+        } else if (k == 7) {
+            // 合法码点 (跳过代理区)
+            unsigned cp = rnd() % 0x110000;
+            if (cp >= 0xD800 && cp <= 0xDFFF) cp = 0xFFFD;
+            if (cp == 0) cp = 1;
+            rand_utf8(out, &i, cp);
+        } else if (k == 8) {
+            // 边界附近的非法形式: 超长编码、代理区、超出范围、截断
+            static const char *bad[] = { "\xC0\xAF", "\xE0\x80\xAF", "\xED\xA0\x80", "\xF4\x90\x80\x80",
+                                         "\xF5\x80", "\xE2\x82", "\xF0\x9F\x98", "\xC2", "\xFF" };
+            const char *b = bad[rnd() % 9];
+            size_t n = strlen(b);
+            memcpy(out + i, b, n);
+            i += n;
+        } else {
+            // 恰好位于边界上的合法码点
+            static const unsigned edge[] = { 0x7F, 0x80, 0x7FF, 0x800, 0xD7FF, 0xE000, 0xFFFF, 0x10000, 0x10FFFF };
+            rand_utf8(out, &i, edge[rnd() % 9]);
+        }
+    }
+    out[i] = '\0';
+}
+
+static void gen_value(json_writer_t *w, ref_t *r, int depth);
+
+static void gen_container(json_writer_t *w, ref_t *r, int depth, int object) {
+    int n = rnd() % 6;
+    if (object) jw_object_begin(w); else jw_array_begin(w);
+    ref_put(r, object ? "{" : "[", 1);
+    for (int i = 0; i < n; i++) {
+        if (i) ref_put(r, ",", 1);
+        if (object) {
+            char key[320];
+            rand_string(key, 64);
+            jw_key(w, key);
+            ref_string(r, key);
+            ref_put(r, ":", 1);
+        }
+        gen_value(w, r, depth + 1);
+    }
+    if (object) jw_object_end(w); else jw_array_end(w);
+    ref_put(r, object ? "}" : "]", 1);
+}
+
+static void gen_value(json_writer_t *w, ref_t *r, int depth) {
+    char tmp[320];
+    unsigned k = rnd() % (depth < JSON_WRITER_DEPTH - 1 ? 6 : 4);
+    if (k == 0) {
+        rand_string(tmp, sizeof(tmp));
+        jw_string(w, tmp);
+        ref_string(r, tmp);
+    } else if (k == 1) {
+        static const int32_t edge[] = { 0, -1, 1, 2147483647, -2147483647 - 1 };
+        int32_t v = rnd() % 3 ? (int32_t)rnd() : edge[rnd() % 5];
+        jw_int(w, v);
+        int n = snprintf(tmp, sizeof(tmp), "%d", v);
+        ref_put(r, tmp, n);
+    } else if (k == 2) {
+        uint32_t v = rnd() % 3 ? rnd() : (rnd() % 2 ? 0 : 4294967295u);
+        jw_uint(w, v);
+        int n = snprintf(tmp, sizeof(tmp), "%u", v);
+        ref_put(r, tmp, n);
+    } else if (k == 3) {
+        int v = rnd() & 1;
+        jw_bool(w, v);
+        ref_put(r, v ? "true" : "false", v ? 4 : 5);
+    } else {
+        gen_container(w, r, depth, k == 4);
+    }
+}
+
+static int fuzz(unsigned rounds) {
+    static char out[OUT_MAX], ref[OUT_MAX];
+    unsigned failures = 0;
+    size_t total = 0;
+
+    for (unsigned i = 0; i < rounds; i++) {
+        sink_t s = { out, 0, 0, 0, 0, 0 };
+        ref_t r = { ref, 0 };
+        json_writer_t w;
+        jw_init(&w, sink_flush, &s);
+        gen_container(&w, &r, 0, rnd() & 1);
+        int err = jw_finish(&w);
+        total += s.len;
+        if (err != 0 || s.bad_chunk || s.len != r.len || memcmp(out, ref, r.len) != 0 ||
+            !valid_json(out, s.len)) {
+            if (failures++ < 3) {
+                printf("FUZZ MISMATCH round %u: err %d, bad chunk %d, %zu vs %zu bytes, valid %d\n",
+                       i, err, s.bad_chunk, s.len, r.len, valid_json(out, s.len));
+            }
+        }
+    }
+    printf("fuzz: %u documents, %zu bytes, %u failures\n", rounds, total, failures);
+    return failures == 0;
+}
+
+// 回调出错与嵌套错误
+static int error_paths(void) {
+    static char out[OUT_MAX], ref[OUT_MAX];
+    int ok = 1;
+
+    for (unsigned fail_at = 1; fail_at <= 8; fail_at++) {
+        sink_t s = { out, 0, 0, fail_at, 0, 0 };
+        ref_t r = { ref, 0 };
+        json_writer_t w;
+        jw_init(&w, sink_flush, &s);
+        jw_array_begin(&w);
+        for (int i = 0; i < 200; i++) {
+            char tmp[32];
+            snprintf(tmp, sizeof(tmp), "item %d \"quoted\"", i);
+            jw_string(&w, tmp);
+            ref_string(&r, tmp);
+        }
+        jw_array_end(&w);
+        int err = jw_finish(&w);
+        if (err != 7 || s.bad_chunk) {
+            printf("FLUSH ERROR not propagated (fail at %u): err %d, calls %u\n", fail_at, err, s.calls);
+            ok = 0;
+        }
+    }
+
+    json_writer_t w;
+    jw_init(&w, null_flush, NULL);
+    for (int i = 0; i <= JSON_WRITER_DEPTH; i++) jw_array_begin(&w);
+    ok &= jw_finish(&w) == JW_ERR_NESTING;
+
+    jw_init(&w, null_flush, NULL);
+    jw_object_end(&w);
+    ok &= jw_finish(&w) == JW_ERR_NESTING;
+
+    jw_init(&w, null_flush, NULL);
+    jw_object_begin(&w);
+    jw_key(&w, "a");
+    jw_object_end(&w);
+    ok &= jw_finish(&w) == JW_ERR_NESTING;
+
+    jw_init(&w, null_flush, NULL);
+    jw_array_begin(&w);
+    ok &= jw_finish(&w) == JW_ERR_NESTING;
+
+    printf("error paths %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+// ==========================================
+// 性能: /scan 响应
+// ==========================================
+typedef struct {
+    char ssid[33];
+    uint8_t bssid[6];
+    int8_t rssi;
+    uint8_t authmode;
+} ap_t;
+
+static void gen_aps(ap_t *aps, int n) {
+    for (int i = 0; i < n; i++) {
+        snprintf(aps[i].ssid, sizeof(aps[i].ssid), i % 5 == 0 ? "Café \"Guest\" %d" : "Office-WiFi-%d", i);
+        for (int k = 0; k < 6; k++) aps[i].bssid[k] = (uint8_t)rnd();
+        aps[i].rssi = (int8_t)(-30 - i % 60);
+        aps[i].authmode = (uint8_t)(i % 5);
+    }
+}
+
+static void encode_writer(const ap_t *aps, int n, json_flush_t flush, void *ctx) {
+    json_writer_t w;
+    jw_init(&w, flush, ctx);
+    jw_object_begin(&w);
+    jw_key(&w, "gen");
+    jw_uint(&w, 3);
+    jw_key(&w, "age");
+    jw_uint(&w, 12);
+    jw_key(&w, "scanning");
+    jw_bool(&w, false);
+    jw_key(&w, "aps");
+    jw_array_begin(&w);
+    for (int i = 0; i < n; i++) {
+        char bssid[18];
+        snprintf(bssid, sizeof(bssid), "%02x:%02x:%02x:%02x:%02x:%02x", aps[i].bssid[0], aps[i].bssid[1],
+                 aps[i].bssid[2], aps[i].bssid[3], aps[i].bssid[4], aps[i].bssid[5]);
+        jw_object_begin(&w);
+        jw_key(&w, "ssid");
+        jw_string(&w, aps[i].ssid);
+        jw_key(&w, "rssi");
+        jw_int(&w, aps[i].rssi);
+        jw_key(&w, "auth");
+        jw_uint(&w, aps[i].authmode);
+        jw_key(&w, "bssid");
+        jw_string(&w, bssid);
+        jw_object_end(&w);
+    }
+    jw_array_end(&w);
+    jw_object_end(&w);
+    jw_finish(&w);
+}
+
+// 原先的做法: 按 AP 数量 malloc，逐条 sprintf (SSID 不转义)
+static size_t encode_sprintf(const ap_t *aps, int n) {
+    char *buf = malloc(n * 128 + 10);
+    char *p = buf;
+    p += sprintf(p, "[");
+    for (int i = 0; i < n; i++) {
+        p += sprintf(p, "%s{\"ssid\":\"%s\",\"rssi\":%d,\"auth\":%d,\"bssid\":\"%02x:%02x:%02x:%02x:%02x:%02x\"}",
+                     i ? "," : "", aps[i].ssid, aps[i].rssi, aps[i].authmode,
+                     aps[i].bssid[0], aps[i].bssid[1], aps[i].bssid[2],
+                     aps[i].bssid[3], aps[i].bssid[4], aps[i].bssid[5]);
+    }
+    p += sprintf(p, "]");
+    size_t len = p - buf;
+    free(buf);
+    return len;
+}
+
+static void bench(int n) {
+    ap_t *aps = malloc(n * sizeof(ap_t));
+    static char out[OUT_MAX];
+    sink_t s = { out, 0, 0, 0, 0, 0 };
+    gen_aps(aps, n);
+    encode_writer(aps, n, sink_flush, &s);
+
+    int iters = 2000000 / n;
+    uint64_t t0 = now_ns();
+    for (int i = 0; i < iters; i++) encode_writer(aps, n, null_flush, NULL);
+    uint64_t t1 = now_ns();
+    for (int i = 0; i < iters; i++) encode_sprintf(aps, n);
+    uint64_t t2 = now_ns();
+
+    double w_ns = (double)(t1 - t0) / iters / n;
+    double s_ns = (double)(t2 - t1) / iters / n;
+    printf("%5d APs  %6zu bytes (%4u chunks, valid %d)  writer %6.1f ns/AP %7.1f MB/s  "
+           "sprintf %6.1f ns/AP  peak memory %zu vs %d bytes\n",
+           n, s.len, s.calls, valid_json(out, s.len), w_ns, s.len / (w_ns * n / 1000.0),
+           s_ns, sizeof(json_writer_t), n * 128 + 10);
+    free(aps);
+}
+
+int main(int argc, char **argv) {
+    unsigned rounds = argc > 1 ? (unsigned)atoi(argv[1]) : 50000;
+    int ok = fuzz(rounds);
+    ok &= error_paths();
+    printf("\n");
+    bench(20);
+    bench(64);
+    bench(1000);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,232 @@
+/*
+ * 上行压缩 (main/src/lz_codec.c) 的主机端压缩率与性能测试
+ *
+ * 编译运行:
+ *   gcc -O2 -Imain/include tools/lz_bench.c main/src/lz_codec.c -o lz_bench && ./lz_bench
+ *   ./lz_bench 512                       # 指定合包大小 (默认 1024，即 LZ_CHUNK_MAX)
+ *   ./lz_bench 1024 /var/log/dpkg.log    # 追加真实日志文件作为语料
+ *
+ * 每份语料按合包大小切块，逐块独立压缩 (与 tcp_bridge.c 的 DATA_LZ 记录一致)，输出:
+ * - 压缩后占原始大小的比例: 压缩无收益的块按原始 DATA 记录计 (同设备端的回退规则)，
+ *   每条记录另计 2 字节原始长度
+ * - 平均每字节压缩耗时 (含每块清空哈希表)
+ * 每一块都用独立实现的 LZ4 block 解码器解压并与原文比对
+ */
+#include "lz_codec.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_CHUNK 4096
+#define SYNTH_SIZE (1400 * 1024)
+#define RANDOM_SIZE (200 * 1024)
+#define MIN_BENCH_NS 200000000ULL   // 每份语料至少计时 0.2 秒
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint32_t s_rng = 2463534242u;
+static uint32_t rnd(void) {
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+// ==========================================
+// LZ4 block 解码 (按格式规范独立实现，逐项检查越界)
+// 返回解压长度，-1 表示输入非法
+// ==========================================
+static long lz4_decode(const uint8_t *src, size_t len, uint8_t *dst, size_t cap) {
+    const uint8_t *ip = src, *iend = src + len;
+    uint8_t *op = dst, *oend = dst + cap;
+
+    while (ip < iend) {
+        uint8_t token = *ip++;
+        size_t lit = token >> 4;
+        if (lit == 15) {
+            uint8_t b;
+            do {
+                if (ip >= iend) return -1;
+                b = *ip++;
+                lit += b;
+            } while (b == 255);
+        }
+        if ((size_t)(iend - ip) < lit || (size_t)(oend - op) < lit) return -1;
+        memcpy(op, ip, lit);
+        ip += lit;
+        op += lit;
+        if (ip == iend) break;  // 最后一个序列只有字面量
+
+        if (iend - ip < 2) return -1;
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - dst)) return -1;
+        size_t ml = token & 15;
+        if (ml == 15) {
+            uint8_t b;
+            do {
+                if (ip >= iend) return -1;
+                b = *ip++;
+                ml += b;
+            } while (b == 255);
+        }
+        ml += 4;
+        if ((size_t)(oend - op) < ml) return -1;
+        // 重叠拷贝必须逐字节
+        for (size_t i = 0; i < ml; i++, op++) {
+            *op = op[-(long)offset];
+        }
+    }
+    return op - dst;
+}
+
+// ==========================================
+// 语料
+// ==========================================
+typedef struct {
+    const char *name;
+    uint8_t *data;
+    size_t len;
+} corpus_t;
+
+// ESP_LOG 风格的控制台输出: 带颜色转义、启动计时、标签与常见的数值字段
+static corpus_t gen_esp_log(void) {
+    static const char *const tags[] = { "wifi", "TCP_Bridge", "WiFi_Prov", "httpd", "sensor", "app_main", "esp_netif" };
+    static const char *const fmts[] = {
+        "state: %s -> %s (%u)",
+        "Client 192.168.1.%u connected (raw, slot %u, %u/3 active)",
+        "temperature=%u.%u humidity=%u%% pressure=%u",
+        "free heap %u bytes, min %u",
+        "GET /stats %u %u ms",
+        "sample %u: ax=%d ay=%d az=%d",
+        "retry %u, reason %u",
+    };
+    static const char *const states[] = { "init", "auth", "assoc", "run" };
+    static const char *const levels[] = { "\033[0;32mI", "\033[0;33mW", "\033[0;31mE", "D" };
+
+    corpus_t c = { "esp_log (synthetic)", malloc(SYNTH_SIZE), 0 };
+    uint32_t t = 1000;
+    while (c.len < SYNTH_SIZE - 256) {
+        char msg[160], line[256];
+        uint32_t r = rnd();
+        int f = r % 7;
+        t += 1 + rnd() % 300;
+        switch (f) {
+            case 0: snprintf(msg, sizeof(msg), fmts[f], states[r % 4], states[(r >> 4) % 4], r >> 24); break;
+            case 1: snprintf(msg, sizeof(msg), fmts[f], 2 + r % 200, (r >> 8) % 3, 1 + (r >> 12) % 3); break;
+            case 2: snprintf(msg, sizeof(msg), fmts[f], 20 + r % 10, r % 10, 40 + (r >> 8) % 30, 99000 + (r >> 16) % 3000); break;
+            case 3: snprintf(msg, sizeof(msg), fmts[f], 40000 + r % 5000, 38000 + (r >> 16) % 2000); break;
+            case 4: snprintf(msg, sizeof(msg), fmts[f], r % 2 ? 200 : 304, (r >> 8) % 40); break;
+            case 5: snprintf(msg, sizeof(msg), fmts[f], t, (int)(r % 2000) - 1000, (int)((r >> 11) % 2000) - 1000, (int)((r >> 21) % 400) + 800); break;
+            default: snprintf(msg, sizeof(msg), fmts[f], r % 10, 200 + (r >> 8) % 10); break;
+        }
+        int lv = (r >> 28) < 12 ? 0 : (r >> 28) < 14 ? 1 : (r >> 28) < 15 ? 2 : 3;
+        int n = snprintf(line, sizeof(line), "%s (%u) %s: %s%s\n", levels[lv], t,
+                         tags[(r >> 3) % 7], msg, lv < 3 ? "\033[0m" : "");
+        memcpy(c.data + c.len, line, n);
+        c.len += n;
+    }
+    return c;
+}
+
+static corpus_t gen_random(void) {
+    corpus_t c = { "random bytes", malloc(RANDOM_SIZE), RANDOM_SIZE };
+    for (size_t i = 0; i < c.len; i++) {
+        c.data[i] = (uint8_t)(rnd() >> 24);
+    }
+    return c;
+}
+
+static int load_file(const char *path, corpus_t *c) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return 0;
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    c->name = path;
+    c->data = malloc(len > 0 ? len : 1);
+    c->len = fread(c->data, 1, len > 0 ? len : 0, f);
+    fclose(f);
+    return c->len > 0;
+}
+
+// ==========================================
+// 测试
+// ==========================================
+static int bench(const corpus_t *c, size_t chunk) {
+    static uint16_t hash[LZ_HASH_SIZE];
+    static uint8_t out[LZ_COMPRESS_BOUND(MAX_CHUNK)];
+    static uint8_t back[MAX_CHUNK];
+    size_t wire = 0, lz_chunks = 0, chunks = 0;
+    int failures = 0;
+
+    // 1. 压缩率与往返校验
+    for (size_t off = 0; off < c->len; off += chunk) {
+        size_t n = c->len - off < chunk ? c->len - off : chunk;
+        size_t clen = lz_compress(c->data + off, n, out, sizeof(out), hash);
+        if (clen == 0 || lz4_decode(out, clen, back, sizeof(back)) != (long)n ||
+            memcmp(back, c->data + off, n) != 0) {
+            if (failures++ == 0) printf("  FAIL round trip at offset %zu\n", off);
+        }
+        // 与设备端一致: 压缩后不足原始长度才发 DATA_LZ (负载多 2 字节原始长度)
+        if (clen + 2 < n) {
+            wire += clen + 2;
+            lz_chunks++;
+        } else {
+            wire += n;
+        }
+        chunks++;
+    }
+
+    // 2. 压缩耗时: 整份语料反复压缩，直到累计足够的计时
+    uint64_t bytes = 0, elapsed = 0, start = now_ns();
+    volatile size_t sink = 0;
+    do {
+        for (size_t off = 0; off < c->len; off += chunk) {
+            size_t n = c->len - off < chunk ? c->len - off : chunk;
+            sink += lz_compress(c->data + off, n, out, sizeof(out), hash);
+        }
+        bytes += c->len;
+        elapsed = now_ns() - start;
+    } while (elapsed < MIN_BENCH_NS);
+
+    printf("  %-28s %8zu B  ratio %5.1f%%  (%zu/%zu chunks compressed)  %.2f ns/B  %.0f MB/s\n",
+           c->name, c->len, 100.0 * wire / c->len, lz_chunks, chunks,
+           (double)elapsed / bytes, bytes * 1e3 / elapsed);
+    return failures;
+}
+
+int main(int argc, char **argv) {
+    size_t chunk = argc > 1 ? strtoul(argv[1], NULL, 10) : 1024;
+    if (chunk < 16 || chunk > MAX_CHUNK) {
+        fprintf(stderr, "chunk size must be 16..%d\n", MAX_CHUNK);
+        return 2;
+    }
+
+    corpus_t corpora[16];
+    int num = 0;
+    corpora[num++] = gen_esp_log();
+    for (int i = 2; i < argc && num < 15; i++) {
+        if (!load_file(argv[i], &corpora[num])) {
+            fprintf(stderr, "skip %s: unreadable or empty\n", argv[i]);
+            continue;
+        }
+        num++;
+    }
+    corpora[num++] = gen_random();
+
+    printf("lz_compress, %zu byte chunks, %d byte hash table\n", chunk,
+           (int)(LZ_HASH_SIZE * sizeof(uint16_t)));
+    int failures = 0;
+    for (int i = 0; i < num; i++) {
+        failures += bench(&corpora[i], chunk);
+        free(corpora[i].data);
+    }
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,389 @@
+/*
+ * 无锁环形缓冲区 (main/src/ringbuf.c) 的主机端单元测试与多线程压力测试
+ *
+ * 编译运行:
+ *   gcc -O2 -pthread -Imain/include tools/ringbuf_test.c main/src/ringbuf.c -o ringbuf_test && ./ringbuf_test
+ *   ./ringbuf_test 20       # 指定压力测试时长 (秒)，默认 3 秒
+ *
+ * 单元测试: 初始化参数检查、两段折回的读写、覆盖与丢失计数、超长写入、peek_at / commit、
+ * rb_space 与 rb_resize
+ * 压力测试: 生产者线程以随机块大小持续写入 (写满即覆盖)，消费者线程混合使用 rb_read 与
+ * peek/commit 读取，每个字节的值由其绝对位置决定，逐字节校验读出的数据；
+ * 结束时检查 读出字节 + 丢失字节 (+ commit 报告损坏的字节) 恰好等于写入总量
+ * 生产者交替持续灌满与间歇写入，覆盖 消费者持续落后 / 跟得上 两种状态
+ * 读取中途被覆盖的竞争需要两个线程真正并行，应在多核主机上运行
+ */
+#include "ringbuf.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static int s_failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        s_failures++; \
+    } \
+} while (0)
+
+// 绝对位置 pos 处的字节值: 周期为素数的伪随机序列，错位、重复或乱序都会被发现
+// (缓存容量是 2 的幂，套圈造成的错位不可能恰好是周期的整数倍)
+// 预先生成一个周期外加一块的余量，写入与校验都按整段 memcpy / memcmp，
+// 生产者大部分时间处在拷贝中，读取中途被覆盖的情况才足够频繁
+#define PATTERN_PERIOD 65521
+#define PATTERN_MAX_SPAN 4096
+
+static uint8_t s_pattern[PATTERN_PERIOD + PATTERN_MAX_SPAN];
+
+static void pattern_init(void) {
+    uint32_t x = 0x9E3779B9;
+    for (int i = 0; i < PATTERN_PERIOD; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        s_pattern[i] = (uint8_t)(x >> 24);
+    }
+    memcpy(s_pattern + PATTERN_PERIOD, s_pattern, PATTERN_MAX_SPAN);
+}
+
+// pos 起 len 字节 (len <= PATTERN_MAX_SPAN) 的期望内容
+// 位置按 64 位计: 压力测试几秒内就会写满 4GB，32 位位置回绕处周期序列不连续
+static inline const uint8_t *pattern_at(uint64_t pos) {
+    return s_pattern + pos % PATTERN_PERIOD;
+}
+
+// 返回第一个不符的偏移，全部正确返回 -1
+static long verify(const uint8_t *buf, uint64_t pos, size_t len) {
+    const uint8_t *expect = pattern_at(pos);
+    if (memcmp(buf, expect, len) == 0) return -1;
+    for (size_t i = 0; i < len; i++) {
+        if (buf[i] != expect[i]) return (long)i;
+    }
+    return -1;
+}
+
+// 按位置写入 len 字节，返回新的写位置
+static uint64_t write_seq(ringbuf_t *rb, uint64_t pos, size_t len) {
+    while (len > 0) {
+        size_t n = len < PATTERN_MAX_SPAN ? len : PATTERN_MAX_SPAN;
+        rb_write(rb, pattern_at(pos), n);
+        pos += n;
+        len -= n;
+    }
+    return pos;
+}
+
+// ==========================================
+// 单元测试
+// ==========================================
+static void test_init(void) {
+    ringbuf_t rb;
+    CHECK(!rb_init(&rb, 0));
+    CHECK(!rb_init(&rb, 1000));
+    CHECK(rb_init(&rb, 1024));
+    CHECK(rb.size == 1024 && rb.mask == 1023 && rb_head(&rb) == 0);
+    rb_deinit(&rb);
+}
+
+static void test_wrap(void) {
+    ringbuf_t rb;
+    rb_reader_t rd;
+    uint8_t out[64];
+    rb_init(&rb, 64);
+    rb_reader_init(&rd, 0);
+
+    // 反复写读 40 字节，读写位置多次越过缓冲区末尾
+    uint32_t pos = 0;
+    for (int round = 0; round < 20; round++) {
+        pos = (uint32_t)write_seq(&rb, pos, 40);
+        CHECK(rb_available(&rb, &rd) == 40);
+        size_t n = rb_read(&rb, &rd, out, sizeof(out));
+        CHECK(n == 40);
+        CHECK(verify(out, rd.tail - 40, n) < 0);
+    }
+    CHECK(rd.lost == 0 && rd.tail == pos);
+    CHECK(rb_read(&rb, &rd, out, sizeof(out)) == 0);
+    rb_deinit(&rb);
+}
+
+static void test_overwrite(void) {
+    ringbuf_t rb;
+    rb_reader_t rd;
+    uint8_t out[64];
+    rb_init(&rb, 64);
+    rb_reader_init(&rd, 0);
+
+    // 写入 100 字节，最旧的 36 字节被覆盖
+    write_seq(&rb, 0, 100);
+    CHECK(rb_available(&rb, &rd) == 64);
+    CHECK(rd.lost == 36 && rd.tail == 36);
+    size_t n = rb_read(&rb, &rd, out, 10);
+    CHECK(n == 10 && verify(out, 36, n) < 0);
+
+    // 超长写入只保留最新的 size 字节
+    write_seq(&rb, 100, 1000);
+    CHECK(rb_head(&rb) == 1100);
+    n = rb_read(&rb, &rd, out, sizeof(out));
+    CHECK(n == 64 && verify(out, 1100 - 64, n) < 0);
+    CHECK(rd.lost + 10 + 64 == 1100);
+
+    // 起始位置早于最旧数据的新读者
+    rb_reader_t late;
+    rb_reader_init(&late, 0);
+    CHECK(rb_available(&rb, &late) == 64 && late.lost == 1100 - 64);
+    rb_deinit(&rb);
+}
+
+static void test_peek_commit(void) {
+    ringbuf_t rb;
+    rb_reader_t rd;
+    const uint8_t *data;
+    rb_init(&rb, 64);
+    rb_reader_init(&rd, 0);
+
+    // 读写位置都停在 50，再写 30 字节: 数据分布在 [50, 64) 与 [0, 16) 两段
+    write_seq(&rb, 0, 50);
+    rd.tail = 50;
+    write_seq(&rb, 50, 30);
+
+    size_t span = rb_peek(&rb, &rd, &data);
+    CHECK(span == 14 && verify(data, 50, span) < 0);
+    span = rb_peek_at(&rb, &rd, 14, &data);
+    CHECK(span == 16 && verify(data, 64, span) < 0);
+    CHECK(rb_peek_at(&rb, &rd, 30, &data) == 0);
+
+    // 部分提交
+    CHECK(rb_commit(&rb, &rd, 10));
+    CHECK(rd.tail == 60 && rb_available(&rb, &rd) == 20);
+
+    // 使用期间被覆盖: commit 报告损坏，读位置照常推进
+    span = rb_peek(&rb, &rd, &data);
+    write_seq(&rb, 80, 64);
+    CHECK(!rb_commit(&rb, &rd, span));
+    rb_deinit(&rb);
+}
+
+static void test_space(void) {
+    ringbuf_t rb;
+    rb_init(&rb, 64);
+    write_seq(&rb, 0, 40);
+    CHECK(rb_space(&rb, 0) == 24);
+    CHECK(rb_space(&rb, 30) == 54);
+    CHECK(rb_space(&rb, 40) == 64);
+    CHECK(rb_space(&rb, 100) == 64);   // 超前于写位置: 无约束
+    write_seq(&rb, 40, 100);
+    CHECK(rb_space(&rb, 0) == 64);     // 已被覆盖: 无约束
+    rb_deinit(&rb);
+}
+
+static void test_resize(void) {
+    ringbuf_t rb;
+    rb_reader_t rd, old;
+    uint8_t out[256];
+    rb_init(&rb, 64);
+    rb_reader_init(&rd, 100);
+    rb_reader_init(&old, 60);
+    uint32_t pos = (uint32_t)write_seq(&rb, 0, 150);
+
+    // 扩容: 已有数据与读游标保持不变
+    CHECK(!rb_resize(&rb, 100));
+    CHECK(rb_resize(&rb, 256));
+    CHECK(rb_head(&rb) == pos && rb.size == 256);
+    size_t n = rb_read(&rb, &rd, out, sizeof(out));
+    CHECK(n == 50 && verify(out, 100, n) < 0 && rd.lost == 0);
+
+    // 扩容后的剩余空间可以继续写满而不丢数据
+    pos = (uint32_t)write_seq(&rb, pos, 256);
+    n = rb_read(&rb, &rd, out, sizeof(out));
+    CHECK(n == 256 && verify(out, 150, n) < 0 && rd.lost == 0);
+
+    // 缩容: 只保留最新的 size 字节，更早的数据按丢失处理
+    CHECK(rb_resize(&rb, 32));
+    n = rb_read(&rb, &old, out, sizeof(out));
+    CHECK(n == 32 && verify(out, pos - 32, n) < 0);
+    CHECK(old.lost == pos - 32 - 60);
+    rb_deinit(&rb);
+}
+
+// ==========================================
+// 压力测试
+// ==========================================
+#define STRESS_SIZE 4096
+
+typedef struct {
+    ringbuf_t rb;
+    volatile int stop;
+    volatile uint64_t produced;   // 生产者结束时的写位置
+    volatile int done;
+    // 消费者统计
+    uint64_t read_bytes;
+    uint64_t read_calls;
+    uint64_t peek_bytes;
+    uint64_t torn_bytes;          // rb_commit 报告使用期间被覆盖的字节
+    uint64_t bad_bytes;           // 校验失败 (不应出现)
+    uint64_t first_bad_pos;
+} stress_t;
+
+static void *producer(void *arg) {
+    stress_t *st = arg;
+    uint32_t rng = 0x12345678;
+    uint64_t pos = 0;
+    uint32_t iter = 0;
+    bool paced = false;
+    struct timespec now;
+
+    while (!st->stop) {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        // 块大小 1..1024，偶尔等于缓存容量 (整圈覆盖)
+        size_t len = (rng & 0xFF) == 0 ? STRESS_SIZE : 1 + (rng >> 8) % 1024;
+        pos = write_seq(&st->rb, pos, len);
+        // 交替进行: 持续灌满 (消费者被反复套圈，读取中途被覆盖) / 间歇让出处理器 (消费者追上)
+        if ((++iter & 0xFF) == 0) {
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            paced = now.tv_nsec % 100000000 >= 10000000;  // 每 100ms 中灌满 10ms
+        }
+        if (paced) {
+            struct timespec ts = { 0, (rng >> 16) % 20000 };
+            nanosleep(&ts, NULL);
+        }
+    }
+    st->produced = pos;
+    __atomic_store_n(&st->done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static void *consumer(void *arg) {
+    stress_t *st = arg;
+    rb_reader_t rd;
+    uint8_t buf[1500];
+    uint32_t rng = 0xCAFEBABE;
+    // 读位置与丢失计数都是 32 位自由递增，这里按增量累加成 64 位
+    uint64_t tail64 = 0, lost64 = 0;
+    uint32_t tail_seen = 0, lost_seen = 0;
+    rb_reader_init(&rd, 0);
+
+#define SYNC64() do { \
+        tail64 += (uint32_t)(rd.tail - tail_seen); tail_seen = rd.tail; \
+        lost64 += (uint32_t)(rd.lost - lost_seen); lost_seen = rd.lost; \
+    } while (0)
+
+    while (1) {
+        int finished = __atomic_load_n(&st->done, __ATOMIC_ACQUIRE);
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+
+        if (rng & 1) {
+            // 拷贝读取: 返回的数据必须完好
+            size_t want = 1 + (rng >> 4) % sizeof(buf);
+            size_t n = rb_read(&st->rb, &rd, buf, want);
+            SYNC64();
+            if (n > 0) {
+                long bad = verify(buf, tail64 - n, n);
+                if (bad >= 0) {
+                    if (st->bad_bytes == 0) st->first_bad_pos = tail64 - n + bad;
+                    st->bad_bytes += n;
+                }
+                st->read_bytes += n;
+                st->read_calls++;
+            } else if (finished && rb_available(&st->rb, &rd) == 0) {
+                SYNC64();
+                break;
+            }
+        } else {
+            // 零拷贝读取: 先拷出再提交，commit 确认完好的数据才校验
+            const uint8_t *data;
+            size_t span = rb_peek(&st->rb, &rd, &data);
+            SYNC64();
+            if (span == 0) {
+                if (finished && rb_available(&st->rb, &rd) == 0) {
+                    SYNC64();
+                    break;
+                }
+                continue;
+            }
+            size_t n = 1 + (rng >> 4) % span;
+            uint64_t pos = tail64;
+            if (n > sizeof(buf)) n = sizeof(buf);
+            memcpy(buf, data, n);
+            bool intact = rb_commit(&st->rb, &rd, n);
+            SYNC64();
+            if (intact) {
+                long bad = verify(buf, pos, n);
+                if (bad >= 0) {
+                    if (st->bad_bytes == 0) st->first_bad_pos = pos + bad;
+                    st->bad_bytes += n;
+                }
+                st->peek_bytes += n;
+            } else {
+                st->torn_bytes += n;
+            }
+        }
+    }
+#undef SYNC64
+
+    // 读出 + 丢失 + 损坏 = 读位置 = 写入总量
+    uint64_t accounted = st->read_bytes + st->peek_bytes + st->torn_bytes + lost64;
+    if (accounted != tail64 || tail64 != st->produced) {
+        printf("FAIL accounting: read %llu + peek %llu + torn %llu + lost %llu != tail %llu (produced %llu)\n",
+               (unsigned long long)st->read_bytes, (unsigned long long)st->peek_bytes,
+               (unsigned long long)st->torn_bytes, (unsigned long long)lost64,
+               (unsigned long long)tail64, (unsigned long long)st->produced);
+        s_failures++;
+    }
+    printf("  consumed %.1f MB (read %.1f MB in %llu calls, peek %.1f MB), lost %.1f MB, torn %llu B\n",
+           (st->read_bytes + st->peek_bytes) / 1e6, st->read_bytes / 1e6,
+           (unsigned long long)st->read_calls, st->peek_bytes / 1e6, lost64 / 1e6,
+           (unsigned long long)st->torn_bytes);
+    return NULL;
+}
+
+static void test_stress(int seconds) {
+    static stress_t st;
+    pthread_t prod, cons;
+
+    memset(&st, 0, sizeof(st));
+    rb_init(&st.rb, STRESS_SIZE);
+    printf("stress: %d s, %d byte ring\n", seconds, STRESS_SIZE);
+
+    pthread_create(&cons, NULL, consumer, &st);
+    pthread_create(&prod, NULL, producer, &st);
+    struct timespec ts = { seconds, 0 };
+    nanosleep(&ts, NULL);
+    st.stop = 1;
+    pthread_join(prod, NULL);
+    pthread_join(cons, NULL);
+
+    printf("  produced %.1f MB\n", st.produced / 1e6);
+    if (st.bad_bytes > 0) {
+        printf("FAIL %llu bytes failed verification (first at position %llu)\n",
+               (unsigned long long)st.bad_bytes, (unsigned long long)st.first_bad_pos);
+        s_failures++;
+    }
+    CHECK(st.read_bytes > 0 && st.peek_bytes > 0);
+    rb_deinit(&st.rb);
+}
+
+int main(int argc, char **argv) {
+    int seconds = argc > 1 ? atoi(argv[1]) : 3;
+
+    pattern_init();
+    test_init();
+    test_wrap();
+    test_overwrite();
+    test_peek_commit();
+    test_space();
+    test_resize();
+    printf("unit tests: %s\n", s_failures ? "FAILED" : "ok");
+
+    test_stress(seconds > 0 ? seconds : 1);
+
+    printf("%s\n", s_failures ? "FAILED" : "PASSED");
+    return s_failures ? 1 : 0;
+}
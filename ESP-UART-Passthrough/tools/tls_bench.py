@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+#
+# TLS 上行与原始透传端口的对比测试 (握手耗时 + 稳态吞吐)
+#
+# 需要 Python 3.13+ (ssl 模块的 PSK 支持)，设备端需启用 TLS_PORT 并设置密钥:
+#   echo "set psk 00112233445566778899aabbccddeeff" | nc 192.168.4.1 8880
+#
+# 用法:
+#   python3 tls_bench.py 192.168.4.1 --psk 00112233445566778899aabbccddeeff
+#   python3 tls_bench.py 192.168.4.1 --psk ... --seconds 20   # 吞吐测试时长
+#
+# 吞吐测试需要串口上持续有数据: 以 BRIDGE_BENCH 固件运行，或接一个持续输出的目标设备
+# 握手耗时为主机端测得的 TCP 建连 + 握手时间，设备日志中另有设备端视角的握手耗时
+
+import argparse
+import socket
+import ssl
+import statistics
+import sys
+import time
+
+PSK_IDENTITY = 'esp-bridge'  # 同 BRIDGE_TLS_PSK_IDENTITY
+CIPHERS = 'PSK-AES128-GCM-SHA256:PSK-AES128-CCM8'
+
+
+def tls_context(psk):
+    ctx = ssl.SSLContext(ssl.PROTOCOL_TLS_CLIENT)
+    ctx.check_hostname = False
+    ctx.verify_mode = ssl.CERT_NONE
+    ctx.minimum_version = ssl.TLSVersion.TLSv1_2
+    ctx.maximum_version = ssl.TLSVersion.TLSv1_2
+    ctx.set_ciphers(CIPHERS)
+    ctx.set_psk_client_callback(lambda hint: (PSK_IDENTITY, psk))
+    return ctx
+
+
+def connect_plain(host, port):
+    t0 = time.perf_counter()
+    sock = socket.create_connection((host, port), timeout=5)
+    return sock, time.perf_counter() - t0
+
+
+def connect_tls(ctx, host, port, session=None):
+    t0 = time.perf_counter()
+    raw = socket.create_connection((host, port), timeout=5)
+    sock = ctx.wrap_socket(raw, session=session)
+    return sock, time.perf_counter() - t0
+
+
+def throughput(sock, seconds):
+    """读取 seconds 秒，返回 (字节数, 字节/秒)"""
+    sock.settimeout(1)
+    total = 0
+    t0 = time.perf_counter()
+    while time.perf_counter() - t0 < seconds:
+        try:
+            data = sock.recv(4096)
+        except (socket.timeout, ssl.SSLWantReadError):
+            continue
+        if not data:
+            break
+        total += len(data)
+    elapsed = time.perf_counter() - t0
+    return total, total / elapsed
+
+
+def summary(name, samples):
+    ms = [s * 1000 for s in samples]
+    print('%-24s median %7.1f ms  min %7.1f ms  max %7.1f ms  (n=%d)'
+          % (name, statistics.median(ms), min(ms), max(ms), len(ms)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='ESP UART bridge TLS vs plaintext benchmark')
+    parser.add_argument('host')
+    parser.add_argument('--psk', required=True, help='pre-shared key (hex)')
+    parser.add_argument('--port', type=int, default=8888, help='plaintext raw port')
+    parser.add_argument('--tls-port', type=int, default=8443)
+    parser.add_argument('-n', '--rounds', type=int, default=10, help='handshakes per mode')
+    parser.add_argument('--seconds', type=float, default=10, help='throughput test duration')
+    args = parser.parse_args()
+
+    if not hasattr(ssl.SSLContext, 'set_psk_client_callback'):
+        sys.exit('Python 3.13+ is required for TLS-PSK')
+    ctx = tls_context(bytes.fromhex(args.psk))
+
+    plain, full, resumed = [], [], []
+    session = None
+    resumed_ok = 0
+    for _ in range(args.rounds):
+        sock, dt = connect_plain(args.host, args.port)
+        plain.append(dt)
+        sock.close()
+
+        sock, dt = connect_tls(ctx, args.host, args.tls_port)
+        full.append(dt)
+        cipher = sock.cipher()[0]
+        session = sock.session  # TLS 1.2 的票据在握手结束时已收到
+        sock.close()
+
+        # 设备同时只服务一个 TLS 会话，等旧连接释放后再重连
+        time.sleep(0.2)
+        sock, dt = connect_tls(ctx, args.host, args.tls_port, session=session)
+        resumed.append(dt)
+        resumed_ok += sock.session_reused
+        sock.close()
+        time.sleep(0.2)
+
+    print('cipher suite: %s' % cipher)
+    summary('plaintext connect', plain)
+    summary('TLS full handshake', full)
+    summary('TLS resumed (ticket)', resumed)
+    print('%d/%d reconnects resumed the session' % (resumed_ok, args.rounds))
+
+    sock, _ = connect_plain(args.host, args.port)
+    n, rate = throughput(sock, args.seconds)
+    sock.close()
+    print('plaintext throughput    %8.1f KB/s  (%d bytes)' % (rate / 1024, n))
+
+    time.sleep(0.2)
+    sock, _ = connect_tls(ctx, args.host, args.tls_port, session=session)
+    n, tls_rate = throughput(sock, args.seconds)
+    sock.close()
+    print('TLS throughput          %8.1f KB/s  (%d bytes, %.0f%% of plaintext)'
+          % (tls_rate / 1024, n, 100.0 * tls_rate / max(rate, 1)))
+
+
+if __name__ == '__main__':
+    main()
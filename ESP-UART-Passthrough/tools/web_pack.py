@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+#
+# 构建时处理配网页面: 精简 + gzip，输出的文件由构建系统嵌入固件 (_binary_index_html_gz_start)
+#
+# 用法 (通常由 main/CMakeLists.txt 或 main/component.mk 调用):
+#   python3 web_pack.py main/web/index.html build/index.html.gz
+#
+# 精简只做保守处理，不依赖第三方工具:
+# - 删除 HTML 注释，以及 <script>/<style> 中的 /* */ 注释；CSS 去掉标点两侧的空白
+# - 去掉每行首尾空白；<script> 内保留换行 (避免自动分号插入出错)，其余行直接拼接
+# gzip 头中的时间戳固定为 0，同一输入总是得到同一输出 (设备端据此计算 ETag)
+
+import argparse
+import gzip
+import re
+import sys
+
+BLOCK_RE = re.compile(r'(<script\b.*?</script>|<style\b.*?</style>)', re.S | re.I)
+
+
+def minify_block(block):
+    block = re.sub(r'/\*.*?\*/', '', block, flags=re.S)
+    lines = [l.strip() for l in block.split('\n')]
+    if block[:7].lower() == '<script':
+        return '\n'.join(l for l in lines if l)
+    # CSS: 去掉标点两侧的空白
+    return re.sub(r'\s*([{};:,])\s*', r'\1', ''.join(lines))
+
+
+def minify(html):
+    html = re.sub(r'<!--.*?-->', '', html, flags=re.S)
+    out = []
+    for i, part in enumerate(BLOCK_RE.split(html)):
+        if i % 2:
+            out.append(minify_block(part))
+        else:
+            out.append(''.join(l.strip() for l in part.split('\n')))
+    return ''.join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='minify and gzip the provisioning page')
+    parser.add_argument('src')
+    parser.add_argument('dst')
+    args = parser.parse_args()
+
+    with open(args.src, encoding='utf-8') as f:
+        html = f.read()
+    data = minify(html).encode('utf-8')
+    packed = gzip.compress(data, compresslevel=9, mtime=0)
+    with open(args.dst, 'wb') as f:
+        f.write(packed)
+    print('%s: %d -> %d bytes minified -> %d bytes gzip'
+          % (args.src, len(html.encode('utf-8')), len(data), len(packed)), file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()